@@ -0,0 +1,571 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "compositor.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "cursor.h"
+#include "effect/effecthandler.h"
+#include "effect/effectloader.h"
+#include "frametracer.h"
+#include "scene/workspacescene.h"
+#include "virtualdesktops.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KWayland/Client/surface.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QRasterWindow>
+
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <time.h>
+
+/*
+ * kwin-bench renders a fixed number of frames in a handful of scenarios on the virtual backend
+ * and prints a JSON report with the CPU time of the main thread, the wall and CPU time spent in
+ * each of its frame stages, as recorded by the FrameTracer, and the number of heap allocations
+ * made inside those stages. Stage wall times include the time the main thread spent blocked.
+ *
+ * The test client runs in the same process, so allocations outside of frame stages, e.g. while
+ * the client renders its buffers, are not counted.
+ *
+ * The report is written to the file in KWIN_BENCH_REPORT if it's set, otherwise to stdout.
+ * The number of frames per scenario and the number of windows in the static scenario can be
+ * adjusted with KWIN_BENCH_FRAMES and KWIN_BENCH_WINDOWS.
+ */
+
+#if defined(__GLIBC__)
+static std::atomic<uint64_t> s_allocationCount = 0;
+static std::atomic<uint64_t> s_allocatedBytes = 0;
+
+// Set on the main thread, which runs the compositor and whose frame stages are reported.
+static thread_local bool t_compositorThread = false;
+
+static void countAllocation(size_t size)
+{
+    if (t_compositorThread && KWin::FrameTracer::isInSlice()) {
+        s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) || (alignment & (alignment - 1))) {
+        return EINVAL;
+    }
+    void *ret = memalign(alignment, size);
+    if (!ret && size) {
+        return ENOMEM;
+    }
+    *ptr = ret;
+    return 0;
+}
+}
+#endif
+
+using namespace KWin;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_bench-0");
+
+class BlurBehindWindow : public QRasterWindow
+{
+    Q_OBJECT
+
+public:
+    BlurBehindWindow()
+    {
+        setFlags(Qt::FramelessWindowHint);
+        QSurfaceFormat format = this->format();
+        format.setAlphaBufferSize(8);
+        setFormat(format);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(0, 0, width(), height(), QColor(255, 255, 255, 96));
+    }
+};
+
+class KWinBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void cleanupTestCase();
+
+    void staticWindows();
+    void animatingWindow();
+    void interactiveResize();
+    void blur();
+    void overview();
+    void desktopSwitch();
+
+private:
+    struct TestWindow
+    {
+        std::unique_ptr<KWayland::Client::Surface> surface;
+        std::unique_ptr<Test::XdgToplevel> shellSurface;
+        Window *window = nullptr;
+    };
+
+    TestWindow createWindow(const QSize &size, const QColor &color);
+    void beginMeasurement();
+    void endMeasurement(const QString &scenario, int frames);
+    bool waitForFrame();
+    bool repaintAndWaitForFrame();
+
+    RenderLoop *m_renderLoop = nullptr;
+    int m_frameCount = 120;
+    int m_windowCount = 16;
+    QJsonArray m_scenarios;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::nanoseconds m_startCpuTime;
+    uint64_t m_startAllocationCount = 0;
+    uint64_t m_startAllocatedBytes = 0;
+};
+
+void KWinBenchmark::initTestCase()
+{
+    if (!Test::renderNodeAvailable()) {
+        QSKIP("no render node available");
+        return;
+    }
+    qputenv("XDG_DATA_DIRS", QCoreApplication::applicationDirPath().toUtf8());
+    qRegisterMetaType<KWin::Window *>();
+    QVERIFY(waylandServer()->init(s_socketName));
+    Test::setOutputConfig({
+        QRect(0, 0, 1280, 1024),
+    });
+
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    qputenv("KWIN_EFFECTS_FORCE_ANIMATIONS", QByteArrayLiteral("1"));
+
+    kwinApp()->start();
+
+    bool ok = false;
+    if (const int frames = qEnvironmentVariableIntValue("KWIN_BENCH_FRAMES", &ok); ok && frames > 0) {
+        m_frameCount = frames;
+    }
+    if (const int windows = qEnvironmentVariableIntValue("KWIN_BENCH_WINDOWS", &ok); ok && windows > 0) {
+        m_windowCount = windows;
+    }
+
+    m_renderLoop = workspace()->outputs().constFirst()->renderLoop();
+    FrameTracer::self()->setEnabled(true);
+    FrameTracer::setThreadTimeEnabled(true);
+#if defined(__GLIBC__)
+    t_compositorThread = true;
+#endif
+}
+
+void KWinBenchmark::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void KWinBenchmark::cleanup()
+{
+    effects->unloadAllEffects();
+    QVERIFY(effects->loadedEffects().isEmpty());
+
+    VirtualDesktopManager::self()->setCount(1);
+
+    Test::destroyWaylandConnection();
+}
+
+void KWinBenchmark::cleanupTestCase()
+{
+    const QJsonObject report{
+        {QStringLiteral("frames"), m_frameCount},
+        {QStringLiteral("windows"), m_windowCount},
+        {QStringLiteral("scenarios"), m_scenarios},
+    };
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    const QString fileName = qEnvironmentVariable("KWIN_BENCH_REPORT");
+    if (fileName.isEmpty()) {
+        fprintf(stdout, "%s", json.constData());
+        return;
+    }
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(json);
+}
+
+KWinBenchmark::TestWindow KWinBenchmark::createWindow(const QSize &size, const QColor &color)
+{
+    TestWindow ret;
+    ret.surface = Test::createSurface();
+    ret.shellSurface = Test::createXdgToplevelSurface(ret.surface.get());
+    ret.window = Test::renderAndWaitForShown(ret.surface.get(), size, color);
+    return ret;
+}
+
+bool KWinBenchmark::waitForFrame()
+{
+    QSignalSpy framePresentedSpy(m_renderLoop, &RenderLoop::framePresented);
+    return framePresentedSpy.wait();
+}
+
+bool KWinBenchmark::repaintAndWaitForFrame()
+{
+    Compositor::self()->scene()->addRepaintFull();
+    return waitForFrame();
+}
+
+static std::chrono::nanoseconds threadCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+void KWinBenchmark::beginMeasurement()
+{
+    // Let the compositor settle, e.g. finish uploading the window contents.
+    QVERIFY(repaintAndWaitForFrame());
+
+    FrameTracer::self()->clear();
+    m_startTime = std::chrono::steady_clock::now();
+    m_startCpuTime = threadCpuTime();
+#if defined(__GLIBC__)
+    m_startAllocationCount = s_allocationCount.load(std::memory_order_relaxed);
+    m_startAllocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed);
+#endif
+}
+
+void KWinBenchmark::endMeasurement(const QString &scenario, int frames)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+    const auto cpuTime = threadCpuTime() - m_startCpuTime;
+#if defined(__GLIBC__)
+    const uint64_t allocationCount = s_allocationCount.load(std::memory_order_relaxed) - m_startAllocationCount;
+    const uint64_t allocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed) - m_startAllocatedBytes;
+#endif
+
+    // Sum up the durations of the slices recorded on the main thread. Slices with the same name
+    // are not nested in each other, so a plain stack is enough to match begin and end events.
+    const QJsonDocument trace = QJsonDocument::fromJson(FrameTracer::self()->chromeTrace());
+    const QJsonArray events = trace.object().value(QLatin1String("traceEvents")).toArray();
+
+    int mainThread = -1;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QLatin1String("ph")).toString() == QLatin1String("M")
+            && event.value(QLatin1String("args")).toObject().value(QLatin1String("name")).toString() == QLatin1String("Main thread")) {
+            mainThread = event.value(QLatin1String("tid")).toInt();
+            break;
+        }
+    }
+
+    struct Stage
+    {
+        double totalWall = 0;
+        double maxWall = 0;
+        double totalCpu = 0;
+        double maxCpu = 0;
+        int count = 0;
+    };
+    struct Slice
+    {
+        QString name;
+        double begin;
+        double threadBegin;
+    };
+    std::map<QString, Stage> stages;
+    std::vector<Slice> stack;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QLatin1String("tid")).toInt() != mainThread) {
+            continue;
+        }
+        const QString phase = event.value(QLatin1String("ph")).toString();
+        if (phase == QLatin1String("B")) {
+            stack.push_back(Slice{
+                .name = event.value(QLatin1String("name")).toString(),
+                .begin = event.value(QLatin1String("ts")).toDouble(),
+                .threadBegin = event.value(QLatin1String("tts")).toDouble(),
+            });
+        } else if (phase == QLatin1String("E") && !stack.empty()) {
+            const Slice slice = stack.back();
+            stack.pop_back();
+            const double wallDuration = event.value(QLatin1String("ts")).toDouble() - slice.begin;
+            const double cpuDuration = event.value(QLatin1String("tts")).toDouble() - slice.threadBegin;
+            Stage &stage = stages[slice.name];
+            stage.totalWall += wallDuration;
+            stage.maxWall = std::max(stage.maxWall, wallDuration);
+            stage.totalCpu += cpuDuration;
+            stage.maxCpu = std::max(stage.maxCpu, cpuDuration);
+            stage.count++;
+        }
+    }
+
+    QJsonObject stagesObject;
+    for (const auto &[name, stage] : stages) {
+        stagesObject[name] = QJsonObject{
+            {QStringLiteral("count"), stage.count},
+            {QStringLiteral("totalWallUs"), stage.totalWall},
+            {QStringLiteral("perFrameWallUs"), stage.totalWall / frames},
+            {QStringLiteral("maxWallUs"), stage.maxWall},
+            {QStringLiteral("totalCpuUs"), stage.totalCpu},
+            {QStringLiteral("perFrameCpuUs"), stage.totalCpu / frames},
+            {QStringLiteral("maxCpuUs"), stage.maxCpu},
+        };
+    }
+
+    QJsonObject result{
+        {QStringLiteral("name"), scenario},
+        {QStringLiteral("frames"), frames},
+        {QStringLiteral("wallTimeMs"), std::chrono::duration<double, std::milli>(elapsed).count()},
+        {QStringLiteral("cpuTimeMs"), std::chrono::duration<double, std::milli>(cpuTime).count()},
+        {QStringLiteral("cpuTimePerFrameUs"), std::chrono::duration<double, std::micro>(cpuTime).count() / frames},
+        {QStringLiteral("stages"), stagesObject},
+    };
+#if defined(__GLIBC__)
+    result[QStringLiteral("allocations")] = QJsonObject{
+        {QStringLiteral("count"), qint64(allocationCount)},
+        {QStringLiteral("bytes"), qint64(allocatedBytes)},
+        {QStringLiteral("perFrame"), double(allocationCount) / frames},
+    };
+#endif
+    m_scenarios.append(result);
+}
+
+void KWinBenchmark::staticWindows()
+{
+    // Nothing changes on the screen, this measures the baseline cost of a full repaint.
+    std::vector<TestWindow> windows;
+    for (int i = 0; i < m_windowCount; ++i) {
+        windows.push_back(createWindow(QSize(400, 300), QColor::fromHsv((i * 37) % 360, 200, 200)));
+        QVERIFY(windows.back().window);
+    }
+
+    beginMeasurement();
+    for (int i = 0; i < m_frameCount; ++i) {
+        QVERIFY(repaintAndWaitForFrame());
+    }
+    endMeasurement(QStringLiteral("static-windows"), m_frameCount);
+
+    for (TestWindow &window : windows) {
+        window.shellSurface.reset();
+        window.surface.reset();
+        QVERIFY(Test::waitForWindowClosed(window.window));
+    }
+}
+
+void KWinBenchmark::animatingWindow()
+{
+    // The client commits a new buffer every frame, like a video player or a game would.
+    TestWindow window = createWindow(QSize(640, 480), Qt::blue);
+    QVERIFY(window.window);
+
+    beginMeasurement();
+    for (int i = 0; i < m_frameCount; ++i) {
+        Test::render(window.surface.get(), QSize(640, 480), QColor::fromHsv(i % 360, 255, 255));
+        QVERIFY(waitForFrame());
+    }
+    endMeasurement(QStringLiteral("animating-window"), m_frameCount);
+
+    window.shellSurface.reset();
+    window.surface.reset();
+    QVERIFY(Test::waitForWindowClosed(window.window));
+}
+
+void KWinBenchmark::interactiveResize()
+{
+    TestWindow window = createWindow(QSize(400, 300), Qt::blue);
+    QVERIFY(window.window);
+    window.window->move(QPoint(100, 100));
+
+    QSignalSpy toplevelConfigureRequestedSpy(window.shellSurface.get(), &Test::XdgToplevel::configureRequested);
+    QSignalSpy surfaceConfigureRequestedSpy(window.shellSurface->xdgSurface(), &Test::XdgSurface::configureRequested);
+    QSignalSpy frameGeometryChangedSpy(window.window, &Window::frameGeometryChanged);
+
+    workspace()->slotWindowResize();
+    QCOMPARE(workspace()->moveResizeWindow(), window.window);
+    QVERIFY(surfaceConfigureRequestedSpy.wait());
+
+    beginMeasurement();
+    for (int i = 0; i < m_frameCount; ++i) {
+        // Grow and shrink the window in steps of 8 pixels.
+        window.window->keyPressEvent((i / 16) % 2 ? Qt::Key_Left : Qt::Key_Right);
+        window.window->updateInteractiveMoveResize(Cursors::self()->mouse()->pos(), Qt::KeyboardModifiers());
+        QVERIFY(surfaceConfigureRequestedSpy.wait());
+
+        QSignalSpy framePresentedSpy(m_renderLoop, &RenderLoop::framePresented);
+        window.shellSurface->xdgSurface()->ack_configure(surfaceConfigureRequestedSpy.last().at(0).value<quint32>());
+        Test::render(window.surface.get(), toplevelConfigureRequestedSpy.last().at(0).toSize(), Qt::blue);
+        QVERIFY(frameGeometryChangedSpy.wait());
+        QVERIFY(!framePresentedSpy.isEmpty() || framePresentedSpy.wait());
+    }
+    endMeasurement(QStringLiteral("interactive-resize"), m_frameCount);
+
+    window.window->keyPressEvent(Qt::Key_Enter);
+    QCOMPARE(workspace()->moveResizeWindow(), nullptr);
+
+    window.shellSurface.reset();
+    window.surface.reset();
+    QVERIFY(Test::waitForWindowClosed(window.window));
+}
+
+void KWinBenchmark::blur()
+{
+    // A translucent panel-like window with blur behind on top of a regular window.
+    QVERIFY(effects->loadEffect(QStringLiteral("blur")));
+
+    TestWindow background = createWindow(QSize(1280, 1024), Qt::darkCyan);
+    QVERIFY(background.window);
+
+    QSignalSpy windowAddedSpy(workspace(), &Workspace::windowAdded);
+    BlurBehindWindow blurBehind;
+    blurBehind.setProperty("kwin_blur", QRegion(0, 0, 640, 480));
+    blurBehind.setGeometry(320, 272, 640, 480);
+    blurBehind.show();
+    QTRY_COMPARE(windowAddedSpy.count(), 1);
+
+    beginMeasurement();
+    for (int i = 0; i < m_frameCount; ++i) {
+        QVERIFY(repaintAndWaitForFrame());
+    }
+    endMeasurement(QStringLiteral("blur"), m_frameCount);
+
+    blurBehind.hide();
+    background.shellSurface.reset();
+    background.surface.reset();
+    QVERIFY(Test::waitForWindowClosed(background.window));
+}
+
+void KWinBenchmark::overview()
+{
+    std::vector<TestWindow> windows;
+    for (int i = 0; i < 4; ++i) {
+        windows.push_back(createWindow(QSize(400, 300), QColor::fromHsv(i * 90, 200, 200)));
+        QVERIFY(windows.back().window);
+    }
+
+    QVERIFY(effects->loadEffect(QStringLiteral("overview")));
+    Effect *effect = effects->findEffect(QStringLiteral("overview"));
+    QVERIFY(effect);
+    QVERIFY(QMetaObject::invokeMethod(effect, "activate"));
+    QTRY_VERIFY(effect->isActive());
+
+    beginMeasurement();
+    for (int i = 0; i < m_frameCount; ++i) {
+        QVERIFY(repaintAndWaitForFrame());
+    }
+    endMeasurement(QStringLiteral("overview"), m_frameCount);
+
+    QVERIFY(QMetaObject::invokeMethod(effect, "deactivate"));
+    QTRY_VERIFY(!effect->isActive());
+
+    for (TestWindow &window : windows) {
+        window.shellSurface.reset();
+        window.surface.reset();
+        QVERIFY(Test::waitForWindowClosed(window.window));
+    }
+}
+
+void KWinBenchmark::desktopSwitch()
+{
+    VirtualDesktopManager::self()->setCount(2);
+
+    TestWindow window = createWindow(QSize(640, 480), Qt::blue);
+    QVERIFY(window.window);
+    window.window->setOnAllDesktops(true);
+
+    QVERIFY(effects->loadEffect(QStringLiteral("slide")));
+    Effect *effect = effects->findEffect(QStringLiteral("slide"));
+    QVERIFY(effect);
+
+    // The slide animation drives the repaints, keep switching until enough frames are rendered.
+    beginMeasurement();
+    int frames = 0;
+    while (frames < m_frameCount) {
+        const uint desktop = VirtualDesktopManager::self()->current() == 1 ? 2 : 1;
+        VirtualDesktopManager::self()->setCurrent(desktop);
+        QVERIFY(effect->isActive());
+        while (effect->isActive()) {
+            QVERIFY(waitForFrame());
+            frames++;
+        }
+    }
+    endMeasurement(QStringLiteral("desktop-switch"), frames);
+
+    window.shellSurface.reset();
+    window.surface.reset();
+    QVERIFY(Test::waitForWindowClosed(window.window));
+}
+
+WAYLANDTEST_MAIN(KWinBenchmark)
+#include "kwin_bench.moc"
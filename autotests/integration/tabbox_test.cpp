@@ -11,6 +11,7 @@
 #include "core/outputbackend.h"
 #include "input.h"
 #include "pointer_input.h"
+#include "tabbox/clientmodel.h"
 #include "tabbox/tabbox.h"
 #include "wayland_server.h"
 #include "window.h"
@@ -38,6 +39,8 @@ private Q_SLOTS:
     void testMoveForward();
     void testMoveBackward();
     void testCapsLock();
+    void testDelegateReuse();
+    void testInsertWhileShown();
     void testKeyboardFocus();
     void testActiveClientOutsideModel();
 };
@@ -251,6 +254,145 @@ void TabBoxTest::testMoveBackward()
     QVERIFY(Test::waitForWindowClosed(c1));
 }
 
+void TabBoxTest::testDelegateReuse()
+{
+#if !KWIN_BUILD_GLOBALSHORTCUTS
+    QSKIP("Can't test shortcuts without shortcuts");
+    return;
+#endif
+
+    // This test verifies that windows which appear or close while the task switcher is open
+    // are inserted into and removed from the model, rather than resetting it. A reset would
+    // make the view destroy and recreate the delegates of all windows.
+
+    std::unique_ptr<KWayland::Client::Surface> surface1(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface1(Test::createXdgToplevelSurface(surface1.get()));
+    auto c1 = Test::renderAndWaitForShown(surface1.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(c1);
+    std::unique_ptr<KWayland::Client::Surface> surface2(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface2(Test::createXdgToplevelSurface(surface2.get()));
+    auto c2 = Test::renderAndWaitForShown(surface2.get(), QSize(100, 50), Qt::red);
+    QVERIFY(c2);
+
+    QSignalSpy tabboxAddedSpy(workspace()->tabbox(), &TabBox::TabBox::tabBoxAdded);
+    QSignalSpy tabboxClosedSpy(workspace()->tabbox(), &TabBox::TabBox::tabBoxClosed);
+
+    // press alt+tab and keep alt pressed
+    quint32 timestamp = 0;
+    Test::keyboardKeyPressed(KEY_LEFTALT, timestamp++);
+    Test::keyboardKeyPressed(KEY_TAB, timestamp++);
+    Test::keyboardKeyReleased(KEY_TAB, timestamp++);
+    QVERIFY(tabboxAddedSpy.wait());
+
+    QAbstractItemModel *model = workspace()->tabbox()->currentClientModel();
+    QVERIFY(model);
+    QCOMPARE(model->rowCount(), 2);
+    auto indexOf = [model](Window *window) {
+        for (int row = 0; row < model->rowCount(); ++row) {
+            const QModelIndex index = model->index(row, 0);
+            if (index.data(TabBox::ClientModel::ClientRole).value<void *>() == window) {
+                return QPersistentModelIndex(index);
+            }
+        }
+        return QPersistentModelIndex();
+    };
+    const QPersistentModelIndex index1 = indexOf(c1);
+    const QPersistentModelIndex index2 = indexOf(c2);
+    QVERIFY(index1.isValid());
+    QVERIFY(index2.isValid());
+
+    QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+    QSignalSpy insertedSpy(model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removedSpy(model, &QAbstractItemModel::rowsRemoved);
+
+    // a window that appears is inserted, the other rows are kept
+    std::unique_ptr<KWayland::Client::Surface> surface3(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface3(Test::createXdgToplevelSurface(surface3.get()));
+    auto c3 = Test::renderAndWaitForShown(surface3.get(), QSize(100, 50), Qt::green);
+    QVERIFY(c3);
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+    QVERIFY(indexOf(c3).isValid());
+    QCOMPARE(index1.data(TabBox::ClientModel::ClientRole).value<void *>(), c1);
+    QCOMPARE(index2.data(TabBox::ClientModel::ClientRole).value<void *>(), c2);
+
+    // a window that closes is removed, the other rows are kept
+    surface2.reset();
+    QVERIFY(Test::waitForWindowClosed(c2));
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+    QVERIFY(!index2.isValid());
+    QCOMPARE(index1.data(TabBox::ClientModel::ClientRole).value<void *>(), c1);
+
+    // release alt
+    Test::keyboardKeyReleased(KEY_LEFTALT, timestamp++);
+    QCOMPARE(tabboxClosedSpy.count(), 1);
+
+    surface3.reset();
+    QVERIFY(Test::waitForWindowClosed(c3));
+    surface1.reset();
+    QVERIFY(Test::waitForWindowClosed(c1));
+}
+
+void TabBoxTest::testInsertWhileShown()
+{
+#if !KWIN_BUILD_GLOBALSHORTCUTS
+    QSKIP("Can't test shortcuts without shortcuts");
+    return;
+#endif
+
+    // This test verifies that the selected window stays selected if a window appears while
+    // the task switcher is open and shifts the rows of the model.
+
+    std::unique_ptr<KWayland::Client::Surface> surface1(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface1(Test::createXdgToplevelSurface(surface1.get()));
+    auto c1 = Test::renderAndWaitForShown(surface1.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(c1);
+    std::unique_ptr<KWayland::Client::Surface> surface2(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface2(Test::createXdgToplevelSurface(surface2.get()));
+    auto c2 = Test::renderAndWaitForShown(surface2.get(), QSize(100, 50), Qt::red);
+    QVERIFY(c2);
+    QVERIFY(c2->isActive());
+
+    QSignalSpy tabboxAddedSpy(workspace()->tabbox(), &TabBox::TabBox::tabBoxAdded);
+    QSignalSpy tabboxClosedSpy(workspace()->tabbox(), &TabBox::TabBox::tabBoxClosed);
+
+    // press alt+tab and keep alt pressed, the previously active window gets selected
+    quint32 timestamp = 0;
+    Test::keyboardKeyPressed(KEY_LEFTALT, timestamp++);
+    Test::keyboardKeyPressed(KEY_TAB, timestamp++);
+    Test::keyboardKeyReleased(KEY_TAB, timestamp++);
+    QVERIFY(tabboxAddedSpy.wait());
+    QCOMPARE(workspace()->tabbox()->currentClient(), c1);
+
+    QAbstractItemModel *model = workspace()->tabbox()->currentClientModel();
+    QVERIFY(model);
+    QSignalSpy insertedSpy(model, &QAbstractItemModel::rowsInserted);
+
+    // a window appears, the selection follows the window rather than the row
+    std::unique_ptr<KWayland::Client::Surface> surface3(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface3(Test::createXdgToplevelSurface(surface3.get()));
+    auto c3 = Test::renderAndWaitForShown(surface3.get(), QSize(100, 50), Qt::green);
+    QVERIFY(c3);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(workspace()->tabbox()->currentClient(), c1);
+
+    // release alt
+    Test::keyboardKeyReleased(KEY_LEFTALT, timestamp++);
+    QCOMPARE(tabboxClosedSpy.count(), 1);
+    QCOMPARE(workspace()->activeWindow(), c1);
+
+    surface3.reset();
+    QVERIFY(Test::waitForWindowClosed(c3));
+    surface2.reset();
+    QVERIFY(Test::waitForWindowClosed(c2));
+    surface1.reset();
+    QVERIFY(Test::waitForWindowClosed(c1));
+}
+
 void TabBoxTest::testKeyboardFocus()
 {
     // This test verifies that the keyboard focus will be withdrawn from the currently activated
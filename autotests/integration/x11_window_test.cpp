@@ -10,8 +10,13 @@
 
 #include "atoms.h"
 #include "compositor.h"
+#include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "cursor.h"
 #include "pointer_input.h"
+#include "rules.h"
+#include "scene/workspacescene.h"
+#include "utils/c_ptr.h"
 #include "virtualdesktops.h"
 #include "wayland_server.h"
 #include "workspace.h"
@@ -21,6 +26,7 @@
 
 #include <linux/input-event-codes.h>
 #include <netwm.h>
+#include <xcb/sync.h>
 #include <xcb/xcb_icccm.h>
 
 using namespace KWin;
@@ -128,6 +134,12 @@ private Q_SLOTS:
     void testOverrideRedirectReparent();
     void testOverrideRedirectStackingAbove();
     void testOverrideRedirectStackingBelow();
+    void testFrameSync();
+    void testFrameSyncWithoutOutput();
+    void testRestackEvents();
+    void testCoalescedCaptionChanges();
+    void testThrottleSuspend();
+    void testDesktopSwitchVisibility();
 };
 
 void X11WindowTest::initTestCase_data()
@@ -3564,5 +3576,302 @@ void X11WindowTest::testOverrideRedirectStackingBelow()
     QVERIFY(workspace()->stackingOrder().indexOf(windowB) == 0);
 }
 
+void X11WindowTest::testFrameSync()
+{
+    // This test verifies that kwin supports the extended _NET_WM_SYNC_REQUEST protocol, i.e. it
+    // sends _NET_WM_FRAME_DRAWN and _NET_WM_FRAME_TIMINGS after the client has finished a frame.
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    xcb_discard_reply(c.get(), xcb_sync_initialize(c.get(), XCB_SYNC_MAJOR_VERSION, XCB_SYNC_MINOR_VERSION).sequence);
+
+    UniqueCPtr<xcb_get_property_reply_t> supported(xcb_get_property_reply(c.get(), xcb_get_property_unchecked(c.get(), false, rootWindow(), atoms->net_supported, XCB_ATOM_ATOM, 0, 1024), nullptr));
+    QVERIFY(supported);
+    const auto supportedAtoms = reinterpret_cast<xcb_atom_t *>(xcb_get_property_value(supported.get()));
+    const int supportedCount = xcb_get_property_value_length(supported.get()) / sizeof(xcb_atom_t);
+    QVERIFY(std::find(supportedAtoms, supportedAtoms + supportedCount, atoms->net_wm_frame_drawn) != supportedAtoms + supportedCount);
+    QVERIFY(std::find(supportedAtoms, supportedAtoms + supportedCount, atoms->net_wm_frame_timings) != supportedAtoms + supportedCount);
+
+    const xcb_sync_counter_t basicCounter = xcb_generate_id(c.get());
+    const xcb_sync_counter_t extendedCounter = xcb_generate_id(c.get());
+    xcb_sync_create_counter(c.get(), basicCounter, xcb_sync_int64_t{0, 0});
+    xcb_sync_create_counter(c.get(), extendedCounter, xcb_sync_int64_t{0, 0});
+
+    X11Window *window = createWindow(c.get(), QRect(0, 0, 100, 200), [&c, basicCounter, extendedCounter](xcb_window_t windowId) {
+        const uint32_t counters[] = {basicCounter, extendedCounter};
+        xcb_change_property(c.get(), XCB_PROP_MODE_REPLACE, windowId, atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 32, 2, counters);
+    });
+    QVERIFY(window);
+    QVERIFY(window->frameSync().alarm != XCB_NONE);
+
+    auto nextClientMessage = [&c](xcb_atom_t type) -> std::optional<xcb_client_message_event_t> {
+        std::optional<xcb_client_message_event_t> message;
+        const bool received = QTest::qWaitFor([&]() {
+            while (UniqueCPtr<xcb_generic_event_t> event{xcb_poll_for_event(c.get())}) {
+                if ((event->response_type & ~0x80) != XCB_CLIENT_MESSAGE) {
+                    continue;
+                }
+                const auto clientMessage = reinterpret_cast<xcb_client_message_event_t *>(event.get());
+                if (clientMessage->type == type) {
+                    message = *clientMessage;
+                    return true;
+                }
+            }
+            return false;
+        });
+        return received ? message : std::nullopt;
+    };
+
+    // Start and finish a frame.
+    xcb_sync_set_counter(c.get(), extendedCounter, xcb_sync_int64_t{0, 1});
+    xcb_sync_set_counter(c.get(), extendedCounter, xcb_sync_int64_t{0, 2});
+    xcb_flush(c.get());
+
+    const auto frameDrawn = nextClientMessage(atoms->net_wm_frame_drawn);
+    QVERIFY(frameDrawn);
+    QCOMPARE(frameDrawn->data.data32[0], 2u);
+    QCOMPARE(frameDrawn->data.data32[1], 0u);
+
+    const auto frameTimings = nextClientMessage(atoms->net_wm_frame_timings);
+    QVERIFY(frameTimings);
+    QCOMPARE(frameTimings->data.data32[0], 2u);
+    QCOMPARE(frameTimings->data.data32[1], 0u);
+
+    xcb_sync_destroy_counter(c.get(), basicCounter);
+    xcb_sync_destroy_counter(c.get(), extendedCounter);
+    xcb_flush(c.get());
+}
+
+void X11WindowTest::testFrameSyncWithoutOutput()
+{
+    // This test verifies that _NET_WM_FRAME_DRAWN is sent from the frame pass of a scene delegate
+    // that isn't bound to any output, which is how the X11 compositor paints the workspace.
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    xcb_discard_reply(c.get(), xcb_sync_initialize(c.get(), XCB_SYNC_MAJOR_VERSION, XCB_SYNC_MINOR_VERSION).sequence);
+
+    const xcb_sync_counter_t basicCounter = xcb_generate_id(c.get());
+    const xcb_sync_counter_t extendedCounter = xcb_generate_id(c.get());
+    xcb_sync_create_counter(c.get(), basicCounter, xcb_sync_int64_t{0, 0});
+    xcb_sync_create_counter(c.get(), extendedCounter, xcb_sync_int64_t{0, 0});
+
+    X11Window *window = createWindow(c.get(), QRect(0, 0, 100, 200), [&c, basicCounter, extendedCounter](xcb_window_t windowId) {
+        const uint32_t counters[] = {basicCounter, extendedCounter};
+        xcb_change_property(c.get(), XCB_PROP_MODE_REPLACE, windowId, atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 32, 2, counters);
+    });
+    QVERIFY(window);
+    QVERIFY(window->frameSync().alarm != XCB_NONE);
+
+    // Complete a frame and run the frame pass before the compositor gets a chance to paint it.
+    window->handleFrameSyncCounter(xcb_sync_int64_t{0, 4});
+    QCOMPARE(window->frameSync().pendingValue, std::optional<uint64_t>(4));
+
+    RenderLoop renderLoop(nullptr);
+    renderLoop.prepareNewFrame();
+    OutputFrame frame(&renderLoop, std::chrono::nanoseconds(16'666'667));
+    SceneDelegate delegate(Compositor::self()->scene(), nullptr);
+    delegate.frame(&frame);
+    QVERIFY(!window->frameSync().pendingValue);
+    frame.presented(std::chrono::steady_clock::now().time_since_epoch(), PresentationMode::VSync);
+
+    auto nextClientMessage = [&c](xcb_atom_t type) -> std::optional<xcb_client_message_event_t> {
+        std::optional<xcb_client_message_event_t> message;
+        const bool received = QTest::qWaitFor([&]() {
+            while (UniqueCPtr<xcb_generic_event_t> event{xcb_poll_for_event(c.get())}) {
+                if ((event->response_type & ~0x80) != XCB_CLIENT_MESSAGE) {
+                    continue;
+                }
+                const auto clientMessage = reinterpret_cast<xcb_client_message_event_t *>(event.get());
+                if (clientMessage->type == type) {
+                    message = *clientMessage;
+                    return true;
+                }
+            }
+            return false;
+        });
+        return received ? message : std::nullopt;
+    };
+
+    const auto frameDrawn = nextClientMessage(atoms->net_wm_frame_drawn);
+    QVERIFY(frameDrawn);
+    QCOMPARE(frameDrawn->data.data32[0], 4u);
+    QCOMPARE(frameDrawn->data.data32[1], 0u);
+
+    const auto frameTimings = nextClientMessage(atoms->net_wm_frame_timings);
+    QVERIFY(frameTimings);
+    QCOMPARE(frameTimings->data.data32[0], 4u);
+    QCOMPARE(frameTimings->data.data32[1], 0u);
+    QCOMPARE(frameTimings->data.data32[3], 16666u);
+
+    xcb_sync_destroy_counter(c.get(), basicCounter);
+    xcb_sync_destroy_counter(c.get(), extendedCounter);
+    xcb_flush(c.get());
+}
+
+void X11WindowTest::testRestackEvents()
+{
+    // This test verifies that raising a window only restacks the raised window, and that only
+    // the root window properties whose content changes are rewritten.
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    X11Window *window1 = createWindow(c.get(), QRect(0, 0, 100, 200));
+    QVERIFY(window1);
+    X11Window *window2 = createWindow(c.get(), QRect(0, 0, 100, 200));
+    QVERIFY(window2);
+    QVERIFY(workspace()->stackingOrder().indexOf(window1) < workspace()->stackingOrder().indexOf(window2));
+
+    Test::XcbConnectionPtr observer = Test::createX11Connection();
+    auto internAtom = [&observer](const QByteArray &name) {
+        UniqueCPtr<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(observer.get(), xcb_intern_atom(observer.get(), false, name.size(), name.constData()), nullptr));
+        return reply ? reply->atom : XCB_ATOM_NONE;
+    };
+    const xcb_atom_t clientList = internAtom(QByteArrayLiteral("_NET_CLIENT_LIST"));
+    const xcb_atom_t clientListStacking = internAtom(QByteArrayLiteral("_NET_CLIENT_LIST_STACKING"));
+    const uint32_t eventMask = XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY;
+    xcb_change_window_attributes(observer.get(), rootWindow(), XCB_CW_EVENT_MASK, &eventMask);
+    free(xcb_get_input_focus_reply(observer.get(), xcb_get_input_focus(observer.get()), nullptr));
+
+    workspace()->raiseWindow(window1);
+    QCOMPARE(workspace()->stackingOrder().last(), window1);
+    Xcb::sync();
+    free(xcb_get_input_focus_reply(observer.get(), xcb_get_input_focus(observer.get()), nullptr));
+
+    int raisedConfigureCount = 0;
+    int otherConfigureCount = 0;
+    int clientListCount = 0;
+    int clientListStackingCount = 0;
+    while (UniqueCPtr<xcb_generic_event_t> event{xcb_poll_for_event(observer.get())}) {
+        switch (event->response_type & ~0x80) {
+        case XCB_CONFIGURE_NOTIFY: {
+            const auto configureNotify = reinterpret_cast<xcb_configure_notify_event_t *>(event.get());
+            if (configureNotify->window == window1->frameId() || configureNotify->window == window1->inputId()) {
+                raisedConfigureCount++;
+            } else {
+                otherConfigureCount++;
+            }
+            break;
+        }
+        case XCB_PROPERTY_NOTIFY: {
+            const auto propertyNotify = reinterpret_cast<xcb_property_notify_event_t *>(event.get());
+            if (propertyNotify->atom == clientList) {
+                clientListCount++;
+            } else if (propertyNotify->atom == clientListStacking) {
+                clientListStackingCount++;
+            }
+            break;
+        }
+        }
+    }
+
+    QVERIFY(raisedConfigureCount >= 1);
+    QCOMPARE(otherConfigureCount, 0);
+    QCOMPARE(clientListCount, 0);
+    QCOMPARE(clientListStackingCount, 1);
+}
+
+void X11WindowTest::testCoalescedCaptionChanges()
+{
+    // This test verifies that a burst of _NET_WM_NAME changes is coalesced, and that the window
+    // ends up with the last caption.
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    X11Window *window = createWindow(c.get(), QRect(0, 0, 100, 200), [&c](xcb_window_t windowId) {
+        NETWinInfo info(c.get(), windowId, kwinApp()->x11RootWindow(), NET::Properties(), NET::Properties2());
+        info.setName("0");
+    });
+    QVERIFY(window);
+    QCOMPARE(window->caption(), QStringLiteral("0"));
+
+    QSignalSpy captionChangedSpy(window, &X11Window::captionChanged);
+    NETWinInfo info(c.get(), window->window(), kwinApp()->x11RootWindow(), NET::Properties(), NET::Properties2());
+    const int changeCount = 50;
+    for (int i = 1; i <= changeCount; ++i) {
+        info.setName(QByteArray::number(i).constData());
+    }
+    xcb_flush(c.get());
+
+    QTRY_COMPARE(window->caption(), QString::number(changeCount));
+    QVERIFY(captionChangedSpy.count() < changeCount);
+}
+
+void X11WindowTest::testThrottleSuspend()
+{
+    // This test verifies that a window whose throttling rule is set to suspend is marked hidden
+    // while it can't be seen, so the client can stop drawing.
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group(QStringLiteral("General")).writeEntry("count", 1);
+    KConfigGroup group = config->group(QStringLiteral("1"));
+    group.writeEntry("throttling", int(ThrottlePolicy::Suspend));
+    group.writeEntry("throttlingrule", int(Rules::Force));
+    group.sync();
+    workspace()->rulebook()->setConfig(config);
+    workspace()->slotReconfigure();
+    auto restoreRules = qScopeGuard([]() {
+        workspace()->rulebook()->setConfig(KSharedConfig::openConfig(QString(), KConfig::SimpleConfig));
+        workspace()->slotReconfigure();
+    });
+
+    VirtualDesktopManager *vds = VirtualDesktopManager::self();
+    vds->setCurrent(vds->desktops().first());
+
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    QVERIFY(!xcb_connection_has_error(c.get()));
+    X11Window *window = createWindow(c.get(), QRect(0, 0, 100, 200));
+    QVERIFY(window);
+    QCOMPARE(window->throttlePolicy(), ThrottlePolicy::Suspend);
+    QTRY_VERIFY(window->readyForPainting());
+    QVERIFY(!window->isSuspended());
+
+    // Move the window to another virtual desktop.
+    window->setDesktops({vds->desktops().last()});
+    QVERIFY(window->isSuspended());
+    {
+        Xcb::sync();
+        NETWinInfo info(c.get(), window->window(), kwinApp()->x11RootWindow(), NET::WMState, NET::Properties2());
+        QVERIFY(info.state() & NET::Hidden);
+    }
+
+    // Move the window back.
+    window->setDesktops({vds->desktops().first()});
+    QVERIFY(!window->isSuspended());
+    {
+        Xcb::sync();
+        NETWinInfo info(c.get(), window->window(), kwinApp()->x11RootWindow(), NET::WMState, NET::Properties2());
+        QVERIFY(!(info.state() & NET::Hidden));
+    }
+}
+
+void X11WindowTest::testDesktopSwitchVisibility()
+{
+    // This test verifies that switching virtual desktops only hides the windows on the previous
+    // desktop and shows the windows on the new one, also after a window has changed its desktop.
+    VirtualDesktopManager *vds = VirtualDesktopManager::self();
+    VirtualDesktop *first = vds->desktops().first();
+    VirtualDesktop *last = vds->desktops().last();
+    vds->setCurrent(first);
+
+    Test::XcbConnectionPtr c = Test::createX11Connection();
+    QVERIFY(!xcb_connection_has_error(c.get()));
+    X11Window *window = createWindow(c.get(), QRect(0, 0, 100, 200));
+    QVERIFY(window);
+    X11Window *sticky = createWindow(c.get(), QRect(200, 0, 100, 200));
+    QVERIFY(sticky);
+    sticky->setOnAllDesktops(true);
+    QVERIFY(!window->hiddenPreview());
+    QVERIFY(!sticky->hiddenPreview());
+
+    vds->setCurrent(last);
+    QVERIFY(window->hiddenPreview());
+    QVERIFY(!sticky->hiddenPreview());
+
+    vds->setCurrent(first);
+    QVERIFY(!window->hiddenPreview());
+    QVERIFY(!sticky->hiddenPreview());
+
+    // Move the window to the other desktop, it must be shown when that desktop becomes current.
+    window->setDesktops({last});
+    QVERIFY(window->hiddenPreview());
+    vds->setCurrent(last);
+    QVERIFY(!window->hiddenPreview());
+    QVERIFY(!sticky->hiddenPreview());
+    vds->setCurrent(first);
+    QVERIFY(window->hiddenPreview());
+}
+
 WAYLANDTEST_MAIN(X11WindowTest)
 #include "x11_window_test.moc"
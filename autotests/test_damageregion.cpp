@@ -0,0 +1,251 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "utils/damageregion.h"
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(QList<QRect>)
+
+class TestDamageRegion : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void mergeExactly_data();
+    void mergeExactly();
+    void absorbContainedRects();
+    void boundedRectCount();
+    void tileGrid_data();
+    void tileGrid();
+    void translated();
+
+    void benchmarkQRegion_data();
+    void benchmarkQRegion();
+    void benchmarkDamageRegion_data();
+    void benchmarkDamageRegion();
+    void benchmarkDamageRegionTiles_data();
+    void benchmarkDamageRegionTiles();
+};
+
+/**
+ * Returns the damage of a few synthetic frames, which are hand-written shapes meant to resemble
+ * a blinking cursor, a scrolling terminal, a video player and a busy web page.
+ */
+static QList<QList<QRect>> damagePatterns(QStringList *names)
+{
+    QList<QList<QRect>> patterns;
+    QRandomGenerator generator(42);
+
+    // A blinking text cursor and a clock in a panel.
+    *names << QStringLiteral("cursor");
+    patterns << QList<QRect>{QRect(412, 318, 2, 17), QRect(1200, 1000, 64, 24)};
+
+    // A terminal that scrolls by a few lines.
+    *names << QStringLiteral("terminal");
+    QList<QRect> terminal;
+    for (int line = 0; line < 40; ++line) {
+        for (int chunk = 0; chunk < 4; ++chunk) {
+            terminal << QRect(100 + chunk * 160, 100 + line * 18, 160, 18);
+        }
+    }
+    patterns << terminal;
+
+    // A video player, whose X server damage arrives as horizontal bands.
+    *names << QStringLiteral("video");
+    QList<QRect> video;
+    for (int band = 0; band < 30; ++band) {
+        video << QRect(320, 180 + band * 24, 1280, 24);
+    }
+    patterns << video;
+
+    // A web page with many small animated elements spread over the window.
+    *names << QStringLiteral("scattered");
+    QList<QRect> scattered;
+    for (int i = 0; i < 200; ++i) {
+        scattered << QRect(generator.bounded(1900), generator.bounded(1060), 4 + generator.bounded(28), 4 + generator.bounded(28));
+    }
+    patterns << scattered;
+
+    return patterns;
+}
+
+static void addDamagePatternRows()
+{
+    QTest::addColumn<QList<QRect>>("rects");
+
+    QStringList names;
+    const QList<QList<QRect>> patterns = damagePatterns(&names);
+    for (int i = 0; i < patterns.size(); ++i) {
+        QTest::newRow(qPrintable(names[i])) << patterns[i];
+    }
+}
+
+/**
+ * Returns @c true if @a region covers every rectangle in @a rects.
+ */
+static bool covers(const DamageRegion &region, const QList<QRect> &rects)
+{
+    QRegion expected;
+    for (const QRect &rect : rects) {
+        expected += rect;
+    }
+    return (expected - region.toRegion()).isEmpty();
+}
+
+void TestDamageRegion::mergeExactly_data()
+{
+    QTest::addColumn<QRect>("first");
+    QTest::addColumn<QRect>("second");
+    QTest::addColumn<int>("rectCount");
+
+    QTest::newRow("stacked") << QRect(0, 0, 100, 10) << QRect(0, 10, 100, 10) << 1;
+    QTest::newRow("side by side") << QRect(0, 0, 10, 100) << QRect(10, 0, 10, 100) << 1;
+    QTest::newRow("overlapping rows") << QRect(0, 0, 100, 10) << QRect(0, 5, 100, 10) << 1;
+    QTest::newRow("gap") << QRect(0, 0, 100, 10) << QRect(0, 11, 100, 10) << 2;
+    QTest::newRow("different width") << QRect(0, 0, 100, 10) << QRect(0, 10, 90, 10) << 2;
+}
+
+void TestDamageRegion::mergeExactly()
+{
+    QFETCH(QRect, first);
+    QFETCH(QRect, second);
+
+    DamageRegion region;
+    region += first;
+    region += second;
+
+    QTEST(int(region.rectCount()), "rectCount");
+    QCOMPARE(region.toRegion(), QRegion(first) + second);
+    QCOMPARE(region.boundingRect(), first | second);
+}
+
+void TestDamageRegion::absorbContainedRects()
+{
+    DamageRegion region;
+    region += QRect(10, 10, 10, 10);
+    region += QRect(50, 50, 10, 10);
+    QCOMPARE(region.rectCount(), 2);
+
+    // A rect that's already covered doesn't change the region.
+    region += QRect(12, 12, 4, 4);
+    QCOMPARE(region.rectCount(), 2);
+
+    // A rect that covers other rects replaces them.
+    region += QRect(0, 0, 100, 100);
+    QCOMPARE(region.rectCount(), 1);
+    QCOMPARE(region.toRegion(), QRegion(0, 0, 100, 100));
+}
+
+void TestDamageRegion::boundedRectCount()
+{
+    QStringList names;
+    const QList<QList<QRect>> patterns = damagePatterns(&names);
+    for (const QList<QRect> &rects : patterns) {
+        DamageRegion region;
+        region.setMaxRectCount(8);
+        for (const QRect &rect : rects) {
+            region += rect;
+        }
+        QVERIFY(region.rectCount() <= 8);
+        QVERIFY(covers(region, rects));
+    }
+}
+
+void TestDamageRegion::tileGrid_data()
+{
+    QTest::addColumn<QRect>("rect");
+    QTest::addColumn<QRect>("expected");
+
+    QTest::newRow("inside a tile") << QRect(10, 10, 1, 1) << QRect(0, 0, 64, 64);
+    QTest::newRow("aligned") << QRect(64, 128, 64, 64) << QRect(64, 128, 64, 64);
+    QTest::newRow("across tiles") << QRect(60, 60, 10, 10) << QRect(0, 0, 128, 128);
+    QTest::newRow("negative") << QRect(-10, -70, 5, 5) << QRect(-64, -128, 64, 64);
+}
+
+void TestDamageRegion::tileGrid()
+{
+    QFETCH(QRect, rect);
+
+    DamageRegion region;
+    region.setTileSize(64);
+    region += rect;
+
+    QCOMPARE(region.rectCount(), 1);
+    QTEST(*region.begin(), "expected");
+}
+
+void TestDamageRegion::translated()
+{
+    DamageRegion region;
+    region += QRect(0, 0, 10, 10);
+    region += QRect(20, 20, 10, 10);
+
+    const DamageRegion translated = region.translated(QPoint(5, -5));
+    QCOMPARE(translated.toRegion(), region.toRegion().translated(5, -5));
+    QCOMPARE(translated.boundingRect(), region.boundingRect().translated(5, -5));
+}
+
+void TestDamageRegion::benchmarkQRegion_data()
+{
+    addDamagePatternRows();
+}
+
+void TestDamageRegion::benchmarkQRegion()
+{
+    QFETCH(QList<QRect>, rects);
+
+    QBENCHMARK {
+        QRegion region;
+        for (const QRect &rect : std::as_const(rects)) {
+            region += rect;
+        }
+        QVERIFY(!region.isEmpty());
+    }
+}
+
+void TestDamageRegion::benchmarkDamageRegion_data()
+{
+    addDamagePatternRows();
+}
+
+void TestDamageRegion::benchmarkDamageRegion()
+{
+    QFETCH(QList<QRect>, rects);
+
+    // The damage is converted to a QRegion once per frame, so include that in the measurement.
+    QBENCHMARK {
+        DamageRegion region;
+        for (const QRect &rect : std::as_const(rects)) {
+            region += rect;
+        }
+        QVERIFY(!region.toRegion().isEmpty());
+    }
+}
+
+void TestDamageRegion::benchmarkDamageRegionTiles_data()
+{
+    addDamagePatternRows();
+}
+
+void TestDamageRegion::benchmarkDamageRegionTiles()
+{
+    QFETCH(QList<QRect>, rects);
+
+    QBENCHMARK {
+        DamageRegion region;
+        region.setTileSize(64);
+        for (const QRect &rect : std::as_const(rects)) {
+            region += rect;
+        }
+        QVERIFY(!region.toRegion().isEmpty());
+    }
+}
+
+QTEST_GUILESS_MAIN(TestDamageRegion)
+#include "test_damageregion.moc"
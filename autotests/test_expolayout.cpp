@@ -0,0 +1,168 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "plugins/private/expolayout.h"
+
+class TestExpoLayout : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void layoutFitsArea_data();
+    void layoutFitsArea();
+    void filterAndRestoreWindows();
+
+    void benchmarkLayout_data();
+    void benchmarkLayout();
+    void benchmarkFilterWindows();
+};
+
+static const QRectF s_area(0, 0, 1920, 1080);
+
+/**
+ * Returns the geometries of @a count windows with a mix of typical sizes, scattered over
+ * the layout area. The same windows are returned for the same count.
+ */
+static QList<QRectF> syntheticWindows(int count)
+{
+    static const QList<QSizeF> sizes{
+        QSizeF(1280, 800),
+        QSizeF(800, 600),
+        QSizeF(1920, 1040),
+        QSizeF(640, 480),
+        QSizeF(400, 700),
+        QSizeF(1024, 768),
+        QSizeF(300, 200),
+    };
+
+    QRandomGenerator generator(count);
+    QList<QRectF> windows;
+    for (int i = 0; i < count; ++i) {
+        const QSizeF size = sizes[generator.bounded(int(sizes.size()))];
+        const QPointF position(generator.bounded(s_area.width() - size.width() + 1),
+                               generator.bounded(s_area.height() - size.height() + 1));
+        windows.append(QRectF(position, size));
+    }
+    return windows;
+}
+
+static void addWindowCountRows()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : {5, 20, 60, 120}) {
+        QTest::addRow("%d windows", count) << count;
+    }
+}
+
+void TestExpoLayout::layoutFitsArea_data()
+{
+    addWindowCountRows();
+}
+
+void TestExpoLayout::layoutFitsArea()
+{
+    QFETCH(int, count);
+
+    for (ExpoLayout::PlacementMode mode : {ExpoLayout::Rows, ExpoLayout::Columns}) {
+        const QList<QRectF> layouts = ExpoLayout::layout(s_area, syntheticWindows(count), ExpoLayout::LayoutParameters{.placementMode = mode});
+        QCOMPARE(layouts.size(), count);
+        for (const QRectF &layout : layouts) {
+            QVERIFY(layout.isValid());
+            QVERIFY(s_area.adjusted(-1, -1, 1, 1).contains(layout));
+        }
+    }
+}
+
+static QList<QRectF> cellGeometries(const QList<ExpoCell *> &cells)
+{
+    QList<QRectF> geometries;
+    for (const ExpoCell *cell : cells) {
+        geometries.append(QRectF(cell->position(), cell->size()));
+    }
+    return geometries;
+}
+
+static std::unique_ptr<ExpoLayout> createLayout(const QList<QRectF> &windows, QList<ExpoCell *> *cells)
+{
+    auto layout = std::make_unique<ExpoLayout>();
+    layout->setSize(s_area.size());
+    for (int i = 0; i < windows.size(); ++i) {
+        auto cell = new ExpoCell(layout.get());
+        cell->setPersistentKey(QString::number(i));
+        cell->setNaturalX(windows[i].x());
+        cell->setNaturalY(windows[i].y());
+        cell->setNaturalWidth(windows[i].width());
+        cell->setNaturalHeight(windows[i].height());
+        cell->setLayout(layout.get());
+        cells->append(cell);
+    }
+    return layout;
+}
+
+void TestExpoLayout::filterAndRestoreWindows()
+{
+    QList<ExpoCell *> cells;
+    std::unique_ptr<ExpoLayout> layout = createLayout(syntheticWindows(60), &cells);
+
+    layout->forceLayout();
+    QVERIFY(layout->isReady());
+    const QList<QRectF> initialGeometries = cellGeometries(cells);
+
+    // Filter out half of the windows, as if a search term has been typed.
+    for (int i = 0; i < cells.size(); i += 2) {
+        cells[i]->setShouldLayout(false);
+    }
+    layout->forceLayout();
+    QVERIFY(cellGeometries(cells) != initialGeometries);
+
+    // Clearing the search term must bring back the initial arrangement.
+    for (int i = 0; i < cells.size(); i += 2) {
+        cells[i]->setShouldLayout(true);
+    }
+    layout->forceLayout();
+    QCOMPARE(cellGeometries(cells), initialGeometries);
+}
+
+void TestExpoLayout::benchmarkLayout_data()
+{
+    addWindowCountRows();
+}
+
+void TestExpoLayout::benchmarkLayout()
+{
+    QFETCH(int, count);
+
+    const QList<QRectF> windows = syntheticWindows(count);
+    QBENCHMARK {
+        const QList<QRectF> layouts = ExpoLayout::layout(s_area, windows, ExpoLayout::LayoutParameters{});
+        QCOMPARE(layouts.size(), count);
+    }
+}
+
+void TestExpoLayout::benchmarkFilterWindows()
+{
+    QList<ExpoCell *> cells;
+    std::unique_ptr<ExpoLayout> layout = createLayout(syntheticWindows(60), &cells);
+    layout->forceLayout();
+
+    // Typing and erasing a search term switches between the same window sets.
+    QBENCHMARK {
+        for (int i = 0; i < cells.size(); i += 3) {
+            cells[i]->setShouldLayout(false);
+        }
+        layout->forceLayout();
+        for (int i = 0; i < cells.size(); i += 3) {
+            cells[i]->setShouldLayout(true);
+        }
+        layout->forceLayout();
+    }
+}
+
+QTEST_MAIN(TestExpoLayout)
+#include "test_expolayout.moc"
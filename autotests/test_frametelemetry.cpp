@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/frametelemetry.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestFrameTelemetry : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void empty();
+    void percentiles();
+    void overflow();
+    void reset();
+};
+
+void TestFrameTelemetry::empty()
+{
+    FrameHistogram histogram;
+    QCOMPARE(histogram.count(), uint64_t(0));
+    QCOMPARE(histogram.mean(), 0ns);
+    QCOMPARE(histogram.percentile(50), 0ns);
+    QCOMPARE(histogram.percentile(99), 0ns);
+}
+
+void TestFrameTelemetry::percentiles()
+{
+    // One sample at the end of each of the first 100 buckets.
+    FrameHistogram histogram;
+    for (int i = 1; i <= 100; ++i) {
+        histogram.add(std::chrono::microseconds(i * 100) - 1us);
+    }
+    QCOMPARE(histogram.count(), uint64_t(100));
+    QCOMPARE(histogram.percentile(50), std::chrono::nanoseconds(5000us));
+    QCOMPARE(histogram.percentile(95), std::chrono::nanoseconds(9500us));
+    QCOMPARE(histogram.percentile(99), std::chrono::nanoseconds(9900us));
+    QCOMPARE(histogram.percentile(100), std::chrono::nanoseconds(9999us));
+    QCOMPARE(histogram.max(), std::chrono::nanoseconds(9999us));
+}
+
+void TestFrameTelemetry::overflow()
+{
+    FrameHistogram histogram;
+    histogram.add(1ms);
+    histogram.add(1s);
+    QCOMPARE(histogram.count(), uint64_t(2));
+    QCOMPARE(histogram.percentile(50), std::chrono::nanoseconds(1100us));
+    QCOMPARE(histogram.percentile(99), std::chrono::nanoseconds(1s));
+    QCOMPARE(histogram.toVariantMap().value(QStringLiteral("overflow")).toUInt(), 1u);
+}
+
+void TestFrameTelemetry::reset()
+{
+    FrameTelemetry telemetry;
+    telemetry.renderTime.add(3ms);
+    telemetry.latency.add(16ms);
+    telemetry.syncWaitTime.add(1ms);
+    telemetry.presentedFrames = 1;
+    telemetry.missedVblanks = 2;
+
+    const QVariantMap map = telemetry.toVariantMap();
+    QCOMPARE(map.value(QStringLiteral("presentedFrames")).toULongLong(), 1ull);
+    QCOMPARE(map.value(QStringLiteral("missedVblanks")).toULongLong(), 2ull);
+    QCOMPARE(map.value(QStringLiteral("renderTime")).toMap().value(QStringLiteral("count")).toULongLong(), 1ull);
+    QCOMPARE(map.value(QStringLiteral("syncWaitTime")).toMap().value(QStringLiteral("count")).toULongLong(), 1ull);
+
+    telemetry.reset();
+    QCOMPARE(telemetry.renderTime.count(), uint64_t(0));
+    QCOMPARE(telemetry.latency.count(), uint64_t(0));
+    QCOMPARE(telemetry.syncWaitTime.count(), uint64_t(0));
+    QCOMPARE(telemetry.presentedFrames, uint64_t(0));
+    QCOMPARE(telemetry.missedVblanks, uint64_t(0));
+}
+
+QTEST_GUILESS_MAIN(TestFrameTelemetry)
+#include "test_frametelemetry.moc"
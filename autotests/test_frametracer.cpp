@@ -0,0 +1,190 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTest>
+
+#include "frametracer.h"
+
+class TestFrameTracer : public QObject
+{
+    Q_OBJECT
+public:
+    TestFrameTracer();
+private Q_SLOTS:
+    void cleanup();
+    void benchmarkScopeOff();
+    void benchmarkCounterOff();
+    void benchmarkScopeOn();
+    void chromeTrace();
+    void threadTime();
+    void ringOverflow();
+    void recordWithoutTracer();
+};
+
+TestFrameTracer::TestFrameTracer()
+{
+    KWin::FrameTracer::create();
+}
+
+void TestFrameTracer::cleanup()
+{
+    KWin::FrameTracer::self()->setEnabled(false);
+    KWin::FrameTracer::setThreadTimeEnabled(false);
+    KWin::FrameTracer::self()->clear();
+}
+
+void TestFrameTracer::benchmarkScopeOff()
+{
+    // this macro should no-op, so take no time at all
+    QBENCHMARK {
+        frameTraceScope("BENCH");
+    }
+}
+
+void TestFrameTracer::benchmarkCounterOff()
+{
+    QBENCHMARK {
+        frameTraceCounter("BENCH", 123);
+    }
+}
+
+void TestFrameTracer::benchmarkScopeOn()
+{
+    KWin::FrameTracer::self()->setEnabled(true);
+    QBENCHMARK {
+        frameTraceScope("BENCH");
+    }
+}
+
+void TestFrameTracer::chromeTrace()
+{
+    {
+        frameTraceScope("DISABLED");
+    }
+
+    KWin::FrameTracer::self()->setEnabled(true);
+    QVERIFY(KWin::FrameTracer::self()->isEnabled());
+
+    {
+        frameTraceScope("TEST_SCOPE");
+        frameTraceCounter("TEST_COUNTER", 42);
+        frameTraceFlowBegin("TEST_FLOW", 7);
+    }
+    frameTraceFlowEnd("TEST_FLOW", 7);
+    frameTraceInstant("TEST_INSTANT");
+
+    const QJsonDocument document = QJsonDocument::fromJson(KWin::FrameTracer::self()->chromeTrace());
+    QVERIFY(document.isObject());
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+
+    QStringList phases;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (phase == QLatin1String("M")) {
+            continue;
+        }
+        QVERIFY(event.value(QStringLiteral("name")).toString() != QLatin1String("DISABLED"));
+        phases.append(phase);
+        if (phase == QLatin1String("C")) {
+            QCOMPARE(event.value(QStringLiteral("args")).toObject().value(QStringLiteral("value")).toInt(), 42);
+        } else if (phase == QLatin1String("s") || phase == QLatin1String("f")) {
+            QCOMPARE(event.value(QStringLiteral("id")).toInt(), 7);
+        }
+    }
+    QCOMPARE(phases, (QStringList{QStringLiteral("B"), QStringLiteral("C"), QStringLiteral("s"), QStringLiteral("E"), QStringLiteral("f"), QStringLiteral("i")}));
+}
+
+void TestFrameTracer::threadTime()
+{
+    KWin::FrameTracer::self()->setEnabled(true);
+    KWin::FrameTracer::setThreadTimeEnabled(true);
+
+    QVERIFY(!KWin::FrameTracer::isInSlice());
+    {
+        frameTraceScope("TEST_SCOPE");
+        QVERIFY(KWin::FrameTracer::isInSlice());
+    }
+    QVERIFY(!KWin::FrameTracer::isInSlice());
+
+    const QJsonDocument document = QJsonDocument::fromJson(KWin::FrameTracer::self()->chromeTrace());
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+
+    QList<double> threadTimestamps;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (phase == QLatin1String("B") || phase == QLatin1String("E")) {
+            QVERIFY(event.contains(QStringLiteral("tts")));
+            threadTimestamps.append(event.value(QStringLiteral("tts")).toDouble());
+        }
+    }
+    QCOMPARE(threadTimestamps.size(), 2);
+    QVERIFY(threadTimestamps[0] <= threadTimestamps[1]);
+}
+
+void TestFrameTracer::ringOverflow()
+{
+    KWin::FrameTracer::self()->setEnabled(true);
+    for (size_t i = 0; i < KWin::FrameTraceRing::Capacity + 10; ++i) {
+        frameTraceCounter("OVERFLOW", i);
+    }
+
+    const QJsonDocument document = QJsonDocument::fromJson(KWin::FrameTracer::self()->chromeTrace());
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+
+    int counters = 0;
+    qint64 firstValue = -1;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("ph")).toString() == QLatin1String("C")) {
+            if (firstValue == -1) {
+                firstValue = event.value(QStringLiteral("args")).toObject().value(QStringLiteral("value")).toInteger();
+            }
+            counters++;
+        }
+    }
+    QCOMPARE(counters, int(KWin::FrameTraceRing::Capacity));
+    QCOMPARE(firstValue, 10);
+}
+
+void TestFrameTracer::recordWithoutTracer()
+{
+    KWin::FrameTracer::self()->setEnabled(true);
+    frameTraceInstant("BEFORE");
+
+    // Recording must be a no-op while there is no tracer, and a new tracer must not reuse the
+    // ring that has been destroyed with the old one.
+    delete KWin::FrameTracer::self();
+    KWin::FrameTracer::record(KWin::FrameTraceEvent::Type::Instant, "WITHOUT_TRACER");
+
+    KWin::FrameTracer::create();
+    KWin::FrameTracer::self()->setEnabled(true);
+    frameTraceInstant("AFTER");
+
+    const QJsonDocument document = QJsonDocument::fromJson(KWin::FrameTracer::self()->chromeTrace());
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+
+    QStringList names;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("ph")).toString() == QLatin1String("i")) {
+            names.append(event.value(QStringLiteral("name")).toString());
+        }
+    }
+    QCOMPARE(names, QStringList{QStringLiteral("AFTER")});
+}
+
+QTEST_MAIN(TestFrameTracer)
+
+#include "test_frametracer.moc"
@@ -0,0 +1,132 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "core/renderloop.h"
+#include "core/renderloop_p.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderLoop : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void selectPresentationMode_data();
+    void selectPresentationMode();
+    void vsyncTargetsVblank();
+    void adaptiveSyncTargetsRefreshInterval();
+    void asyncTargetsNow_data();
+    void asyncTargetsNow();
+};
+
+void TestRenderLoop::selectPresentationMode_data()
+{
+    QTest::addColumn<bool>("adaptiveSyncCapable");
+    QTest::addColumn<VrrPolicy>("vrrPolicy");
+    QTest::addColumn<bool>("wantsAdaptiveSync");
+    QTest::addColumn<bool>("tearingCapable");
+    QTest::addColumn<bool>("wantsTearing");
+    QTest::addColumn<PresentationMode>("expected");
+
+    QTest::newRow("nothing") << false << VrrPolicy::Automatic << false << false << false << PresentationMode::VSync;
+    QTest::newRow("vrr incapable") << false << VrrPolicy::Always << true << false << false << PresentationMode::VSync;
+    QTest::newRow("vrr never") << true << VrrPolicy::Never << true << false << false << PresentationMode::VSync;
+    QTest::newRow("vrr always") << true << VrrPolicy::Always << false << false << false << PresentationMode::AdaptiveSync;
+    QTest::newRow("vrr automatic, not wanted") << true << VrrPolicy::Automatic << false << false << false << PresentationMode::VSync;
+    QTest::newRow("vrr automatic, wanted") << true << VrrPolicy::Automatic << true << false << false << PresentationMode::AdaptiveSync;
+    QTest::newRow("tearing incapable") << false << VrrPolicy::Automatic << false << false << true << PresentationMode::VSync;
+    QTest::newRow("tearing not wanted") << false << VrrPolicy::Automatic << false << true << false << PresentationMode::VSync;
+    QTest::newRow("tearing") << false << VrrPolicy::Automatic << false << true << true << PresentationMode::Async;
+    QTest::newRow("vrr and tearing") << true << VrrPolicy::Automatic << true << true << true << PresentationMode::AdaptiveAsync;
+}
+
+void TestRenderLoop::selectPresentationMode()
+{
+    QFETCH(bool, adaptiveSyncCapable);
+    QFETCH(VrrPolicy, vrrPolicy);
+    QFETCH(bool, wantsAdaptiveSync);
+    QFETCH(bool, tearingCapable);
+    QFETCH(bool, wantsTearing);
+
+    QTEST(RenderLoop::selectPresentationMode(adaptiveSyncCapable, vrrPolicy, wantsAdaptiveSync, tearingCapable, wantsTearing), "expected");
+}
+
+/**
+ * An arbitrary point in time. The render loops use it as their current time, so the tests
+ * don't depend on how long they take to run.
+ */
+static const std::chrono::nanoseconds s_now = 1000s;
+
+void TestRenderLoop::vsyncTargetsVblank()
+{
+    // With vsync, the next frame must be aligned to the vblank grid and be in the future.
+    RenderLoop loop(nullptr);
+    loop.setRefreshRate(60000);
+    const std::chrono::nanoseconds refreshInterval(1'000'000'000'000ull / 60000);
+
+    RenderLoopPrivate *d = RenderLoopPrivate::get(&loop);
+    d->clock = []() {
+        return s_now;
+    };
+    d->notifyVblank(s_now - refreshInterval * 5 / 2);
+    d->scheduleRepaint(d->lastPresentationTimestamp);
+
+    QCOMPARE(loop.presentationMode(), PresentationMode::VSync);
+    QCOMPARE(loop.nextPresentationTimestamp(), loop.lastPresentationTimestamp() + 3 * refreshInterval);
+}
+
+void TestRenderLoop::adaptiveSyncTargetsRefreshInterval()
+{
+    // With adaptive sync, the next frame can be presented as soon as the minimum refresh
+    // interval has passed, it doesn't have to wait for a vblank.
+    RenderLoop loop(nullptr);
+    loop.setRefreshRate(60000);
+    loop.setPresentationMode(PresentationMode::AdaptiveSync);
+    const std::chrono::nanoseconds refreshInterval(1'000'000'000'000ull / 60000);
+
+    RenderLoopPrivate *d = RenderLoopPrivate::get(&loop);
+    d->clock = []() {
+        return s_now;
+    };
+    d->notifyVblank(s_now - refreshInterval * 5 / 2);
+    d->scheduleRepaint(d->lastPresentationTimestamp);
+
+    QCOMPARE(loop.presentationMode(), PresentationMode::AdaptiveSync);
+    QCOMPARE(loop.nextPresentationTimestamp(), loop.lastPresentationTimestamp() + refreshInterval);
+}
+
+void TestRenderLoop::asyncTargetsNow_data()
+{
+    QTest::addColumn<PresentationMode>("mode");
+
+    QTest::newRow("async") << PresentationMode::Async;
+    QTest::newRow("adaptive async") << PresentationMode::AdaptiveAsync;
+}
+
+void TestRenderLoop::asyncTargetsNow()
+{
+    // When tearing is allowed, frames are presented as soon as they are ready.
+    QFETCH(PresentationMode, mode);
+
+    RenderLoop loop(nullptr);
+    loop.setRefreshRate(60000);
+    loop.setPresentationMode(mode);
+    const std::chrono::nanoseconds refreshInterval(1'000'000'000'000ull / 60000);
+
+    RenderLoopPrivate *d = RenderLoopPrivate::get(&loop);
+    d->clock = []() {
+        return s_now;
+    };
+    d->notifyVblank(s_now - refreshInterval / 2);
+    d->scheduleRepaint(d->lastPresentationTimestamp);
+
+    QCOMPARE(loop.nextPresentationTimestamp(), s_now);
+}
+
+QTEST_GUILESS_MAIN(TestRenderLoop)
+#include "test_renderloop.moc"
@@ -0,0 +1,178 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "sm.h"
+
+using namespace KWin;
+
+class TestSessionInfoIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void matchSessionIdAndRole();
+    void matchSessionIdWithoutRole();
+    void matchClassAndCommand();
+    void windowTypeMismatch();
+    void firstEntryWins();
+
+    void benchmarkRestore_data();
+    void benchmarkRestore();
+};
+
+static SessionInfo *createInfo(const QByteArray &sessionId, const QString &windowRole,
+                               const QString &resourceName, const QString &resourceClass, const QString &wmCommand)
+{
+    auto info = new SessionInfo{};
+    info->sessionId = sessionId;
+    info->windowRole = windowRole;
+    info->resourceName = resourceName;
+    info->resourceClass = resourceClass;
+    info->wmCommand = wmCommand;
+    info->windowType = WindowType::Normal;
+    return info;
+}
+
+static bool isNormalWindow(const SessionInfo *info)
+{
+    return info->windowType == WindowType::Normal;
+}
+
+void TestSessionInfoIndex::matchSessionIdAndRole()
+{
+    SessionInfoIndex index;
+    SessionInfo *mainWindow = createInfo("1234", QStringLiteral("MainWindow#1"), QStringLiteral("dolphin"), QStringLiteral("dolphin"), QString());
+    SessionInfo *otherWindow = createInfo("1234", QStringLiteral("MainWindow#2"), QStringLiteral("dolphin"), QStringLiteral("dolphin"), QString());
+    index.add(mainWindow);
+    index.add(otherWindow);
+
+    // The resource name and class don't matter if there is a window role.
+    std::unique_ptr<SessionInfo> info(index.take("1234", QStringLiteral("MainWindow#2"), QStringLiteral("other"), QStringLiteral("other"), QString(), isNormalWindow));
+    QCOMPARE(info.get(), otherWindow);
+    QCOMPARE(index.count(), 1);
+
+    QVERIFY(!index.take("5678", QStringLiteral("MainWindow#1"), QStringLiteral("dolphin"), QStringLiteral("dolphin"), QString(), isNormalWindow));
+    QVERIFY(!index.take("1234", QStringLiteral("MainWindow#2"), QStringLiteral("dolphin"), QStringLiteral("dolphin"), QString(), isNormalWindow));
+}
+
+void TestSessionInfoIndex::matchSessionIdWithoutRole()
+{
+    SessionInfoIndex index;
+    SessionInfo *withRole = createInfo("1234", QStringLiteral("role"), QStringLiteral("xterm"), QStringLiteral("xterm"), QString());
+    SessionInfo *withoutRole = createInfo("1234", QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QString());
+    index.add(withRole);
+    index.add(withoutRole);
+
+    QVERIFY(!index.take("1234", QString(), QStringLiteral("xclock"), QStringLiteral("xclock"), QString(), isNormalWindow));
+
+    std::unique_ptr<SessionInfo> info(index.take("1234", QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QString(), isNormalWindow));
+    QCOMPARE(info.get(), withoutRole);
+    QCOMPARE(index.count(), 1);
+}
+
+void TestSessionInfoIndex::matchClassAndCommand()
+{
+    SessionInfoIndex index;
+    SessionInfo *first = createInfo(QByteArray(), QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QStringLiteral("xterm -e top"));
+    SessionInfo *second = createInfo(QByteArray(), QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QStringLiteral("xterm -e htop"));
+    index.add(first);
+    index.add(second);
+
+    std::unique_ptr<SessionInfo> info(index.take(QByteArray(), QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QStringLiteral("xterm -e htop"), isNormalWindow));
+    QCOMPARE(info.get(), second);
+
+    QVERIFY(!index.take(QByteArray(), QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QStringLiteral("xterm -e htop"), isNormalWindow));
+
+    // Without a command, any entry of the same class matches.
+    info.reset(index.take(QByteArray(), QString(), QStringLiteral("xterm"), QStringLiteral("xterm"), QString(), isNormalWindow));
+    QCOMPARE(info.get(), first);
+    QCOMPARE(index.count(), 0);
+}
+
+void TestSessionInfoIndex::windowTypeMismatch()
+{
+    SessionInfoIndex index;
+    SessionInfo *dialog = createInfo("1234", QStringLiteral("role"), QStringLiteral("app"), QStringLiteral("app"), QString());
+    dialog->windowType = WindowType::Dialog;
+    SessionInfo *normal = createInfo("1234", QStringLiteral("role"), QStringLiteral("app"), QStringLiteral("app"), QString());
+    index.add(dialog);
+    index.add(normal);
+
+    std::unique_ptr<SessionInfo> info(index.take("1234", QStringLiteral("role"), QStringLiteral("app"), QStringLiteral("app"), QString(), isNormalWindow));
+    QCOMPARE(info.get(), normal);
+    QCOMPARE(index.count(), 1);
+}
+
+void TestSessionInfoIndex::firstEntryWins()
+{
+    SessionInfoIndex index;
+    QList<SessionInfo *> infos;
+    for (int i = 0; i < 3; ++i) {
+        infos.append(createInfo(QByteArray(), QString(), QStringLiteral("app"), QStringLiteral("app"), QStringLiteral("app")));
+        index.add(infos.last());
+    }
+
+    for (SessionInfo *expected : std::as_const(infos)) {
+        std::unique_ptr<SessionInfo> info(index.take(QByteArray(), QString(), QStringLiteral("app"), QStringLiteral("app"), QStringLiteral("app"), isNormalWindow));
+        QCOMPARE(info.get(), expected);
+    }
+}
+
+void TestSessionInfoIndex::benchmarkRestore_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : {100, 400, 800}) {
+        QTest::addRow("%d windows", count) << count;
+    }
+}
+
+void TestSessionInfoIndex::benchmarkRestore()
+{
+    QFETCH(int, count);
+
+    // A session with a few applications that have many windows each, half of them session
+    // managed, and the windows mapping in the reverse order at login.
+    struct SavedWindow
+    {
+        QByteArray sessionId;
+        QString windowRole;
+        QString resourceClass;
+        QString wmCommand;
+    };
+    QList<SavedWindow> windows;
+    for (int i = 0; i < count; ++i) {
+        const QString application = QStringLiteral("app%1").arg(i % 8);
+        if (i % 2) {
+            windows.append(SavedWindow{
+                .sessionId = QByteArray::number(i % 8),
+                .windowRole = QStringLiteral("MainWindow#%1").arg(i),
+                .resourceClass = application,
+            });
+        } else {
+            windows.append(SavedWindow{
+                .resourceClass = application,
+                .wmCommand = application + QStringLiteral(" --document %1").arg(i),
+            });
+        }
+    }
+
+    QBENCHMARK {
+        SessionInfoIndex index;
+        for (const SavedWindow &window : std::as_const(windows)) {
+            index.add(createInfo(window.sessionId, window.windowRole, window.resourceClass, window.resourceClass, window.wmCommand));
+        }
+        for (auto it = windows.crbegin(); it != windows.crend(); ++it) {
+            std::unique_ptr<SessionInfo> info(index.take(it->sessionId, it->windowRole, it->resourceClass, it->resourceClass, it->wmCommand, isNormalWindow));
+            QVERIFY(info);
+        }
+        QCOMPARE(index.count(), 0);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSessionInfoIndex)
+#include "test_sessioninfoindex.moc"
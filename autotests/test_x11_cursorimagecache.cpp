@@ -0,0 +1,77 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "backends/x11/standalone/x11_standalone_cursorimagecache.h"
+
+#include <QSignalSpy>
+#include <QTest>
+#include <private/qtx11extras_p.h>
+
+using namespace KWin;
+
+class TestX11CursorImageCache : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void fetchOnce();
+    void fetchUnknownSerial();
+};
+
+void TestX11CursorImageCache::initTestCase()
+{
+    xcb_connection_t *connection = QX11Info::connection();
+    const xcb_query_extension_reply_t *extension = xcb_get_extension_data(connection, &xcb_xfixes_id);
+    if (!extension || !extension->present) {
+        QSKIP("XFixes is not available");
+    }
+    xcb_discard_reply(connection, xcb_xfixes_query_version_unchecked(connection, 2, 0).sequence);
+}
+
+void TestX11CursorImageCache::fetchOnce()
+{
+    X11CursorImageCache cache(QX11Info::connection());
+    QVERIFY(!cache.currentSerial());
+
+    const PlatformCursorImage image = cache.image();
+    QVERIFY(!image.isNull());
+    QVERIFY(cache.currentSerial());
+    QCOMPARE(cache.fetchCount(), 1);
+
+    // The image of a cursor that is displayed again is taken from the cache.
+    QSignalSpy imageChangedSpy(&cache, &X11CursorImageCache::imageChanged);
+    cache.notifyCursorChanged(*cache.currentSerial());
+    QCOMPARE(imageChangedSpy.count(), 1);
+    QVERIFY(!cache.isFetchPending());
+    QCOMPARE(cache.fetchCount(), 1);
+
+    const PlatformCursorImage cachedImage = cache.image();
+    QCOMPARE(cachedImage.image(), image.image());
+    QCOMPARE(cachedImage.hotSpot(), image.hotSpot());
+    QCOMPARE(cache.fetchCount(), 1);
+}
+
+void TestX11CursorImageCache::fetchUnknownSerial()
+{
+    X11CursorImageCache cache(QX11Info::connection());
+    cache.image();
+    const uint32_t serial = *cache.currentSerial();
+
+    // A notification about a cursor that isn't cached is answered asynchronously. The X server
+    // has the final say about which cursor is current.
+    QSignalSpy imageChangedSpy(&cache, &X11CursorImageCache::imageChanged);
+    cache.notifyCursorChanged(serial + 1000);
+    QVERIFY(cache.isFetchPending());
+    QCOMPARE(cache.fetchCount(), 2);
+    QVERIFY(imageChangedSpy.wait());
+    QVERIFY(!cache.isFetchPending());
+    QCOMPARE(*cache.currentSerial(), serial);
+}
+
+QTEST_MAIN(TestX11CursorImageCache)
+#include "test_x11_cursorimagecache.moc"
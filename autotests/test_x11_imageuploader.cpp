@@ -0,0 +1,195 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "backends/x11/standalone/x11_standalone_imageuploader.h"
+#include "utils/c_ptr.h"
+
+#include <QCoreApplication>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <xcb/shm.h>
+
+using namespace KWin;
+
+class TestX11ImageUploader : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void shmPutImage();
+    void putImage();
+    void lostCompletion();
+
+private:
+    void dispatchCompletion(X11ImageUploader *uploader);
+    uint32_t pixel(const QPoint &pos);
+
+    xcb_connection_t *m_connection = nullptr;
+    xcb_pixmap_t m_pixmap = XCB_PIXMAP_NONE;
+    uint8_t m_depth = 0;
+    uint8_t m_completionEvent = 0;
+};
+
+void TestX11ImageUploader::initTestCase()
+{
+    // Use a dedicated connection, the events are read from it by the test. The shared memory
+    // segments are attached to the connection of the application.
+    m_connection = xcb_connect(nullptr, nullptr);
+    QVERIFY(!xcb_connection_has_error(m_connection));
+    qApp->setProperty("x11Connection", QVariant::fromValue<void *>(m_connection));
+
+    const xcb_query_extension_reply_t *extension = xcb_get_extension_data(m_connection, &xcb_shm_id);
+    if (extension && extension->present) {
+        m_completionEvent = extension->first_event + XCB_SHM_COMPLETION;
+    }
+
+    m_depth = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data->root_depth;
+    if (m_depth != 24 && m_depth != 32) {
+        QSKIP("Unsupported root window depth");
+    }
+}
+
+void TestX11ImageUploader::cleanupTestCase()
+{
+    qApp->setProperty("x11Connection", QVariant());
+    xcb_disconnect(m_connection);
+}
+
+void TestX11ImageUploader::init()
+{
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data;
+    m_pixmap = xcb_generate_id(m_connection);
+    xcb_create_pixmap(m_connection, m_depth, m_pixmap, screen->root, 100, 100);
+    xcb_flush(m_connection);
+}
+
+void TestX11ImageUploader::cleanup()
+{
+    xcb_free_pixmap(m_connection, m_pixmap);
+    xcb_flush(m_connection);
+    m_pixmap = XCB_PIXMAP_NONE;
+}
+
+void TestX11ImageUploader::dispatchCompletion(X11ImageUploader *uploader)
+{
+    while (true) {
+        UniqueCPtr<xcb_generic_event_t> event(xcb_wait_for_event(m_connection));
+        QVERIFY(event);
+        if ((event->response_type & ~0x80) == m_completionEvent) {
+            QVERIFY(uploader->handleEvent(event.get()));
+            return;
+        }
+    }
+}
+
+uint32_t TestX11ImageUploader::pixel(const QPoint &pos)
+{
+    UniqueCPtr<xcb_get_image_reply_t> reply(xcb_get_image_reply(m_connection,
+                                                                xcb_get_image_unchecked(m_connection, XCB_IMAGE_FORMAT_Z_PIXMAP, m_pixmap, pos.x(), pos.y(), 1, 1, ~0),
+                                                                nullptr));
+    if (!reply) {
+        return 0;
+    }
+    // The padding byte of opaque pixels is undefined.
+    return *reinterpret_cast<const uint32_t *>(xcb_get_image_data(reply.get())) & 0x00ffffff;
+}
+
+void TestX11ImageUploader::shmPutImage()
+{
+    if (!m_completionEvent) {
+        QSKIP("MIT-SHM is not available");
+    }
+    X11ImageUploader uploader(m_connection, m_pixmap, m_depth, true);
+    uploader.resize(QSize(100, 100));
+    if (!uploader.isShmEnabled()) {
+        QSKIP("The X server can't access shared memory of the test");
+    }
+    QSignalSpy uploadedSpy(&uploader, &X11ImageUploader::uploaded);
+
+    uploader.image()->fill(QColor(255, 0, 0));
+    uploader.upload({QRect(0, 0, 100, 50)});
+    QVERIFY(uploader.isPending());
+    QCOMPARE(uploadedSpy.count(), 0);
+
+    dispatchCompletion(&uploader);
+    QVERIFY(!uploader.isPending());
+    QCOMPARE(uploadedSpy.count(), 1);
+    QCOMPARE(pixel(QPoint(10, 10)), 0xff0000u);
+
+    // Only the uploaded rectangles are copied.
+    uploader.image()->fill(QColor(0, 0, 255));
+    uploader.upload({QRect(0, 50, 100, 50)});
+    dispatchCompletion(&uploader);
+    QCOMPARE(uploadedSpy.count(), 2);
+    QCOMPARE(pixel(QPoint(10, 10)), 0xff0000u);
+    QCOMPARE(pixel(QPoint(10, 60)), 0x0000ffu);
+}
+
+void TestX11ImageUploader::putImage()
+{
+    X11ImageUploader uploader(m_connection, m_pixmap, m_depth, false);
+    uploader.resize(QSize(100, 100));
+    QVERIFY(!uploader.isShmEnabled());
+    QSignalSpy uploadedSpy(&uploader, &X11ImageUploader::uploaded);
+
+    // PutImage carries a copy of the pixels, the image can be reused right away.
+    uploader.image()->fill(QColor(0, 255, 0));
+    uploader.upload({QRect(0, 0, 50, 100), QRect(50, 0, 50, 100)});
+    QVERIFY(!uploader.isPending());
+    QCOMPARE(uploadedSpy.count(), 1);
+    QCOMPARE(pixel(QPoint(10, 10)), 0x00ff00u);
+    QCOMPARE(pixel(QPoint(90, 90)), 0x00ff00u);
+
+    uploader.upload({});
+    QCOMPARE(uploadedSpy.count(), 2);
+}
+
+void TestX11ImageUploader::lostCompletion()
+{
+    if (!m_completionEvent) {
+        QSKIP("MIT-SHM is not available");
+    }
+    X11ImageUploader uploader(m_connection, m_pixmap, m_depth, true);
+    uploader.resize(QSize(100, 100));
+    if (!uploader.isShmEnabled()) {
+        QSKIP("The X server can't access shared memory of the test");
+    }
+    QSignalSpy uploadedSpy(&uploader, &X11ImageUploader::uploaded);
+
+    // The completion event is never passed to the uploader.
+    uploader.image()->fill(QColor(255, 0, 0));
+    uploader.upload({QRect(0, 0, 100, 100)});
+    QVERIFY(uploader.isPending());
+    QVERIFY(uploadedSpy.wait());
+    QVERIFY(!uploader.isPending());
+    QVERIFY(!uploader.isShmEnabled());
+    QCOMPARE(pixel(QPoint(10, 10)), 0xff0000u);
+
+    // The image keeps its contents when it's moved out of shared memory.
+    QCOMPARE(uploader.image()->pixelColor(10, 10), QColor(255, 0, 0));
+
+    // The late completion event is consumed without being reported again.
+    dispatchCompletion(&uploader);
+    QCOMPARE(uploadedSpy.count(), 1);
+
+    uploader.image()->fill(QColor(0, 0, 255));
+    uploader.upload({QRect(0, 0, 100, 100)});
+    QCOMPARE(uploadedSpy.count(), 2);
+    QCOMPARE(pixel(QPoint(10, 10)), 0x0000ffu);
+
+    // Shared memory isn't used anymore, also not for a new image.
+    uploader.resize(QSize(50, 50));
+    QVERIFY(!uploader.isShmEnabled());
+}
+
+QTEST_GUILESS_MAIN(TestX11ImageUploader)
+#include "test_x11_imageuploader.moc"
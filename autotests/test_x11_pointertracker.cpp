@@ -0,0 +1,73 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "backends/x11/standalone/x11_standalone_pointertracker.h"
+
+#include <QSignalSpy>
+#include <QTest>
+#include <private/qtx11extras_p.h>
+
+using namespace KWin;
+
+class TestX11PointerTracker : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void coalesceBurst();
+    void updateWithoutQuery();
+    void followWarps();
+};
+
+void TestX11PointerTracker::coalesceBurst()
+{
+    // A burst of pointer events, e.g. from a mouse with a high polling rate, must not result in
+    // a query per event.
+    X11PointerTracker tracker(QX11Info::connection(), QX11Info::appRootWindow());
+    for (int i = 0; i < 1000; ++i) {
+        tracker.invalidate();
+    }
+    QCOMPARE(tracker.queryCount(), 1);
+    QVERIFY(tracker.isQueryPending());
+
+    // Events that were handled while the first query was in flight are covered by one more query.
+    QTRY_VERIFY(!tracker.isQueryPending());
+    QCOMPARE(tracker.queryCount(), 2);
+    QVERIFY(tracker.isValid());
+}
+
+void TestX11PointerTracker::updateWithoutQuery()
+{
+    // Once the state is known, reading it doesn't need a round trip.
+    X11PointerTracker tracker(QX11Info::connection(), QX11Info::appRootWindow());
+    tracker.update();
+    QVERIFY(tracker.isValid());
+    QCOMPARE(tracker.queryCount(), 1);
+
+    tracker.update();
+    QCOMPARE(tracker.queryCount(), 1);
+}
+
+void TestX11PointerTracker::followWarps()
+{
+    xcb_connection_t *connection = QX11Info::connection();
+    X11PointerTracker tracker(connection, QX11Info::appRootWindow());
+    QSignalSpy changedSpy(&tracker, &X11PointerTracker::changed);
+
+    xcb_warp_pointer(connection, XCB_WINDOW_NONE, QX11Info::appRootWindow(), 0, 0, 0, 0, 10, 20);
+    tracker.invalidate();
+    QTRY_COMPARE(tracker.position(), QPointF(10, 20));
+    QCOMPARE(changedSpy.count(), 1);
+
+    xcb_warp_pointer(connection, XCB_WINDOW_NONE, QX11Info::appRootWindow(), 0, 0, 0, 0, 30, 40);
+    tracker.invalidate();
+    QTRY_COMPARE(tracker.position(), QPointF(30, 40));
+    QCOMPARE(changedSpy.count(), 2);
+}
+
+QTEST_MAIN(TestX11PointerTracker)
+#include "test_x11_pointertracker.moc"
@@ -0,0 +1,123 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "backends/x11/standalone/x11_standalone_presentvsyncmonitor.h"
+#include "utils/c_ptr.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace KWin;
+
+class TestPresentVsyncMonitor : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void vblank();
+    void armTwice();
+
+private:
+    void dispatchEvents(PresentVsyncMonitor *monitor, QSignalSpy *spy, int count);
+
+    xcb_connection_t *m_connection = nullptr;
+    xcb_window_t m_window = XCB_WINDOW_NONE;
+};
+
+void TestPresentVsyncMonitor::initTestCase()
+{
+    // Use a dedicated connection, the events are read from it by the test.
+    m_connection = xcb_connect(nullptr, nullptr);
+    QVERIFY(!xcb_connection_has_error(m_connection));
+    const xcb_query_extension_reply_t *extension = xcb_get_extension_data(m_connection, &xcb_present_id);
+    if (!extension || !extension->present) {
+        QSKIP("The Present extension is not available");
+    }
+}
+
+void TestPresentVsyncMonitor::cleanupTestCase()
+{
+    xcb_disconnect(m_connection);
+}
+
+void TestPresentVsyncMonitor::init()
+{
+    xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data;
+    m_window = xcb_generate_id(m_connection);
+    xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, m_window, screen->root,
+                      0, 0, 100, 100, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_map_window(m_connection, m_window);
+    xcb_flush(m_connection);
+}
+
+void TestPresentVsyncMonitor::cleanup()
+{
+    xcb_destroy_window(m_connection, m_window);
+    xcb_flush(m_connection);
+    m_window = XCB_WINDOW_NONE;
+}
+
+void TestPresentVsyncMonitor::dispatchEvents(PresentVsyncMonitor *monitor, QSignalSpy *spy, int count)
+{
+    while (spy->count() < count) {
+        UniqueCPtr<xcb_generic_event_t> event(xcb_wait_for_event(m_connection));
+        QVERIFY(event);
+        if ((event->response_type & ~0x80) != XCB_GE_GENERIC) {
+            continue;
+        }
+        const auto genericEvent = reinterpret_cast<xcb_ge_generic_event_t *>(event.get());
+        if (genericEvent->extension == monitor->majorOpcode() && genericEvent->event_type == XCB_PRESENT_COMPLETE_NOTIFY) {
+            QVERIFY(monitor->handleEvent(event.get()));
+        }
+    }
+}
+
+void TestPresentVsyncMonitor::vblank()
+{
+    std::unique_ptr<PresentVsyncMonitor> monitor = PresentVsyncMonitor::create(m_connection, m_window);
+    QVERIFY(monitor);
+    QSignalSpy vblankSpy(monitor.get(), &VsyncMonitor::vblankOccurred);
+
+    // Nothing presents the window, so the monitor has to request the notifications itself.
+    monitor->arm();
+    dispatchEvents(monitor.get(), &vblankSpy, 1);
+    QVERIFY(!monitor->isPresentedByDriver());
+    const uint64_t firstMsc = monitor->msc();
+    const auto firstTimestamp = vblankSpy.last().at(0).value<std::chrono::nanoseconds>();
+
+    monitor->arm();
+    dispatchEvents(monitor.get(), &vblankSpy, 2);
+    QVERIFY(monitor->msc() > firstMsc);
+    QVERIFY(vblankSpy.last().at(0).value<std::chrono::nanoseconds>() > firstTimestamp);
+
+    // The timestamps are in the same clock as the render loop.
+    const std::chrono::nanoseconds now = std::chrono::steady_clock::now().time_since_epoch();
+    QVERIFY(vblankSpy.last().at(0).value<std::chrono::nanoseconds>() <= now);
+}
+
+void TestPresentVsyncMonitor::armTwice()
+{
+    std::unique_ptr<PresentVsyncMonitor> monitor = PresentVsyncMonitor::create(m_connection, m_window);
+    QVERIFY(monitor);
+    QSignalSpy vblankSpy(monitor.get(), &VsyncMonitor::vblankOccurred);
+
+    // Arming an armed monitor doesn't result in another vblank.
+    monitor->arm();
+    monitor->arm();
+    dispatchEvents(monitor.get(), &vblankSpy, 1);
+
+    monitor->arm();
+    dispatchEvents(monitor.get(), &vblankSpy, 2);
+    QCOMPARE(vblankSpy.count(), 2);
+}
+
+QTEST_GUILESS_MAIN(TestPresentVsyncMonitor)
+#include "test_x11_presentvsyncmonitor.moc"
@@ -28,6 +28,10 @@ Atoms::Atoms()
     , net_wm_context_help(QByteArrayLiteral("_NET_WM_CONTEXT_HELP"))
     , net_wm_ping(QByteArrayLiteral("_NET_WM_PING"))
     , net_wm_user_time(QByteArrayLiteral("_NET_WM_USER_TIME"))
+    , net_wm_name(QByteArrayLiteral("_NET_WM_NAME"))
+    , net_wm_icon_name(QByteArrayLiteral("_NET_WM_ICON_NAME"))
+    , net_wm_icon(QByteArrayLiteral("_NET_WM_ICON"))
+    , net_wm_opaque_region(QByteArrayLiteral("_NET_WM_OPAQUE_REGION"))
     , kde_net_wm_user_creation_time(QByteArrayLiteral("_KDE_NET_WM_USER_CREATION_TIME"))
     , net_wm_take_activity(QByteArrayLiteral("_NET_WM_TAKE_ACTIVITY"))
     , net_wm_window_opacity(QByteArrayLiteral("_NET_WM_WINDOW_OPACITY"))
@@ -47,10 +51,14 @@ Atoms::Atoms()
     , kde_net_wm_frame_strut(QByteArrayLiteral("_KDE_NET_WM_FRAME_STRUT"))
     , net_wm_sync_request_counter(QByteArrayLiteral("_NET_WM_SYNC_REQUEST_COUNTER"))
     , net_wm_sync_request(QByteArrayLiteral("_NET_WM_SYNC_REQUEST"))
+    , net_wm_frame_drawn(QByteArrayLiteral("_NET_WM_FRAME_DRAWN"))
+    , net_wm_frame_timings(QByteArrayLiteral("_NET_WM_FRAME_TIMINGS"))
+    , net_supported(QByteArrayLiteral("_NET_SUPPORTED"))
     , kde_net_wm_shadow(QByteArrayLiteral("_KDE_NET_WM_SHADOW"))
     , kde_color_sheme(QByteArrayLiteral("_KDE_NET_WM_COLOR_SCHEME"))
     , kde_skip_close_animation(QByteArrayLiteral("_KDE_NET_WM_SKIP_CLOSE_ANIMATION"))
     , kde_screen_edge_show(QByteArrayLiteral("_KDE_NET_WM_SCREEN_EDGE_SHOW"))
+    , kde_net_wm_tearing_control(QByteArrayLiteral("_KDE_NET_WM_TEARING_CONTROL"))
     , utf8_string(QByteArrayLiteral("UTF8_STRING"))
     , text(QByteArrayLiteral("TEXT"))
     , uri_list(QByteArrayLiteral("text/uri-list"))
@@ -67,6 +75,8 @@ Atoms::Atoms()
     , wl_selection(QByteArrayLiteral("WL_SELECTION"))
     , primary(QByteArrayLiteral("PRIMARY"))
     , edid(QByteArrayLiteral("EDID"))
+    , vrr_capable(QByteArrayLiteral("vrr_capable"))
+    , variable_refresh(QByteArrayLiteral("_VARIABLE_REFRESH"))
     , xwayland_allow_commits(QByteArrayLiteral("_XWAYLAND_ALLOW_COMMITS"))
     , m_dtSmWindowInfo(QByteArrayLiteral("_DT_SM_WINDOW_INFO"))
     , m_motifSupport(QByteArrayLiteral("_MOTIF_WM_INFO"))
@@ -42,6 +42,10 @@ public:
     Xcb::Atom net_wm_context_help;
     Xcb::Atom net_wm_ping;
     Xcb::Atom net_wm_user_time;
+    Xcb::Atom net_wm_name;
+    Xcb::Atom net_wm_icon_name;
+    Xcb::Atom net_wm_icon;
+    Xcb::Atom net_wm_opaque_region;
     Xcb::Atom kde_net_wm_user_creation_time;
     Xcb::Atom net_wm_take_activity;
     Xcb::Atom net_wm_window_opacity;
@@ -61,10 +65,14 @@ public:
     Xcb::Atom kde_net_wm_frame_strut;
     Xcb::Atom net_wm_sync_request_counter;
     Xcb::Atom net_wm_sync_request;
+    Xcb::Atom net_wm_frame_drawn;
+    Xcb::Atom net_wm_frame_timings;
+    Xcb::Atom net_supported;
     Xcb::Atom kde_net_wm_shadow;
     Xcb::Atom kde_color_sheme;
     Xcb::Atom kde_skip_close_animation;
     Xcb::Atom kde_screen_edge_show;
+    Xcb::Atom kde_net_wm_tearing_control;
     Xcb::Atom utf8_string;
     Xcb::Atom text;
     Xcb::Atom uri_list;
@@ -81,6 +89,8 @@ public:
     Xcb::Atom wl_selection;
     Xcb::Atom primary;
     Xcb::Atom edid;
+    Xcb::Atom vrr_capable;
+    Xcb::Atom variable_refresh;
     Xcb::Atom xwayland_allow_commits;
 
     /**
@@ -0,0 +1,109 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "x11_standalone_asyncrequest.h"
+
+#include <QCoreApplication>
+
+#include <cstring>
+#include <utility>
+
+namespace KWin
+{
+
+X11AsyncRequest::X11AsyncRequest(xcb_connection_t *connection, Sender sender, Handler handler)
+    : m_connection(connection)
+    , m_window(xcb_generate_id(connection))
+    , m_sender(std::move(sender))
+    , m_handler(std::move(handler))
+{
+    const xcb_screen_t *screen = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data;
+    xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, m_window, screen->root,
+                      0, 0, 1, 1, 0, XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, 0, nullptr);
+    QCoreApplication::instance()->installNativeEventFilter(this);
+}
+
+X11AsyncRequest::~X11AsyncRequest()
+{
+    QCoreApplication::instance()->removeNativeEventFilter(this);
+    if (m_sequence) {
+        xcb_discard_reply(m_connection, *m_sequence);
+    }
+    xcb_destroy_window(m_connection, m_window);
+}
+
+bool X11AsyncRequest::isPending() const
+{
+    return m_sequence.has_value();
+}
+
+quint64 X11AsyncRequest::requestCount() const
+{
+    return m_requestCount;
+}
+
+void X11AsyncRequest::request()
+{
+    if (m_sequence) {
+        m_outdated = true;
+    } else {
+        send();
+    }
+}
+
+void X11AsyncRequest::waitForReply()
+{
+    while (m_sequence) {
+        handleReply(xcb_wait_for_reply(m_connection, *m_sequence, nullptr));
+    }
+}
+
+void X11AsyncRequest::send()
+{
+    m_sequence = m_sender();
+    m_requestCount++;
+
+    // A client message sent to a window of our own is delivered to us after the reply.
+    xcb_client_message_event_t event;
+    static_assert(sizeof(event) == 32, "Would leak stack data otherwise");
+    memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.window = m_window;
+    event.format = 32;
+    xcb_send_event(m_connection, false, m_window, XCB_EVENT_MASK_NO_EVENT, reinterpret_cast<const char *>(&event));
+    xcb_flush(m_connection);
+}
+
+void X11AsyncRequest::handleReply(void *reply)
+{
+    m_sequence.reset();
+    m_handler(reply, std::exchange(m_outdated, false));
+}
+
+bool X11AsyncRequest::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *)
+{
+    if (eventType != "xcb_generic_event_t") {
+        return false;
+    }
+
+    // Any event may come after the reply, the client message is only the one that certainly does.
+    if (m_sequence) {
+        void *reply = nullptr;
+        if (xcb_poll_for_reply(m_connection, *m_sequence, &reply, nullptr)) {
+            handleReply(reply);
+        }
+    }
+
+    const auto event = static_cast<xcb_generic_event_t *>(message);
+    if ((event->response_type & ~0x80) == XCB_CLIENT_MESSAGE) {
+        return reinterpret_cast<xcb_client_message_event_t *>(event)->window == m_window;
+    }
+    return false;
+}
+
+} // namespace KWin
@@ -0,0 +1,81 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QAbstractNativeEventFilter>
+
+#include <functional>
+#include <optional>
+
+#include <xcb/xcb.h>
+
+namespace KWin
+{
+
+/**
+ * The X11AsyncRequest class sends a request to the X server and hands its reply over without
+ * blocking the event loop.
+ *
+ * At most one request is in flight. If the request is made again while one is in flight, the
+ * handler is told that the reply may be outdated, and can make the request once more.
+ *
+ * Replies are collected from the X event dispatch path. Every request is followed by a client
+ * message to a helper window, which the X server sends after the reply, so the reply has been
+ * received by the time the client message is dispatched.
+ */
+class X11AsyncRequest : public QAbstractNativeEventFilter
+{
+public:
+    /**
+     * Sends the request and returns its sequence number.
+     */
+    using Sender = std::function<unsigned int()>;
+    /**
+     * Takes ownership of the @a reply, which is null if the request has failed. @a outdated is
+     * @c true if the request has been made again while it was in flight.
+     */
+    using Handler = std::function<void(void *reply, bool outdated)>;
+
+    X11AsyncRequest(xcb_connection_t *connection, Sender sender, Handler handler);
+    ~X11AsyncRequest() override;
+
+    /**
+     * Returns @c true if a request is waiting for its reply.
+     */
+    bool isPending() const;
+    /**
+     * Returns the number of requests sent so far.
+     */
+    quint64 requestCount() const;
+
+    /**
+     * Sends the request, or marks the request in flight as outdated. This never blocks.
+     */
+    void request();
+    /**
+     * Waits until the request in flight, and any request made by the handler, has been answered.
+     */
+    void waitForReply();
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override;
+
+private:
+    void send();
+    void handleReply(void *reply);
+
+    xcb_connection_t *m_connection;
+    xcb_window_t m_window;
+    Sender m_sender;
+    Handler m_handler;
+    std::optional<unsigned int> m_sequence;
+    bool m_outdated = false;
+    quint64 m_requestCount = 0;
+};
+
+} // namespace KWin
@@ -26,7 +26,6 @@
 #include "core/renderloop.h"
 #include "opengl/egldisplay.h"
 #include "options.h"
-#include "utils/c_ptr.h"
 #include "utils/edid.h"
 #include "utils/xcbutils.h"
 #include "window.h"
@@ -37,6 +36,7 @@
 #include "x11_standalone_logging.h"
 #include "x11_standalone_non_composited_outline.h"
 #include "x11_standalone_output.h"
+#include "x11_standalone_qpainter_backend.h"
 #include "x11_standalone_screenedges_filter.h"
 #include "xkb.h"
 
@@ -176,6 +176,11 @@ std::unique_ptr<OpenGLBackend> X11StandaloneBackend::createOpenGLBackend()
     }
 }
 
+std::unique_ptr<QPainterBackend> X11StandaloneBackend::createQPainterBackend()
+{
+    return std::make_unique<X11QPainterBackend>(this);
+}
+
 std::unique_ptr<Edge> X11StandaloneBackend::createScreenEdge(ScreenEdges *edges)
 {
     if (!m_screenEdgesFilter) {
@@ -204,19 +209,10 @@ bool X11StandaloneBackend::hasGlx()
 
 PlatformCursorImage X11StandaloneBackend::cursorImage() const
 {
-    auto c = kwinApp()->x11Connection();
-    UniqueCPtr<xcb_xfixes_get_cursor_image_reply_t> cursor(
-        xcb_xfixes_get_cursor_image_reply(c,
-                                          xcb_xfixes_get_cursor_image_unchecked(c),
-                                          nullptr));
-    if (!cursor) {
-        return PlatformCursorImage();
+    if (auto cursor = qobject_cast<X11Cursor *>(Cursors::self()->mouse())) {
+        return cursor->cursorImage();
     }
-
-    QImage qcursorimg((uchar *)xcb_xfixes_get_cursor_image_cursor_image(cursor.get()), cursor->width, cursor->height,
-                      QImage::Format_ARGB32_Premultiplied);
-    // deep copy of image as the data is going to be freed
-    return PlatformCursorImage(qcursorimg.copy(), QPoint(cursor->xhot, cursor->yhot));
+    return PlatformCursorImage();
 }
 
 void X11StandaloneBackend::updateCursor()
@@ -260,6 +256,7 @@ QList<CompositingType> X11StandaloneBackend::supportedCompositors() const
 #if HAVE_GLX
     compositors << OpenGLCompositing;
 #endif
+    compositors << QPainterCompositing;
     compositors << NoCompositing;
     return compositors;
 }
@@ -375,8 +372,18 @@ void X11StandaloneBackend::doUpdateOutputs()
                     X11Output::Information information{
                         .name = outputInfo.name(),
                         .physicalSize = physicalSize,
+                        // Async swaps only depend on the swap interval, the backend falls back
+                        // to vsync if it can't change the swap interval.
+                        .capabilities = Output::Capability::Tearing,
                     };
 
+                    // The kernel drivers expose whether the connector supports variable refresh
+                    // rates, the DDX enables it for flipping windows with _VARIABLE_REFRESH set.
+                    auto vrrProperty = Xcb::RandR::OutputProperty(xcbOutput, atoms->vrr_capable, XCB_ATOM_INTEGER, 0, 1, false, false);
+                    if (vrrProperty.value<uint32_t>(0)) {
+                        information.capabilities |= Output::Capability::Vrr;
+                    }
+
                     auto edidProperty = Xcb::RandR::OutputProperty(xcbOutput, atoms->edid, XCB_ATOM_INTEGER, 0, 100, false, false);
                     bool ok;
                     if (auto data = edidProperty.toByteArray(&ok); ok && !data.isEmpty()) {
@@ -54,6 +54,7 @@ public:
     xcb_window_t rootWindow() const;
 
     std::unique_ptr<OpenGLBackend> createOpenGLBackend() override;
+    std::unique_ptr<QPainterBackend> createQPainterBackend() override;
     QList<CompositingType> supportedCompositors() const override;
 
     void initOutputs();
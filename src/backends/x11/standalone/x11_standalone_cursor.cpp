@@ -9,6 +9,8 @@
 #include "x11_standalone_cursor.h"
 #include "utils/common.h"
 #include "utils/xcbutils.h"
+#include "x11_standalone_cursorimagecache.h"
+#include "x11_standalone_pointertracker.h"
 #include "x11_standalone_xfixes_cursor_event_filter.h"
 
 #include <QAbstractEventDispatcher>
@@ -21,11 +23,15 @@ X11Cursor::X11Cursor(bool xInputSupport)
     : Cursor()
     , m_buttonMask(0)
     , m_hasXInput(xInputSupport)
+    , m_pointerTracker(std::make_unique<X11PointerTracker>(connection(), rootWindow()))
+    , m_imageCache(std::make_unique<X11CursorImageCache>(connection()))
 {
     Cursors::self()->setMouse(this);
+    connect(m_pointerTracker.get(), &X11PointerTracker::changed, this, &X11Cursor::handlePointerChanged);
+    connect(m_imageCache.get(), &X11CursorImageCache::imageChanged, this, &X11Cursor::cursorChanged);
     if (!m_hasXInput) {
         // without XInput we don't get events about cursor movement, so we have to poll instead
-        connect(&m_mousePollingTimer, &QTimer::timeout, this, &X11Cursor::pollMouse);
+        connect(&m_mousePollingTimer, &QTimer::timeout, m_pointerTracker.get(), &X11PointerTracker::invalidate);
         m_mousePollingTimer.setSingleShot(false);
         m_mousePollingTimer.setInterval(50);
         m_mousePollingTimer.start();
@@ -51,42 +57,55 @@ void X11Cursor::doSetPos()
 {
     const QPointF &pos = currentPos();
     xcb_warp_pointer(connection(), XCB_WINDOW_NONE, rootWindow(), 0, 0, 0, 0, pos.x(), pos.y());
+    // A query that is in flight may have been answered before the warp.
+    m_pointerTracker->invalidate();
     // call default implementation to emit signal
     Cursor::doSetPos();
 }
 
 void X11Cursor::doGetPos()
 {
-    Xcb::Pointer pointer(rootWindow());
-    if (pointer.isNull()) {
-        return;
+    // With XInput, every pointer event invalidates the tracked state, so the last reply is as
+    // current as the handled events. Without it, the state is only polled periodically.
+    if (!m_hasXInput) {
+        m_pointerTracker->invalidate();
+        m_pointerTracker->update();
+    } else if (!m_pointerTracker->isValid()) {
+        m_pointerTracker->update();
+    }
+    if (m_pointerTracker->isValid()) {
+        m_buttonMask = m_pointerTracker->mask();
+        updatePos(m_pointerTracker->position());
     }
-    m_buttonMask = pointer->mask;
-    updatePos(QPointF(pointer->root_x, pointer->root_y));
 }
 
-void X11Cursor::pollMouse()
+void X11Cursor::handlePointerChanged()
 {
-    static QPointF lastPos = currentPos();
-    static uint16_t lastMask = m_buttonMask;
-    doGetPos(); // Update if needed
-    if (lastPos != currentPos() || lastMask != m_buttonMask) {
-        Q_EMIT mouseChanged(currentPos(), lastPos,
-                            x11ToQtMouseButtons(m_buttonMask), x11ToQtMouseButtons(lastMask),
-                            x11ToQtKeyboardModifiers(m_buttonMask), x11ToQtKeyboardModifiers(lastMask));
-        lastPos = currentPos();
-        lastMask = m_buttonMask;
+    m_buttonMask = m_pointerTracker->mask();
+    updatePos(m_pointerTracker->position());
+    if (m_lastPos != currentPos() || m_lastButtonMask != m_buttonMask) {
+        Q_EMIT mouseChanged(currentPos(), m_lastPos,
+                            x11ToQtMouseButtons(m_buttonMask), x11ToQtMouseButtons(m_lastButtonMask),
+                            x11ToQtKeyboardModifiers(m_buttonMask), x11ToQtKeyboardModifiers(m_lastButtonMask));
+        m_lastPos = currentPos();
+        m_lastButtonMask = m_buttonMask;
     }
 }
 
-void X11Cursor::notifyCursorChanged()
+PlatformCursorImage X11Cursor::cursorImage() const
+{
+    return m_imageCache->image();
+}
+
+void X11Cursor::notifyCursorChanged(uint32_t serial)
 {
-    Q_EMIT cursorChanged();
+    // cursorChanged() is emitted once the image of the new cursor is available
+    m_imageCache->notifyCursorChanged(serial);
 }
 
 void X11Cursor::notifyCursorPosChanged()
 {
-    pollMouse();
+    m_pointerTracker->invalidate();
 }
 }
 
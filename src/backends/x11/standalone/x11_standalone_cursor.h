@@ -14,6 +14,8 @@
 
 namespace KWin
 {
+class X11CursorImageCache;
+class X11PointerTracker;
 class XFixesCursorEventFilter;
 
 class KWIN_EXPORT X11Cursor : public Cursor
@@ -23,14 +25,20 @@ public:
     X11Cursor(bool xInputSupport = false);
     ~X11Cursor() override;
 
+    /**
+     * Returns the image of the current cursor. Recently displayed cursors are cached, so this
+     * doesn't block unless the image of the current cursor hasn't been received yet.
+     */
+    PlatformCursorImage cursorImage() const;
+
     /**
      * @internal
      *
-     * Called from X11 event handler.
+     * Called from X11 event handler with the serial of the new cursor.
      */
-    void notifyCursorChanged();
+    void notifyCursorChanged(uint32_t serial);
     /**
-     * @internal queries the cursor position
+     * @internal queries the cursor position without blocking
      */
     void notifyCursorPosChanged();
 
@@ -39,12 +47,17 @@ protected:
     void doGetPos() override;
 
 private:
-    void pollMouse();
+    void handlePointerChanged();
 
     uint16_t m_buttonMask;
+    QPointF m_lastPos;
+    uint16_t m_lastButtonMask = 0;
     QTimer m_mousePollingTimer;
     bool m_hasXInput;
 
+    std::unique_ptr<X11PointerTracker> m_pointerTracker;
+    std::unique_ptr<X11CursorImageCache> m_imageCache;
+
     std::unique_ptr<XFixesCursorEventFilter> m_xfixesFilter;
 
     friend class Cursor;
@@ -0,0 +1,116 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "x11_standalone_cursorimagecache.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace KWin
+{
+
+X11CursorImageCache::X11CursorImageCache(xcb_connection_t *connection, QObject *parent)
+    : QObject(parent)
+    , m_images(DefaultMaxCount)
+    , m_query(
+          connection,
+          [connection]() {
+              return xcb_xfixes_get_cursor_image_unchecked(connection).sequence;
+          },
+          [this](void *reply, bool outdated) {
+              handleReply(static_cast<xcb_xfixes_get_cursor_image_reply_t *>(reply), outdated);
+          })
+{
+}
+
+X11CursorImageCache::~X11CursorImageCache() = default;
+
+PlatformCursorImage X11CursorImageCache::image()
+{
+    if (!m_currentSerial || !m_images.contains(*m_currentSerial)) {
+        if (!m_query.isPending()) {
+            m_query.request();
+        }
+        m_query.waitForReply();
+    }
+
+    const PlatformCursorImage *image = m_currentSerial ? m_images.object(*m_currentSerial) : nullptr;
+    return image ? *image : PlatformCursorImage();
+}
+
+std::optional<uint32_t> X11CursorImageCache::currentSerial() const
+{
+    return m_currentSerial;
+}
+
+int X11CursorImageCache::maxCount() const
+{
+    return m_images.maxCost();
+}
+
+void X11CursorImageCache::setMaxCount(int count)
+{
+    m_images.setMaxCost(std::max(count, 1));
+}
+
+int X11CursorImageCache::count() const
+{
+    return m_images.count();
+}
+
+bool X11CursorImageCache::isFetchPending() const
+{
+    return m_query.isPending();
+}
+
+quint64 X11CursorImageCache::fetchCount() const
+{
+    return m_query.requestCount();
+}
+
+void X11CursorImageCache::notifyCursorChanged(uint32_t serial)
+{
+    m_currentSerial = serial;
+    if (m_images.contains(serial)) {
+        Q_EMIT imageChanged();
+    } else {
+        // If a query is in flight, its reply may describe the previous cursor.
+        m_query.request();
+    }
+}
+
+void X11CursorImageCache::handleReply(xcb_xfixes_get_cursor_image_reply_t *reply, bool outdated)
+{
+    if (!reply) {
+        return;
+    }
+
+    const uint32_t serial = reply->cursor_serial;
+    const QImage image(reinterpret_cast<const uchar *>(xcb_xfixes_get_cursor_image_cursor_image(reply)), reply->width, reply->height,
+                       QImage::Format_ARGB32_Premultiplied);
+    // deep copy of image as the data is going to be freed
+    m_images.insert(serial, new PlatformCursorImage(image.copy(), QPoint(reply->xhot, reply->yhot)));
+    free(reply);
+
+    if (outdated && serial != m_currentSerial) {
+        // The cursor has changed after the query has been sent.
+        if (!m_images.contains(*m_currentSerial)) {
+            m_query.request();
+        }
+        return;
+    }
+
+    // The reply is at least as recent as the last notification, the notification about this
+    // cursor may still be on its way.
+    m_currentSerial = serial;
+    Q_EMIT imageChanged();
+}
+
+} // namespace KWin
+
+#include "moc_x11_standalone_cursorimagecache.cpp"
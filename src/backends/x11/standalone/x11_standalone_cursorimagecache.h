@@ -0,0 +1,88 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "effect/globals.h"
+#include "x11_standalone_asyncrequest.h"
+
+#include <QCache>
+#include <QObject>
+
+#include <optional>
+
+#include <xcb/xfixes.h>
+
+namespace KWin
+{
+
+/**
+ * The X11CursorImageCache class keeps the images of the recently displayed cursors, keyed by
+ * the cursor serial that XFixes assigns to every cursor.
+ *
+ * When the cursor changes, the image of the new cursor is fetched without blocking unless it
+ * is already in the cache, so switching back and forth between a few cursors doesn't transfer
+ * the same images again. The images are implicitly shared with the callers of image().
+ */
+class X11CursorImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxCount = 32;
+
+    X11CursorImageCache(xcb_connection_t *connection, QObject *parent = nullptr);
+    ~X11CursorImageCache() override;
+
+    /**
+     * Returns the image of the current cursor. This blocks only if the image of the current
+     * cursor hasn't been received yet.
+     */
+    PlatformCursorImage image();
+
+    /**
+     * Returns the serial of the current cursor, if it's known.
+     */
+    std::optional<uint32_t> currentSerial() const;
+
+    int maxCount() const;
+    void setMaxCount(int count);
+    /**
+     * Returns the number of cached images.
+     */
+    int count() const;
+    /**
+     * Returns @c true if an image is being fetched.
+     */
+    bool isFetchPending() const;
+    /**
+     * Returns the number of images fetched from the X server so far.
+     */
+    quint64 fetchCount() const;
+
+    /**
+     * Notifies the cache that the cursor with the given @a serial is displayed now, as reported
+     * by an XFixesCursorNotify event. This never blocks.
+     */
+    void notifyCursorChanged(uint32_t serial);
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when the image of the current cursor is available.
+     */
+    void imageChanged();
+
+private:
+    void handleReply(xcb_xfixes_get_cursor_image_reply_t *reply, bool outdated);
+
+    QCache<uint32_t, PlatformCursorImage> m_images;
+    std::optional<uint32_t> m_currentSerial;
+    X11AsyncRequest m_query;
+};
+
+} // namespace KWin
@@ -6,10 +6,12 @@
 */
 
 #include "x11_standalone_egl_backend.h"
-#include "compositor.h"
+#include "compositor_x11.h"
 #include "core/outputbackend.h"
 #include "core/outputlayer.h"
 #include "core/overlaywindow.h"
+#include "core/renderloop.h"
+#include "frametracer.h"
 #include "opengl/eglcontext.h"
 #include "opengl/egldisplay.h"
 #include "opengl/glplatform.h"
@@ -19,9 +21,11 @@
 #include "utils/c_ptr.h"
 #include "utils/softwarevsyncmonitor.h"
 #include "workspace.h"
+#include "x11syncmanager.h"
 #include "x11_standalone_backend.h"
 #include "x11_standalone_logging.h"
 #include "x11_standalone_overlaywindow.h"
+#include "x11_standalone_presentvsyncmonitor.h"
 
 #include <QOpenGLContext>
 #include <drm_fourcc.h>
@@ -29,6 +33,17 @@
 namespace KWin
 {
 
+PresentEventFilter::PresentEventFilter(PresentVsyncMonitor *monitor)
+    : X11EventFilter(XCB_GE_GENERIC, monitor->majorOpcode(), XCB_PRESENT_COMPLETE_NOTIFY)
+    , m_monitor(monitor)
+{
+}
+
+bool PresentEventFilter::event(xcb_generic_event_t *event)
+{
+    return m_monitor->handleEvent(event);
+}
+
 EglLayer::EglLayer(EglBackend *backend)
     : OutputLayer(nullptr)
     , m_backend(backend)
@@ -61,16 +76,6 @@ EglBackend::EglBackend(::Display *display, X11StandaloneBackend *backend)
     , m_overlayWindow(std::make_unique<OverlayWindowX11>(backend))
     , m_layer(std::make_unique<EglLayer>(this))
 {
-    // There is no any way to determine when a buffer swap completes with EGL. Fallback
-    // to software vblank events. Could we use the Present extension to get notified when
-    // the overlay window is actually presented on the screen?
-    m_vsyncMonitor = SoftwareVsyncMonitor::create();
-    connect(backend->renderLoop(), &RenderLoop::refreshRateChanged, this, [this, backend]() {
-        m_vsyncMonitor->setRefreshRate(backend->renderLoop()->refreshRate());
-    });
-    m_vsyncMonitor->setRefreshRate(backend->renderLoop()->refreshRate());
-
-    connect(m_vsyncMonitor.get(), &VsyncMonitor::vblankOccurred, this, &EglBackend::vblank);
     Q_ASSERT(workspace());
     connect(workspace(), &Workspace::geometryChanged, this, &EglBackend::screenGeometryChanged);
     overlayWindow()->resize(workspace()->geometry().size());
@@ -79,6 +84,8 @@ EglBackend::EglBackend(::Display *display, X11StandaloneBackend *backend)
 EglBackend::~EglBackend()
 {
     m_query.reset();
+    m_presentEventFilter.reset();
+    m_vsyncMonitor.reset();
 
     if (isFailed() && m_overlayWindow) {
         m_overlayWindow->destroy();
@@ -161,6 +168,8 @@ void EglBackend::init()
         if (val >= 1) {
             if (eglSwapInterval(eglDisplayObject()->handle(), 1)) {
                 qCDebug(KWIN_CORE) << "Enabled v-sync";
+                eglGetConfigAttrib(eglDisplayObject()->handle(), m_context->config(), EGL_MIN_SWAP_INTERVAL, &val);
+                m_canTear = val == 0;
             }
         } else {
             qCWarning(KWIN_CORE) << "Cannot enable v-sync as max. swap interval is" << val;
@@ -175,6 +184,8 @@ void EglBackend::init()
         eglSurfaceAttrib(eglDisplayObject()->handle(), m_surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED);
     }
 
+    initVsyncMonitor();
+
     m_swapStrategy = options->glPreferBufferSwap();
     if (m_swapStrategy == Options::AutoSwapStrategy) {
         // buffer copying is very fast with the nvidia blob
@@ -188,6 +199,32 @@ void EglBackend::init()
     }
 }
 
+void EglBackend::initVsyncMonitor()
+{
+    // There is no any way to determine when a buffer swap completes with EGL itself, but
+    // the Present extension can tell when the overlay window has been updated on the screen.
+    static bool forceSoftwareVsync = qEnvironmentVariableIntValue("KWIN_X11_FORCE_SOFTWARE_VSYNC");
+    if (!forceSoftwareVsync) {
+        if (auto monitor = PresentVsyncMonitor::create(m_backend->connection(), m_overlayWindow->window())) {
+            m_presentEventFilter = std::make_unique<PresentEventFilter>(monitor.get());
+            m_vsyncMonitor = std::move(monitor);
+        }
+    }
+
+    // Fallback to software vblank events.
+    if (!m_vsyncMonitor) {
+        std::unique_ptr<SoftwareVsyncMonitor> monitor = SoftwareVsyncMonitor::create();
+        RenderLoop *renderLoop = m_backend->renderLoop();
+        monitor->setRefreshRate(renderLoop->refreshRate());
+        connect(renderLoop, &RenderLoop::refreshRateChanged, this, [this, m = monitor.get()]() {
+            m->setRefreshRate(m_backend->renderLoop()->refreshRate());
+        });
+        m_vsyncMonitor = std::move(monitor);
+    }
+
+    connect(m_vsyncMonitor.get(), &VsyncMonitor::vblankOccurred, this, &EglBackend::vblank);
+}
+
 void EglBackend::initClientExtensions()
 {
     // Get the list of client extensions
@@ -359,7 +396,18 @@ OutputLayerBeginFrameInfo EglBackend::beginFrame()
     if (supportsBufferAge()) {
         repaint = m_damageJournal.accumulate(m_bufferAge, infiniteRegion());
     }
-    eglWaitNative(EGL_CORE_NATIVE_ENGINE);
+    // The X server may still be rendering to the window pixmaps that will be sampled in this
+    // frame. If it signals a fence once done, the GPU waits for the fence before sampling them.
+    m_xWaitTime.reset();
+    if (X11Compositor *compositor = X11Compositor::self(); compositor->arePixmapsDirty()) {
+        X11SyncManager *syncManager = compositor->syncManager();
+        if (!syncManager || !syncManager->isFenceTriggered()) {
+            frameTraceScope("Wait for X");
+            const auto start = std::chrono::steady_clock::now();
+            eglWaitNative(EGL_CORE_NATIVE_ENGINE);
+            m_xWaitTime = std::chrono::steady_clock::now() - start;
+        }
+    }
 
     m_query = std::make_unique<GLRenderTimeQuery>(m_context);
     m_query->begin();
@@ -373,6 +421,9 @@ void EglBackend::endFrame(const QRegion &renderedRegion, const QRegion &damagedR
 {
     m_query->end();
     frame->addRenderTimeQuery(std::move(m_query));
+    if (m_xWaitTime) {
+        frame->addSyncWaitTime(*m_xWaitTime);
+    }
     // Save the damaged region to history
     if (supportsBufferAge()) {
         m_damageJournal.add(damagedRegion);
@@ -383,9 +434,6 @@ void EglBackend::endFrame(const QRegion &renderedRegion, const QRegion &damagedR
 bool EglBackend::present(Output *output, const std::shared_ptr<OutputFrame> &frame)
 {
     m_frame = frame;
-    // Start the software vsync monitor. There is no any reliable way to determine when
-    // eglSwapBuffers() or eglSwapBuffersWithDamageEXT() completes.
-    m_vsyncMonitor->arm();
 
     QRegion effectiveRenderedRegion = m_lastRenderedRegion;
     if (!m_context->isOpenGLES()) {
@@ -398,8 +446,13 @@ bool EglBackend::present(Output *output, const std::shared_ptr<OutputFrame> &fra
         }
     }
 
+    setPresentationMode(frame->presentationMode());
     presentSurface(m_surface, effectiveRenderedRegion, workspace()->geometry());
 
+    // Arm the vsync monitor after swapping buffers so the reported vblank is not the one
+    // before the swap.
+    m_vsyncMonitor->arm();
+
     if (overlayWindow() && overlayWindow()->window()) { // show the window only after the first pass,
         overlayWindow()->show(); // since that pass may take long
     }
@@ -408,6 +461,7 @@ bool EglBackend::present(Output *output, const std::shared_ptr<OutputFrame> &fra
 
 void EglBackend::presentSurface(EGLSurface surface, const QRegion &damage, const QRect &screenGeometry)
 {
+    frameTraceScope("Swap");
     const bool fullRepaint = supportsBufferAge() || (damage == screenGeometry);
 
     if (fullRepaint || !m_havePostSubBuffer) {
@@ -424,6 +478,26 @@ void EglBackend::presentSurface(EGLSurface surface, const QRegion &damage, const
     }
 }
 
+void EglBackend::setPresentationMode(PresentationMode mode)
+{
+    if (!m_canTear) {
+        mode = (mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync) ? PresentationMode::AdaptiveSync : PresentationMode::VSync;
+    }
+    if (m_presentationMode == mode) {
+        return;
+    }
+
+    const bool tearing = mode == PresentationMode::Async || mode == PresentationMode::AdaptiveAsync;
+    const bool wasTearing = m_presentationMode == PresentationMode::Async || m_presentationMode == PresentationMode::AdaptiveAsync;
+    if (tearing != wasTearing) {
+        eglSwapInterval(eglDisplayObject()->handle(), tearing ? 0 : 1);
+    }
+    m_overlayWindow->setVariableRefresh(mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync);
+
+    m_presentationMode = mode;
+    m_backend->renderLoop()->setPresentationMode(mode);
+}
+
 OverlayWindow *EglBackend::overlayWindow() const
 {
     return m_overlayWindow.get();
@@ -436,7 +510,11 @@ OutputLayer *EglBackend::primaryLayer(Output *output)
 
 void EglBackend::vblank(std::chrono::nanoseconds timestamp)
 {
-    m_frame->presented(timestamp, PresentationMode::VSync);
+    if (!m_frame) {
+        return;
+    }
+    frameTraceInstant("Vblank");
+    m_frame->presented(timestamp, m_presentationMode);
     m_frame.reset();
 }
 
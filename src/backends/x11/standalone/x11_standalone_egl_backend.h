@@ -11,6 +11,7 @@
 #include "platformsupport/scenes/opengl/openglbackend.h"
 #include "platformsupport/scenes/opengl/openglsurfacetexture_x11.h"
 #include "utils/damagejournal.h"
+#include "x11eventfilter.h"
 
 #include "opengl/gltexture.h"
 #include "opengl/gltexture_p.h"
@@ -23,12 +24,25 @@ namespace KWin
 {
 
 class EglPixmapTexturePrivate;
-class SoftwareVsyncMonitor;
+class PresentVsyncMonitor;
+class VsyncMonitor;
 class X11StandaloneBackend;
 class EglBackend;
 class GLRenderTimeQuery;
 class EglDisplay;
 class EglContext;
+class OverlayWindowX11;
+
+class PresentEventFilter : public X11EventFilter
+{
+public:
+    explicit PresentEventFilter(PresentVsyncMonitor *monitor);
+
+    bool event(xcb_generic_event_t *event) override;
+
+private:
+    PresentVsyncMonitor *m_monitor;
+};
 
 class EglLayer : public OutputLayer
 {
@@ -71,12 +85,15 @@ private:
     bool hasClientExtension(const QByteArray &name);
     void screenGeometryChanged();
     void presentSurface(::EGLSurface surface, const QRegion &damage, const QRect &screenGeometry);
+    void setPresentationMode(PresentationMode mode);
     void vblank(std::chrono::nanoseconds timestamp);
+    void initVsyncMonitor();
     ::EGLSurface createSurface(xcb_window_t window);
 
     X11StandaloneBackend *m_backend;
-    std::unique_ptr<SoftwareVsyncMonitor> m_vsyncMonitor;
-    std::unique_ptr<OverlayWindow> m_overlayWindow;
+    std::unique_ptr<VsyncMonitor> m_vsyncMonitor;
+    std::unique_ptr<PresentEventFilter> m_presentEventFilter;
+    std::unique_ptr<OverlayWindowX11> m_overlayWindow;
     DamageJournal m_damageJournal;
     std::unique_ptr<GLFramebuffer> m_fbo;
     int m_bufferAge = 0;
@@ -84,6 +101,8 @@ private:
     std::unique_ptr<EglLayer> m_layer;
     std::unique_ptr<GLRenderTimeQuery> m_query;
     int m_havePostSubBuffer = false;
+    bool m_canTear = false;
+    PresentationMode m_presentationMode = PresentationMode::VSync;
     bool m_havePlatformBase = false;
     Options::GlSwapStrategy m_swapStrategy = Options::AutoSwapStrategy;
     std::shared_ptr<OutputFrame> m_frame;
@@ -91,6 +110,7 @@ private:
     QList<QByteArray> m_clientExtensions;
     std::shared_ptr<EglContext> m_context;
     ::EGLSurface m_surface = EGL_NO_SURFACE;
+    std::optional<std::chrono::nanoseconds> m_xWaitTime;
 };
 
 class EglPixmapTexture : public GLTexture
@@ -24,14 +24,17 @@
 #include "x11_standalone_overlaywindow.h"
 #include "x11_standalone_sgivideosyncvsyncmonitor.h"
 // kwin
-#include "compositor.h"
+#include "compositor_x11.h"
 #include "core/outputbackend.h"
 #include "core/overlaywindow.h"
+#include "core/renderloop.h"
+#include "frametracer.h"
 #include "opengl/glrendertimequery.h"
 #include "options.h"
 #include "scene/surfaceitem_x11.h"
 #include "utils/xcbutils.h"
 #include "workspace.h"
+#include "x11syncmanager.h"
 // kwin libs
 #include "effect/offscreenquickview.h"
 #include "opengl/glplatform.h"
@@ -254,6 +257,7 @@ void GlxBackend::init()
     if (!syncToVblankDisabled) {
         if (haveSwapInterval) {
             setSwapInterval(1);
+            m_canTear = true;
         } else {
             qCWarning(KWIN_X11STANDALONE) << "glSwapInterval is unsupported";
         }
@@ -606,8 +610,29 @@ void GlxBackend::setSwapInterval(int interval)
     }
 }
 
+void GlxBackend::setPresentationMode(PresentationMode mode)
+{
+    if (!m_canTear) {
+        mode = (mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync) ? PresentationMode::AdaptiveSync : PresentationMode::VSync;
+    }
+    if (m_presentationMode == mode) {
+        return;
+    }
+
+    const bool tearing = mode == PresentationMode::Async || mode == PresentationMode::AdaptiveAsync;
+    const bool wasTearing = m_presentationMode == PresentationMode::Async || m_presentationMode == PresentationMode::AdaptiveAsync;
+    if (tearing != wasTearing) {
+        setSwapInterval(tearing ? 0 : 1);
+    }
+    m_overlayWindow->setVariableRefresh(mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync);
+
+    m_presentationMode = mode;
+    m_backend->renderLoop()->setPresentationMode(mode);
+}
+
 void GlxBackend::present(const QRegion &damage)
 {
+    frameTraceScope("Swap");
     const QSize &screenSize = workspace()->geometry().size();
     const QRegion displayRegion(0, 0, screenSize.width(), screenSize.height());
     const bool fullRepaint = supportsBufferAge() || (damage == displayRegion);
@@ -663,7 +688,18 @@ OutputLayerBeginFrameInfo GlxBackend::doBeginFrame()
         repaint = m_damageJournal.accumulate(m_bufferAge, infiniteRegion());
     }
 
-    glXWaitX();
+    // The X server may still be rendering to the window pixmaps that will be sampled in this
+    // frame. If it signals a fence once done, the GPU waits for the fence before sampling them.
+    m_xWaitTime.reset();
+    if (X11Compositor *compositor = X11Compositor::self(); compositor->arePixmapsDirty()) {
+        X11SyncManager *syncManager = compositor->syncManager();
+        if (!syncManager || !syncManager->isFenceTriggered()) {
+            frameTraceScope("Wait for X");
+            const auto start = std::chrono::steady_clock::now();
+            glXWaitX();
+            m_xWaitTime = std::chrono::steady_clock::now() - start;
+        }
+    }
 
     m_query = std::make_unique<GLRenderTimeQuery>(m_context);
     m_query->begin();
@@ -677,6 +713,9 @@ void GlxBackend::endFrame(const QRegion &renderedRegion, const QRegion &damagedR
 {
     m_query->end();
     frame->addRenderTimeQuery(std::move(m_query));
+    if (m_xWaitTime) {
+        frame->addSyncWaitTime(*m_xWaitTime);
+    }
     // Save the damaged region to history
     if (supportsBufferAge()) {
         m_damageJournal.add(damagedRegion);
@@ -703,6 +742,7 @@ bool GlxBackend::present(Output *output, const std::shared_ptr<OutputFrame> &fra
         effectiveRenderedRegion = displayRect;
     }
 
+    setPresentationMode(frame->presentationMode());
     present(effectiveRenderedRegion);
 
     if (overlayWindow()->window()) { // show the window only after the first pass,
@@ -713,8 +753,9 @@ bool GlxBackend::present(Output *output, const std::shared_ptr<OutputFrame> &fra
 
 void GlxBackend::vblank(std::chrono::nanoseconds timestamp)
 {
+    frameTraceInstant("Vblank");
     if (m_frame) {
-        m_frame->presented(timestamp, PresentationMode::VSync);
+        m_frame->presented(timestamp, m_presentationMode);
         m_frame.reset();
     }
 }
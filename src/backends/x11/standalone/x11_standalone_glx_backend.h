@@ -33,6 +33,7 @@ class X11StandaloneBackend;
 class GlxBackend;
 class GLRenderTimeQuery;
 class GlxContext;
+class OverlayWindowX11;
 
 class FBConfigInfo
 {
@@ -108,6 +109,7 @@ private:
     bool initFbConfig();
     void initVisualDepthHashTable();
     void setSwapInterval(int interval);
+    void setPresentationMode(PresentationMode mode);
     void screenGeometryChanged();
 
     int visualDepth(xcb_visualid_t visual) const;
@@ -116,7 +118,7 @@ private:
     /**
      * @brief The OverlayWindow used by this Backend.
      */
-    std::unique_ptr<OverlayWindow> m_overlayWindow;
+    std::unique_ptr<OverlayWindowX11> m_overlayWindow;
     ::Window window;
     GLXFBConfig fbconfig;
     GLXWindow glxWindow;
@@ -133,6 +135,8 @@ private:
     bool m_haveMESASwapControl = false;
     bool m_haveEXTSwapControl = false;
     bool m_haveSGISwapControl = false;
+    bool m_canTear = false;
+    PresentationMode m_presentationMode = PresentationMode::VSync;
     ::Display *m_x11Display;
     X11StandaloneBackend *m_backend;
     std::unique_ptr<VsyncMonitor> m_vsyncMonitor;
@@ -140,6 +144,7 @@ private:
     std::unique_ptr<GLRenderTimeQuery> m_query;
     Options::GlSwapStrategy m_swapStrategy = Options::AutoSwapStrategy;
     std::shared_ptr<OutputFrame> m_frame;
+    std::optional<std::chrono::nanoseconds> m_xWaitTime;
     friend class GlxPixmapTexture;
 };
 
@@ -0,0 +1,180 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "x11_standalone_imageuploader.h"
+#include "frametracer.h"
+#include "utils/xcbutils.h"
+#include "x11_standalone_logging.h"
+
+#include <xcb/shm.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace KWin
+{
+
+X11ImageUploader::X11ImageUploader(xcb_connection_t *connection, xcb_drawable_t drawable, uint8_t depth, bool useShm)
+    : m_connection(connection)
+    , m_drawable(drawable)
+    , m_gc(xcb_generate_id(connection))
+    , m_depth(depth)
+    , m_shmEnabled(useShm)
+{
+    const uint32_t values[] = {0};
+    xcb_create_gc(m_connection, m_gc, m_drawable, XCB_GC_GRAPHICS_EXPOSURES, values);
+
+    // A lost completion event would keep the image pending, and the compositor waiting for
+    // it, forever.
+    m_watchdog.setSingleShot(true);
+    m_watchdog.setInterval(std::chrono::seconds(1));
+    connect(&m_watchdog, &QTimer::timeout, this, &X11ImageUploader::handleTimeout);
+}
+
+X11ImageUploader::~X11ImageUploader()
+{
+    xcb_free_gc(m_connection, m_gc);
+}
+
+QImage *X11ImageUploader::image()
+{
+    return &m_image;
+}
+
+void X11ImageUploader::resize(const QSize &size)
+{
+    const QImage::Format format = m_depth == 32 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+
+    // The X server keeps its own mapping of the old segment until it has processed the
+    // requests that use it, so it can be released right away.
+    m_shm.reset();
+    if (m_shmEnabled) {
+        auto shm = std::make_unique<Xcb::Shm>(size_t(size.width()) * size.height() * 4);
+        if (shm->isValid()) {
+            m_shm = std::move(shm);
+        } else {
+            qCDebug(KWIN_X11STANDALONE) << "Failed to share the image with the X server, falling back to PutImage";
+        }
+    }
+
+    if (m_shm) {
+        m_image = QImage(static_cast<uchar *>(m_shm->buffer()), size.width(), size.height(), size.width() * 4, format);
+    } else {
+        m_image = QImage(size, format);
+    }
+}
+
+bool X11ImageUploader::isShmEnabled() const
+{
+    return m_shm != nullptr;
+}
+
+bool X11ImageUploader::isPending() const
+{
+    return !m_pendingRects.isEmpty();
+}
+
+void X11ImageUploader::upload(const QList<QRect> &rects)
+{
+    if (rects.isEmpty()) {
+        Q_EMIT uploaded();
+    } else if (m_shm) {
+        m_pendingRects = rects;
+        putImageShm(rects);
+        m_watchdog.start();
+    } else {
+        putImage(rects);
+        Q_EMIT uploaded();
+    }
+}
+
+void X11ImageUploader::putImageShm(const QList<QRect> &rects)
+{
+    frameTraceScope("ShmPutImage");
+    for (int i = 0; i < rects.size(); ++i) {
+        const QRect &rect = rects[i];
+        // The requests are processed in order, one completion event for the last one suffices.
+        const bool sendEvent = i == rects.size() - 1;
+        xcb_shm_put_image(m_connection, m_drawable, m_gc,
+                          m_image.width(), m_image.height(),
+                          rect.x(), rect.y(), rect.width(), rect.height(),
+                          rect.x(), rect.y(), m_depth, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                          sendEvent, m_shm->segment(), 0);
+    }
+    xcb_flush(m_connection);
+}
+
+void X11ImageUploader::putImage(const QList<QRect> &rects)
+{
+    frameTraceScope("PutImage");
+
+    // Split the rectangles in bands that fit in a request, leave some room for the header.
+    const size_t maxDataSize = size_t(xcb_get_maximum_request_length(m_connection)) * 4 - 64;
+
+    QByteArray data;
+    for (const QRect &rect : rects) {
+        const int bytesPerLine = rect.width() * 4;
+        const int linesPerRequest = std::clamp(int(maxDataSize / bytesPerLine), 1, rect.height());
+        data.resize(bytesPerLine * linesPerRequest);
+
+        for (int y = rect.y(); y <= rect.bottom(); y += linesPerRequest) {
+            const int lines = std::min(linesPerRequest, rect.bottom() + 1 - y);
+            for (int line = 0; line < lines; ++line) {
+                std::memcpy(data.data() + line * bytesPerLine, m_image.constScanLine(y + line) + rect.x() * 4, bytesPerLine);
+            }
+            xcb_put_image(m_connection, XCB_IMAGE_FORMAT_Z_PIXMAP, m_drawable, m_gc,
+                          rect.width(), lines, rect.x(), y, 0, m_depth,
+                          bytesPerLine * lines, reinterpret_cast<const uint8_t *>(data.constData()));
+        }
+    }
+    xcb_flush(m_connection);
+}
+
+bool X11ImageUploader::handleEvent(xcb_generic_event_t *event)
+{
+    const auto completionEvent = reinterpret_cast<xcb_shm_completion_event_t *>(event);
+    if (completionEvent->drawable != m_drawable) {
+        return false;
+    }
+    // A completion that arrives after the watchdog has fired has been dealt with already.
+    if (m_pendingRects.isEmpty()) {
+        return true;
+    }
+    m_watchdog.stop();
+    m_pendingRects.clear();
+    Q_EMIT uploaded();
+    return true;
+}
+
+void X11ImageUploader::handleTimeout()
+{
+    qCWarning(KWIN_X11STANDALONE) << "No ShmCompletion event received for drawable" << m_drawable << "falling back to PutImage";
+
+    // Move the image out of the shared memory segment, its contents are preserved. Whether the
+    // X server has read the segment is unknown, so upload the pending rectangles once more.
+    m_shmEnabled = false;
+    m_image = m_image.copy();
+    m_shm.reset();
+
+    QList<QRect> rects;
+    for (const QRect &rect : std::as_const(m_pendingRects)) {
+        const QRect clipped = rect & m_image.rect();
+        if (!clipped.isEmpty()) {
+            rects.append(clipped);
+        }
+    }
+    m_pendingRects.clear();
+
+    putImage(rects);
+    Q_EMIT uploaded();
+}
+
+} // namespace KWin
+
+#include "moc_x11_standalone_imageuploader.cpp"
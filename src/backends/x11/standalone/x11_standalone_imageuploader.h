@@ -0,0 +1,107 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QTimer>
+
+#include <memory>
+
+#include <xcb/xcb.h>
+
+namespace KWin
+{
+
+namespace Xcb
+{
+class Shm;
+}
+
+/**
+ * The X11ImageUploader class copies parts of an image in client memory to a drawable.
+ *
+ * If MIT-SHM is usable, the image lives in a shared memory segment and is uploaded with
+ * ShmPutImage. The X server reads the segment after the request has been sent, so the image
+ * must not be painted on until uploaded() has been emitted. Otherwise, the image is uploaded
+ * with PutImage, which carries a copy of the pixels, and uploaded() is emitted right away.
+ *
+ * If the completion event of an ShmPutImage request doesn't arrive, the uploader stops using
+ * shared memory and uploads the image with PutImage from then on.
+ *
+ * The uploader doesn't read X events on its own, ShmCompletion events have to be passed to
+ * handleEvent().
+ */
+class X11ImageUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates an uploader for @a drawable, which has the given @a depth. Shared memory is
+     * only used if @a useShm is @c true.
+     */
+    X11ImageUploader(xcb_connection_t *connection, xcb_drawable_t drawable, uint8_t depth, bool useShm);
+    ~X11ImageUploader() override;
+
+    /**
+     * Returns the image that is uploaded. It's valid until the next resize().
+     */
+    QImage *image();
+    /**
+     * Recreates the image with the given @a size. Its contents are undefined.
+     */
+    void resize(const QSize &size);
+
+    /**
+     * Returns @c true if the image is uploaded with ShmPutImage.
+     */
+    bool isShmEnabled() const;
+    /**
+     * Returns @c true if the X server may still be reading the image.
+     */
+    bool isPending() const;
+
+    /**
+     * Uploads @a rects of the image to the same position in the drawable.
+     */
+    void upload(const QList<QRect> &rects);
+
+    /**
+     * Processes the given ShmCompletion @a event. Returns @c true if the event belongs to
+     * this uploader.
+     */
+    bool handleEvent(xcb_generic_event_t *event);
+
+Q_SIGNALS:
+    /**
+     * Emitted when the X server has finished reading the image.
+     */
+    void uploaded();
+
+private:
+    void putImageShm(const QList<QRect> &rects);
+    void putImage(const QList<QRect> &rects);
+    void handleTimeout();
+
+    xcb_connection_t *m_connection;
+    xcb_drawable_t m_drawable;
+    xcb_gcontext_t m_gc;
+    uint8_t m_depth;
+    bool m_shmEnabled;
+    std::unique_ptr<Xcb::Shm> m_shm;
+    QImage m_image;
+    QList<QRect> m_pendingRects;
+    QTimer m_watchdog;
+};
+
+} // namespace KWin
@@ -9,6 +9,7 @@
 
 #include "x11_standalone_overlaywindow.h"
 
+#include "atoms.h"
 #include "compositor.h"
 #include "core/renderloop.h"
 #include "scene/workspacescene.h"
@@ -75,6 +76,7 @@ void OverlayWindowX11::setup(xcb_window_t window)
         setNoneBackgroundPixmap(window);
         setupInputShape(window);
     }
+    m_destination = window;
     const uint32_t eventMask = XCB_EVENT_MASK_VISIBILITY_CHANGE;
     xcb_change_window_attributes(connection(), m_window, XCB_CW_EVENT_MASK, &eventMask);
 }
@@ -137,6 +139,28 @@ void OverlayWindowX11::resize(const QSize &size)
     setShape(QRegion(0, 0, size.width(), size.height()));
 }
 
+void OverlayWindowX11::setVariableRefresh(bool enabled)
+{
+    if (m_variableRefresh == enabled || m_window == XCB_WINDOW_NONE) {
+        return;
+    }
+    m_variableRefresh = enabled;
+
+    // The property has to be set on the window that is presented, which is either the
+    // overlay window itself or the destination window inside it.
+    for (xcb_window_t window : {m_window, m_destination}) {
+        if (window == XCB_WINDOW_NONE) {
+            continue;
+        }
+        if (enabled) {
+            const uint32_t value = 1;
+            xcb_change_property(connection(), XCB_PROP_MODE_REPLACE, window, atoms->variable_refresh, XCB_ATOM_CARDINAL, 32, 1, &value);
+        } else {
+            xcb_delete_property(connection(), window, atoms->variable_refresh);
+        }
+    }
+}
+
 bool OverlayWindowX11::isVisible() const
 {
     return m_visible;
@@ -160,6 +184,8 @@ void OverlayWindowX11::destroy()
     xcb_composite_release_overlay_window(connection(), m_window);
 #endif
     m_window = XCB_WINDOW_NONE;
+    m_destination = XCB_WINDOW_NONE;
+    m_variableRefresh = false;
     m_shown = false;
 }
 
@@ -35,6 +35,8 @@ public:
     xcb_window_t window() const override;
     bool isVisible() const override;
     void setVisibility(bool visible) override;
+    /// Asks the X server to drive the outputs at a variable refresh rate while the overlay is flipped
+    void setVariableRefresh(bool enabled);
 
     bool event(xcb_generic_event_t *event) override;
 
@@ -48,5 +50,7 @@ private:
     QSize m_size;
     QRegion m_shape;
     xcb_window_t m_window;
+    xcb_window_t m_destination = XCB_WINDOW_NONE;
+    bool m_variableRefresh = false;
 };
 } // namespace
@@ -0,0 +1,93 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "x11_standalone_pointertracker.h"
+
+#include <cstdlib>
+
+namespace KWin
+{
+
+X11PointerTracker::X11PointerTracker(xcb_connection_t *connection, xcb_window_t rootWindow, QObject *parent)
+    : QObject(parent)
+    , m_query(
+          connection,
+          [connection, rootWindow]() {
+              return xcb_query_pointer_unchecked(connection, rootWindow).sequence;
+          },
+          [this](void *reply, bool outdated) {
+              handleReply(static_cast<xcb_query_pointer_reply_t *>(reply), outdated);
+          })
+{
+}
+
+X11PointerTracker::~X11PointerTracker() = default;
+
+QPointF X11PointerTracker::position() const
+{
+    return m_position;
+}
+
+uint16_t X11PointerTracker::mask() const
+{
+    return m_mask;
+}
+
+bool X11PointerTracker::isValid() const
+{
+    return m_valid;
+}
+
+bool X11PointerTracker::isQueryPending() const
+{
+    return m_query.isPending();
+}
+
+quint64 X11PointerTracker::queryCount() const
+{
+    return m_query.requestCount();
+}
+
+void X11PointerTracker::invalidate()
+{
+    m_query.request();
+}
+
+void X11PointerTracker::update()
+{
+    if (!m_query.isPending() && !m_valid) {
+        m_query.request();
+    }
+    m_query.waitForReply();
+}
+
+void X11PointerTracker::handleReply(xcb_query_pointer_reply_t *reply, bool outdated)
+{
+    bool isChanged = false;
+    if (reply) {
+        const QPointF position(reply->root_x, reply->root_y);
+        isChanged = !m_valid || position != m_position || reply->mask != m_mask;
+        m_position = position;
+        m_mask = reply->mask;
+        m_valid = true;
+        free(reply);
+    }
+
+    if (outdated) {
+        // The reply may predate the event, so query again.
+        m_query.request();
+    }
+
+    if (isChanged) {
+        Q_EMIT changed();
+    }
+}
+
+} // namespace KWin
+
+#include "moc_x11_standalone_pointertracker.cpp"
@@ -0,0 +1,80 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "x11_standalone_asyncrequest.h"
+
+#include <QObject>
+#include <QPointF>
+
+#include <xcb/xcb.h>
+
+namespace KWin
+{
+
+/**
+ * The X11PointerTracker class keeps track of the position of the pointer and the state of
+ * the buttons and modifiers without blocking on the X server for every input event.
+ *
+ * Raw input events don't carry root coordinates, so the state still has to be queried, but at
+ * most one QueryPointer request is in flight and its reply is collected without blocking. If
+ * the pointer state is invalidated while a query is in flight, a single follow-up query is
+ * sent once the reply has arrived, so a burst of events results in at most two queries.
+ */
+class X11PointerTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    X11PointerTracker(xcb_connection_t *connection, xcb_window_t rootWindow, QObject *parent = nullptr);
+    ~X11PointerTracker() override;
+
+    QPointF position() const;
+    uint16_t mask() const;
+
+    /**
+     * Returns @c true if the pointer state has been queried at least once.
+     */
+    bool isValid() const;
+    /**
+     * Returns @c true if a query is waiting for its reply.
+     */
+    bool isQueryPending() const;
+    /**
+     * Returns the number of QueryPointer requests sent so far.
+     */
+    quint64 queryCount() const;
+
+    /**
+     * Notifies the tracker that the pointer state may have changed, e.g. because a raw input
+     * event has been received. This never blocks.
+     */
+    void invalidate();
+    /**
+     * Waits for the reply of the pending query, if any, so the state is as current as the
+     * input events handled so far. The state is queried if it has never been queried before.
+     */
+    void update();
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when a reply with a different position or mask has been received.
+     */
+    void changed();
+
+private:
+    void handleReply(xcb_query_pointer_reply_t *reply, bool outdated);
+
+    QPointF m_position;
+    uint16_t m_mask = 0;
+    bool m_valid = false;
+    X11AsyncRequest m_query;
+};
+
+} // namespace KWin
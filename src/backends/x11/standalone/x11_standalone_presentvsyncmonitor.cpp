@@ -0,0 +1,141 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "x11_standalone_presentvsyncmonitor.h"
+#include "utils/c_ptr.h"
+#include "x11_standalone_logging.h"
+
+namespace KWin
+{
+
+std::unique_ptr<PresentVsyncMonitor> PresentVsyncMonitor::create(xcb_connection_t *connection, xcb_window_t window)
+{
+    if (window == XCB_WINDOW_NONE) {
+        return nullptr;
+    }
+
+    const xcb_query_extension_reply_t *extension = xcb_get_extension_data(connection, &xcb_present_id);
+    if (!extension || !extension->present) {
+        return nullptr; // Present is unsupported.
+    }
+
+    UniqueCPtr<xcb_present_query_version_reply_t> version(xcb_present_query_version_reply(connection,
+                                                                                          xcb_present_query_version_unchecked(connection, XCB_PRESENT_MAJOR_VERSION, XCB_PRESENT_MINOR_VERSION),
+                                                                                          nullptr));
+    if (!version) {
+        qCDebug(KWIN_X11STANDALONE) << "Failed to query the version of the Present extension";
+        return nullptr;
+    }
+
+    return std::unique_ptr<PresentVsyncMonitor>{new PresentVsyncMonitor(connection, window, extension->major_opcode)};
+}
+
+PresentVsyncMonitor::PresentVsyncMonitor(xcb_connection_t *connection, xcb_window_t window, uint8_t majorOpcode)
+    : m_connection(connection)
+    , m_window(window)
+    , m_majorOpcode(majorOpcode)
+    , m_eventId(xcb_generate_id(connection))
+{
+    xcb_present_select_input(m_connection, m_eventId, m_window, XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY);
+    xcb_flush(m_connection);
+
+    // If the driver stops using PresentPixmap, e.g. because the swap strategy has changed,
+    // there are no completion events anymore. Don't wait for them forever.
+    m_watchdog.setSingleShot(true);
+    m_watchdog.setInterval(std::chrono::seconds(1));
+    connect(&m_watchdog, &QTimer::timeout, this, &PresentVsyncMonitor::handleTimeout);
+}
+
+PresentVsyncMonitor::~PresentVsyncMonitor()
+{
+    // Selecting no events destroys the event context. The window may be gone already, so
+    // ignore errors.
+    xcb_discard_reply(m_connection, xcb_present_select_input_checked(m_connection, m_eventId, m_window, 0).sequence);
+}
+
+uint8_t PresentVsyncMonitor::majorOpcode() const
+{
+    return m_majorOpcode;
+}
+
+uint64_t PresentVsyncMonitor::msc() const
+{
+    return m_msc;
+}
+
+bool PresentVsyncMonitor::isPresentedByDriver() const
+{
+    return m_presentedByDriver;
+}
+
+void PresentVsyncMonitor::arm()
+{
+    if (m_armed) {
+        return;
+    }
+    m_armed = true;
+
+    if (m_presentedByDriver) {
+        m_watchdog.start();
+    } else {
+        notifyMsc();
+    }
+}
+
+void PresentVsyncMonitor::notifyMsc()
+{
+    // With a divisor of 1, the notification is sent at the next vblank.
+    xcb_present_notify_msc(m_connection, m_window, ++m_serial, 0, 1, 0);
+    xcb_flush(m_connection);
+}
+
+void PresentVsyncMonitor::handleTimeout()
+{
+    qCWarning(KWIN_X11STANDALONE) << "No Present completion event received for window" << m_window << "falling back to PresentNotifyMSC";
+    m_presentedByDriver = false;
+    notifyMsc();
+}
+
+bool PresentVsyncMonitor::handleEvent(xcb_generic_event_t *event)
+{
+    const auto completeEvent = reinterpret_cast<xcb_present_complete_notify_event_t *>(event);
+    if (completeEvent->event != m_eventId) {
+        return false;
+    }
+
+    switch (completeEvent->kind) {
+    case XCB_PRESENT_COMPLETE_KIND_PIXMAP:
+        if (!m_presentedByDriver) {
+            qCDebug(KWIN_X11STANDALONE) << "Window" << m_window << "is presented with PresentPixmap, using its completion events";
+            m_presentedByDriver = true;
+        }
+        m_watchdog.stop();
+        break;
+    case XCB_PRESENT_COMPLETE_KIND_NOTIFY_MSC:
+        // Ignore notifications that have been superseded by the completion of a swap.
+        if (completeEvent->serial != m_serial || m_presentedByDriver) {
+            return true;
+        }
+        break;
+    default:
+        return true;
+    }
+
+    m_msc = completeEvent->msc;
+    if (m_armed) {
+        m_armed = false;
+        // The UST is in microseconds of CLOCK_MONOTONIC.
+        Q_EMIT vblankOccurred(std::chrono::microseconds(completeEvent->ust));
+    }
+    return true;
+}
+
+} // namespace KWin
+
+#include "moc_x11_standalone_presentvsyncmonitor.cpp"
@@ -0,0 +1,79 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "utils/vsyncmonitor.h"
+
+#include <QTimer>
+#include <memory>
+
+#include <xcb/present.h>
+
+namespace KWin
+{
+
+/**
+ * The PresentVsyncMonitor class monitors the presentation of a window using the X Present
+ * extension.
+ *
+ * If the driver presents the window contents with PresentPixmap, e.g. Mesa with DRI3, the
+ * completion of every swap is reported with the time when it hit the screen. Otherwise, a
+ * notification for the next vblank after the swap is requested with PresentNotifyMSC, which
+ * works with any driver, including the fake vblank clock of Xvfb.
+ *
+ * The monitor doesn't read X events on its own, they have to be passed to handleEvent().
+ */
+class PresentVsyncMonitor : public VsyncMonitor
+{
+    Q_OBJECT
+
+public:
+    static std::unique_ptr<PresentVsyncMonitor> create(xcb_connection_t *connection, xcb_window_t window);
+    ~PresentVsyncMonitor() override;
+
+    /**
+     * Returns the major opcode of the Present extension, which identifies its generic events.
+     */
+    uint8_t majorOpcode() const;
+    /**
+     * Returns the media stream counter of the last vblank that has been reported.
+     */
+    uint64_t msc() const;
+    /**
+     * Returns @c true if the driver has been seen presenting the window with PresentPixmap.
+     */
+    bool isPresentedByDriver() const;
+
+    /**
+     * Processes the given PresentCompleteNotify @a event. Returns @c true if the event belongs
+     * to this monitor.
+     */
+    bool handleEvent(xcb_generic_event_t *event);
+
+public Q_SLOTS:
+    void arm() override;
+
+private:
+    PresentVsyncMonitor(xcb_connection_t *connection, xcb_window_t window, uint8_t majorOpcode);
+    void notifyMsc();
+    void handleTimeout();
+
+    xcb_connection_t *m_connection;
+    xcb_window_t m_window;
+    uint8_t m_majorOpcode;
+    uint32_t m_eventId;
+    uint32_t m_serial = 0;
+    uint64_t m_msc = 0;
+    bool m_armed = false;
+    bool m_presentedByDriver = false;
+    QTimer m_watchdog;
+};
+
+} // namespace KWin
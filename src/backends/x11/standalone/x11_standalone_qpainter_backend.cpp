@@ -0,0 +1,371 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "x11_standalone_qpainter_backend.h"
+#include "core/renderloop.h"
+#include "frametracer.h"
+#include "scene/surfaceitem_x11.h"
+#include "utils/c_ptr.h"
+#include "utils/softwarevsyncmonitor.h"
+#include "utils/xcbutils.h"
+#include "workspace.h"
+#include "x11_standalone_backend.h"
+#include "x11_standalone_imageuploader.h"
+#include "x11_standalone_logging.h"
+#include "x11_standalone_overlaywindow.h"
+
+#include <QSysInfo>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <cstring>
+
+namespace KWin
+{
+
+/**
+ * The number of rectangles above which a region is transferred as its bounding rectangle.
+ * Every rectangle costs a request, a few larger transfers are cheaper than many small ones.
+ */
+static const int s_maxTransferRects = 32;
+
+/**
+ * The minimum size of the shared memory segment used to fetch window contents.
+ */
+static const size_t s_minFetchSegmentSize = 4 * 1024 * 1024;
+
+static QList<QRect> transferRects(const QRegion &region, const QRect &bounds)
+{
+    const QRegion clipped = region & bounds;
+    if (clipped.rectCount() > s_maxTransferRects) {
+        return {clipped.boundingRect()};
+    }
+    return QList<QRect>(clipped.begin(), clipped.end());
+}
+
+/**
+ * Copies the pixels in @a source, which has the given @a stride, to @a rect in @a image. The
+ * padding byte of opaque pixels is undefined, so it's set to make the image valid RGB32.
+ */
+static void copyToImage(const uchar *source, int stride, const QRect &rect, QImage *image)
+{
+    const bool opaque = !image->hasAlphaChannel();
+    for (int y = 0; y < rect.height(); ++y) {
+        const uint32_t *src = reinterpret_cast<const uint32_t *>(source + y * stride);
+        uint32_t *dst = reinterpret_cast<uint32_t *>(image->scanLine(rect.y() + y)) + rect.x();
+        if (opaque) {
+            // Keep this loop trivial so the compiler can vectorize it.
+            for (int x = 0; x < rect.width(); ++x) {
+                dst[x] = src[x] | 0xff000000;
+            }
+        } else {
+            std::memcpy(dst, src, rect.width() * 4);
+        }
+    }
+}
+
+ShmCompletionEventFilter::ShmCompletionEventFilter(X11ImageUploader *uploader, int eventType)
+    : X11EventFilter(eventType)
+    , m_uploader(uploader)
+{
+}
+
+bool ShmCompletionEventFilter::event(xcb_generic_event_t *event)
+{
+    return m_uploader->handleEvent(event);
+}
+
+X11QPainterLayer::X11QPainterLayer(X11QPainterBackend *backend)
+    : OutputLayer(nullptr)
+    , m_backend(backend)
+{
+}
+
+std::optional<OutputLayerBeginFrameInfo> X11QPainterLayer::doBeginFrame()
+{
+    m_renderTime = std::make_unique<CpuRenderTimeQuery>();
+    return m_backend->beginFrame();
+}
+
+bool X11QPainterLayer::doEndFrame(const QRegion &renderedRegion, const QRegion &damagedRegion, OutputFrame *frame)
+{
+    m_renderTime->end();
+    frame->addRenderTimeQuery(std::move(m_renderTime));
+    m_backend->endFrame(renderedRegion);
+    return true;
+}
+
+DrmDevice *X11QPainterLayer::scanoutDevice() const
+{
+    return nullptr;
+}
+
+QHash<uint32_t, QList<uint64_t>> X11QPainterLayer::supportedDrmFormats() const
+{
+    return {};
+}
+
+X11QPainterBackend::X11QPainterBackend(X11StandaloneBackend *backend)
+    : m_backend(backend)
+    , m_connection(backend->connection())
+    , m_overlayWindow(std::make_unique<OverlayWindowX11>(backend))
+    , m_layer(std::make_unique<X11QPainterLayer>(this))
+{
+    // There is no way to determine when the uploaded contents are shown on the screen. Wait
+    // for a software vblank after the X server has processed the upload.
+    m_vsyncMonitor = SoftwareVsyncMonitor::create();
+    RenderLoop *renderLoop = backend->renderLoop();
+    m_vsyncMonitor->setRefreshRate(renderLoop->refreshRate());
+    connect(renderLoop, &RenderLoop::refreshRateChanged, this, [this, renderLoop]() {
+        m_vsyncMonitor->setRefreshRate(renderLoop->refreshRate());
+    });
+    connect(m_vsyncMonitor.get(), &VsyncMonitor::vblankOccurred, this, &X11QPainterBackend::vblank);
+
+    if (init()) {
+        connect(workspace(), &Workspace::geometryChanged, this, &X11QPainterBackend::screenGeometryChanged);
+    }
+}
+
+X11QPainterBackend::~X11QPainterBackend()
+{
+    m_shmCompletionFilter.reset();
+    m_uploader.reset();
+    if (m_overlayWindow->window()) {
+        m_overlayWindow->destroy();
+    }
+}
+
+bool X11QPainterBackend::init()
+{
+    const xcb_setup_t *setup = xcb_get_setup(m_connection);
+    const uint8_t nativeByteOrder = QSysInfo::ByteOrder == QSysInfo::LittleEndian ? XCB_IMAGE_ORDER_LSB_FIRST : XCB_IMAGE_ORDER_MSB_FIRST;
+    if (setup->image_byte_order != nativeByteOrder) {
+        setFailed(QStringLiteral("The image byte order of the X server doesn't match the native byte order"));
+        return false;
+    }
+
+    m_depth = Xcb::defaultDepth();
+    uint8_t bitsPerPixel = 0;
+    for (auto it = xcb_setup_pixmap_formats_iterator(setup); it.rem; xcb_format_next(&it)) {
+        if (it.data->depth == m_depth) {
+            bitsPerPixel = it.data->bits_per_pixel;
+        }
+    }
+    if ((m_depth != 24 && m_depth != 32) || bitsPerPixel != 32) {
+        setFailed(QStringLiteral("Unsupported root window depth %1 with %2 bits per pixel").arg(m_depth).arg(bitsPerPixel));
+        return false;
+    }
+
+    if (!m_overlayWindow->create()) {
+        setFailed(QStringLiteral("Could not get overlay window"));
+        return false;
+    }
+    m_overlayWindow->setup(XCB_WINDOW_NONE);
+
+    const xcb_query_extension_reply_t *shmExtension = xcb_get_extension_data(m_connection, &xcb_shm_id);
+    m_haveShm = shmExtension && shmExtension->present;
+    m_uploader = std::make_unique<X11ImageUploader>(m_connection, m_overlayWindow->window(), m_depth, m_haveShm);
+    // The vsync monitor is armed once the X server has read the back buffer, it must not be
+    // painted on before.
+    connect(m_uploader.get(), &X11ImageUploader::uploaded, m_vsyncMonitor.get(), &VsyncMonitor::arm);
+    if (m_haveShm) {
+        m_shmCompletionFilter = std::make_unique<ShmCompletionEventFilter>(m_uploader.get(), shmExtension->first_event + XCB_SHM_COMPLETION);
+    } else {
+        qCDebug(KWIN_X11STANDALONE) << "MIT-SHM is unavailable, the screen contents will be uploaded with PutImage";
+    }
+
+    const QSize size = workspace()->geometry().size();
+    m_overlayWindow->resize(size);
+    resizeBackBuffer(size);
+    return true;
+}
+
+void X11QPainterBackend::screenGeometryChanged()
+{
+    const QSize size = workspace()->geometry().size();
+    m_overlayWindow->resize(size);
+    resizeBackBuffer(size);
+}
+
+void X11QPainterBackend::resizeBackBuffer(const QSize &size)
+{
+    m_uploader->resize(size);
+    m_backBufferDirty = true;
+}
+
+OutputLayerBeginFrameInfo X11QPainterBackend::beginFrame()
+{
+    // The back buffer is never flipped, so it still contains the previous frame, unless it
+    // has been recreated.
+    QImage *backBuffer = m_uploader->image();
+    QRegion repaint;
+    if (m_backBufferDirty) {
+        repaint = backBuffer->rect();
+        m_backBufferDirty = false;
+    }
+    return OutputLayerBeginFrameInfo{
+        .renderTarget = RenderTarget(backBuffer),
+        .repaint = repaint,
+    };
+}
+
+void X11QPainterBackend::endFrame(const QRegion &renderedRegion)
+{
+    m_presentRegion += renderedRegion;
+}
+
+bool X11QPainterBackend::present(Output *output, const std::shared_ptr<OutputFrame> &frame)
+{
+    m_frame = frame;
+
+    const QList<QRect> rects = transferRects(m_presentRegion, m_uploader->image()->rect());
+    m_presentRegion = QRegion();
+    m_uploader->upload(rects);
+
+    if (m_overlayWindow->window()) { // show the window only after the first pass,
+        m_overlayWindow->show(); // since that pass may take long
+    }
+    return true;
+}
+
+void X11QPainterBackend::vblank(std::chrono::nanoseconds timestamp)
+{
+    if (!m_frame) {
+        return;
+    }
+    frameTraceInstant("Vblank");
+    m_frame->presented(timestamp, PresentationMode::VSync);
+    m_frame.reset();
+}
+
+void X11QPainterBackend::fetchImage(xcb_drawable_t drawable, const QRegion &region, QImage *image)
+{
+    const QList<QRect> rects = transferRects(region, image->rect());
+    if (rects.isEmpty()) {
+        return;
+    }
+    frameTraceScope("Fetch window contents");
+    if (!m_haveShm || !fetchImageShm(drawable, rects, image)) {
+        fetchImageCore(drawable, rects, image);
+    }
+}
+
+bool X11QPainterBackend::fetchImageShm(xcb_drawable_t drawable, const QList<QRect> &rects, QImage *image)
+{
+    size_t requiredSize = 0;
+    for (const QRect &rect : rects) {
+        requiredSize += size_t(rect.width()) * rect.height() * 4;
+    }
+    if (!m_fetchShm || m_fetchShm->size() < requiredSize) {
+        m_fetchShm = std::make_unique<Xcb::Shm>(std::max(requiredSize, s_minFetchSegmentSize));
+        if (!m_fetchShm->isValid()) {
+            qCDebug(KWIN_X11STANDALONE) << "Failed to allocate a shared memory segment of" << requiredSize << "bytes";
+            m_fetchShm.reset();
+            return false;
+        }
+    }
+
+    // Send all requests before waiting for the first reply.
+    QVarLengthArray<xcb_shm_get_image_cookie_t, s_maxTransferRects> cookies;
+    uint32_t offset = 0;
+    for (const QRect &rect : rects) {
+        cookies.append(xcb_shm_get_image_unchecked(m_connection, drawable, rect.x(), rect.y(), rect.width(), rect.height(),
+                                                   ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, m_fetchShm->segment(), offset));
+        offset += rect.width() * rect.height() * 4;
+    }
+
+    offset = 0;
+    const uchar *buffer = static_cast<const uchar *>(m_fetchShm->buffer());
+    for (int i = 0; i < rects.size(); ++i) {
+        const QRect &rect = rects[i];
+        UniqueCPtr<xcb_shm_get_image_reply_t> reply(xcb_shm_get_image_reply(m_connection, cookies[i], nullptr));
+        if (reply) {
+            copyToImage(buffer + offset, rect.width() * 4, rect, image);
+        }
+        offset += rect.width() * rect.height() * 4;
+    }
+    return true;
+}
+
+void X11QPainterBackend::fetchImageCore(xcb_drawable_t drawable, const QList<QRect> &rects, QImage *image)
+{
+    QVarLengthArray<xcb_get_image_cookie_t, s_maxTransferRects> cookies;
+    for (const QRect &rect : rects) {
+        cookies.append(xcb_get_image_unchecked(m_connection, XCB_IMAGE_FORMAT_Z_PIXMAP, drawable,
+                                               rect.x(), rect.y(), rect.width(), rect.height(), ~0));
+    }
+
+    for (int i = 0; i < rects.size(); ++i) {
+        UniqueCPtr<xcb_get_image_reply_t> reply(xcb_get_image_reply(m_connection, cookies[i], nullptr));
+        if (reply) {
+            copyToImage(xcb_get_image_data(reply.get()), rects[i].width() * 4, rects[i], image);
+        }
+    }
+}
+
+std::unique_ptr<SurfaceTexture> X11QPainterBackend::createSurfaceTextureX11(SurfacePixmapX11 *pixmap)
+{
+    return std::make_unique<QPainterSurfaceTextureX11>(this, pixmap);
+}
+
+OverlayWindow *X11QPainterBackend::overlayWindow() const
+{
+    return m_overlayWindow.get();
+}
+
+OutputLayer *X11QPainterBackend::primaryLayer(Output *output)
+{
+    return m_layer.get();
+}
+
+QPainterSurfaceTextureX11::QPainterSurfaceTextureX11(X11QPainterBackend *backend, SurfacePixmapX11 *pixmap)
+    : QPainterSurfaceTexture(backend)
+    , m_pixmap(pixmap)
+{
+}
+
+bool QPainterSurfaceTextureX11::create()
+{
+    const xcb_pixmap_t nativePixmap = m_pixmap->pixmap();
+    if (nativePixmap == XCB_PIXMAP_NONE) {
+        return false;
+    }
+
+    xcb_connection_t *connection = kwinApp()->x11Connection();
+    UniqueCPtr<xcb_get_geometry_reply_t> geometry(xcb_get_geometry_reply(connection, xcb_get_geometry_unchecked(connection, nativePixmap), nullptr));
+    if (!geometry) {
+        return false;
+    }
+
+    QImage::Format format;
+    switch (geometry->depth) {
+    case 32:
+        format = QImage::Format_ARGB32_Premultiplied;
+        break;
+    case 24:
+        format = QImage::Format_RGB32;
+        break;
+    default:
+        qCDebug(KWIN_X11STANDALONE) << "Unsupported window pixmap depth" << geometry->depth;
+        return false;
+    }
+
+    m_image = QImage(m_pixmap->size(), format);
+    static_cast<X11QPainterBackend *>(m_backend)->fetchImage(nativePixmap, m_image.rect(), &m_image);
+    return !m_image.isNull();
+}
+
+void QPainterSurfaceTextureX11::update(const QRegion &region)
+{
+    static_cast<X11QPainterBackend *>(m_backend)->fetchImage(m_pixmap->pixmap(), region, &m_image);
+}
+
+} // namespace KWin
+
+#include "moc_x11_standalone_qpainter_backend.cpp"
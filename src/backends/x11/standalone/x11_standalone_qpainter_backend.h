@@ -0,0 +1,127 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "core/outputlayer.h"
+#include "platformsupport/scenes/qpainter/qpainterbackend.h"
+#include "platformsupport/scenes/qpainter/qpaintersurfacetexture.h"
+#include "x11eventfilter.h"
+
+#include <QImage>
+#include <QRegion>
+
+#include <memory>
+
+namespace KWin
+{
+
+namespace Xcb
+{
+class Shm;
+}
+
+class OverlayWindowX11;
+class SoftwareVsyncMonitor;
+class SurfacePixmapX11;
+class X11ImageUploader;
+class X11QPainterBackend;
+class X11StandaloneBackend;
+
+class ShmCompletionEventFilter : public X11EventFilter
+{
+public:
+    ShmCompletionEventFilter(X11ImageUploader *uploader, int eventType);
+
+    bool event(xcb_generic_event_t *event) override;
+
+private:
+    X11ImageUploader *m_uploader;
+};
+
+class X11QPainterLayer : public OutputLayer
+{
+public:
+    X11QPainterLayer(X11QPainterBackend *backend);
+
+    std::optional<OutputLayerBeginFrameInfo> doBeginFrame() override;
+    bool doEndFrame(const QRegion &renderedRegion, const QRegion &damagedRegion, OutputFrame *frame) override;
+    DrmDevice *scanoutDevice() const override;
+    QHash<uint32_t, QList<uint64_t>> supportedDrmFormats() const override;
+
+private:
+    X11QPainterBackend *const m_backend;
+    std::unique_ptr<CpuRenderTimeQuery> m_renderTime;
+};
+
+/**
+ * The X11QPainterBackend class composites the screen on the CPU, for X servers without usable
+ * hardware acceleration, e.g. in virtual machines, on thin clients or with Xvnc.
+ *
+ * The scene is painted into a back buffer in shared memory. Only the painted region is
+ * uploaded to the overlay window with ShmPutImage, or PutImage if MIT-SHM is unavailable or
+ * the X server fails to report the completion of an upload.
+ * The back buffer is never flipped, so only the damage of the current frame has to be painted.
+ */
+class X11QPainterBackend : public QPainterBackend
+{
+    Q_OBJECT
+
+public:
+    X11QPainterBackend(X11StandaloneBackend *backend);
+    ~X11QPainterBackend() override;
+
+    std::unique_ptr<SurfaceTexture> createSurfaceTextureX11(SurfacePixmapX11 *pixmap) override;
+    OutputLayerBeginFrameInfo beginFrame();
+    void endFrame(const QRegion &renderedRegion);
+    bool present(Output *output, const std::shared_ptr<OutputFrame> &frame) override;
+    OverlayWindow *overlayWindow() const override;
+    OutputLayer *primaryLayer(Output *output) override;
+
+    /**
+     * Copies the contents of @a drawable in @a region to the same position in @a image.
+     */
+    void fetchImage(xcb_drawable_t drawable, const QRegion &region, QImage *image);
+
+private:
+    bool init();
+    void screenGeometryChanged();
+    void resizeBackBuffer(const QSize &size);
+    bool fetchImageShm(xcb_drawable_t drawable, const QList<QRect> &rects, QImage *image);
+    void fetchImageCore(xcb_drawable_t drawable, const QList<QRect> &rects, QImage *image);
+    void vblank(std::chrono::nanoseconds timestamp);
+
+    X11StandaloneBackend *m_backend;
+    xcb_connection_t *m_connection;
+    std::unique_ptr<OverlayWindowX11> m_overlayWindow;
+    std::unique_ptr<X11QPainterLayer> m_layer;
+    std::unique_ptr<SoftwareVsyncMonitor> m_vsyncMonitor;
+    std::unique_ptr<X11ImageUploader> m_uploader;
+    std::unique_ptr<ShmCompletionEventFilter> m_shmCompletionFilter;
+    std::shared_ptr<OutputFrame> m_frame;
+    uint8_t m_depth = 0;
+    bool m_haveShm = false;
+    std::unique_ptr<Xcb::Shm> m_fetchShm;
+    bool m_backBufferDirty = true;
+    QRegion m_presentRegion;
+};
+
+class QPainterSurfaceTextureX11 : public QPainterSurfaceTexture
+{
+public:
+    QPainterSurfaceTextureX11(X11QPainterBackend *backend, SurfacePixmapX11 *pixmap);
+
+    bool create() override;
+    void update(const QRegion &region) override;
+
+private:
+    SurfacePixmapX11 *m_pixmap;
+};
+
+} // namespace KWin
@@ -10,6 +10,8 @@
 #include "utils/xcbutils.h"
 #include "x11_standalone_cursor.h"
 
+#include <xcb/xfixes.h>
+
 namespace KWin
 {
 
@@ -21,7 +23,8 @@ XFixesCursorEventFilter::XFixesCursorEventFilter(X11Cursor *cursor)
 
 bool XFixesCursorEventFilter::event(xcb_generic_event_t *event)
 {
-    m_cursor->notifyCursorChanged();
+    const auto notifyEvent = reinterpret_cast<xcb_xfixes_cursor_notify_event_t *>(event);
+    m_cursor->notifyCursorChanged(notifyEvent->cursor_serial);
     return false;
 }
 
@@ -17,6 +17,7 @@
 #include "core/renderloop.h"
 #include "cursor.h"
 #include "dbusinterface.h"
+#include "frametracer.h"
 #include "ftrace.h"
 #include "scene/cursorscene.h"
 #include "scene/surfaceitem.h"
@@ -57,6 +58,7 @@ Compositor::Compositor(QObject *workspace)
     // register DBus
     new CompositorDBusInterface(this);
     FTraceLogger::create();
+    FrameTracer::create();
 }
 
 Compositor::~Compositor()
@@ -78,6 +80,21 @@ Output *Compositor::findOutput(RenderLoop *loop) const
     return nullptr;
 }
 
+QMap<QString, RenderLoop *> Compositor::renderLoops() const
+{
+    QHash<RenderLoop *, QStringList> outputNames;
+    const auto outputs = workspace()->outputs();
+    for (Output *output : outputs) {
+        outputNames[output->renderLoop()].append(output->name());
+    }
+
+    QMap<QString, RenderLoop *> loops;
+    for (auto it = outputNames.cbegin(); it != outputNames.cend(); ++it) {
+        loops.insert(it.value().size() == 1 ? it.value().constFirst() : QStringLiteral("default"), it.key());
+    }
+    return loops;
+}
+
 void Compositor::addSuperLayer(RenderLayer *layer)
 {
     m_superlayers.insert(layer->loop(), layer);
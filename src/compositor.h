@@ -17,6 +17,7 @@
 #endif
 
 #include <QHash>
+#include <QMap>
 #include <QObject>
 #include <QRegion>
 #include <QTimer>
@@ -77,6 +78,12 @@ public:
         return m_backend.get();
     }
 
+    /**
+     * Returns the render loops of the outputs, keyed by the name of the output that a loop
+     * drives, or "default" for a loop that is shared by several outputs, as on X11.
+     */
+    QMap<QString, RenderLoop *> renderLoops() const;
+
     /**
      * @brief Static check to test whether the Compositor is available and active.
      *
@@ -14,8 +14,10 @@
 #include "core/outputbackend.h"
 #include "core/renderbackend.h"
 #include "core/renderlayer.h"
+#include "core/renderloop.h"
 #include "cursorsource.h"
 #include "effect/effecthandler.h"
+#include "frametracer.h"
 #include "ftrace.h"
 #include "main.h"
 #include "opengl/glplatform.h"
@@ -332,6 +334,7 @@ void WaylandCompositor::composite(RenderLoop *renderLoop)
     Output *output = findOutput(renderLoop);
     OutputLayer *primaryLayer = m_backend->primaryLayer(output);
     fTraceDuration("Paint (", output->name(), ")");
+    frameTraceScope("Composite");
 
     RenderLayer *superLayer = m_superlayers[renderLoop];
     superLayer->setOutputLayer(primaryLayer);
@@ -393,13 +396,11 @@ void WaylandCompositor::composite(RenderLoop *renderLoop)
         frame->setContentType(activeWindow && activeFullscreenItem ? activeFullscreenItem->contentType() : ContentType::None);
 
         const bool wantsAdaptiveSync = activeWindow && activeWindow->isOnOutput(output) && activeWindow->wantsAdaptiveSync();
-        const bool vrr = (output->capabilities() & Output::Capability::Vrr) && (output->vrrPolicy() == VrrPolicy::Always || (output->vrrPolicy() == VrrPolicy::Automatic && wantsAdaptiveSync));
-        const bool tearing = (output->capabilities() & Output::Capability::Tearing) && options->allowTearing() && activeFullscreenItem && activeWindow->wantsTearing(isTearingRequested(activeFullscreenItem));
-        if (vrr) {
-            frame->setPresentationMode(tearing ? PresentationMode::AdaptiveAsync : PresentationMode::AdaptiveSync);
-        } else {
-            frame->setPresentationMode(tearing ? PresentationMode::Async : PresentationMode::VSync);
-        }
+        const bool wantsTearing = options->allowTearing() && activeFullscreenItem && activeWindow->wantsTearing(isTearingRequested(activeFullscreenItem));
+        frame->setPresentationMode(RenderLoop::selectPresentationMode(output->capabilities().testFlag(Output::Capability::Vrr), output->vrrPolicy(),
+                                                                      wantsAdaptiveSync,
+                                                                      output->capabilities().testFlag(Output::Capability::Tearing),
+                                                                      wantsTearing));
 
         const uint32_t planeCount = 1;
         if (const auto scanoutCandidates = superLayer->delegate()->scanoutCandidates(planeCount + 1); !scanoutCandidates.isEmpty()) {
@@ -8,22 +8,31 @@
 */
 
 #include "compositor_x11.h"
+#include "core/output.h"
 #include "core/outputbackend.h"
 #include "core/overlaywindow.h"
 #include "core/renderbackend.h"
 #include "core/renderlayer.h"
+#include "core/renderloop.h"
 #include "effect/effecthandler.h"
+#include "frametracer.h"
 #include "ftrace.h"
 #include "opengl/glplatform.h"
 #include "options.h"
 #include "platformsupport/scenes/opengl/openglbackend.h"
+#include "platformsupport/scenes/qpainter/qpainterbackend.h"
+#include "scene/decorationitem.h"
 #include "scene/surfaceitem_x11.h"
+#include "scene/windowitem.h"
 #include "scene/workspacescene_opengl.h"
+#include "scene/workspacescene_qpainter.h"
 #include "utils/common.h"
 #include "utils/xcbutils.h"
+#include "virtualdesktops.h"
 #include "window.h"
 #include "workspace.h"
 #include "x11syncmanager.h"
+#include "x11window.h"
 
 #include <KCrash>
 #include <KGlobalAccel>
@@ -34,10 +43,12 @@
 #endif
 
 #include <QAction>
-#include <QOpenGLContext>
 #include <QQuickWindow>
 #include <QThread>
 
+#include <algorithm>
+#include <array>
+
 Q_DECLARE_METATYPE(KWin::X11Compositor::SuspendReason)
 
 namespace KWin
@@ -128,6 +139,11 @@ X11SyncManager *X11Compositor::syncManager() const
     return m_syncManager.get();
 }
 
+bool X11Compositor::arePixmapsDirty() const
+{
+    return m_pixmapsDirty;
+}
+
 void X11Compositor::toggle()
 {
     if (m_suspended) {
@@ -224,10 +240,22 @@ bool X11Compositor::attemptOpenGLCompositing()
             return false;
         }
     } else {
-        if (backend->openglContext()->glPlatform()->recommendedCompositor() < OpenGLCompositing) {
+        const GLPlatform *platform = backend->openglContext()->glPlatform();
+        if (platform->recommendedCompositor() < OpenGLCompositing) {
             qCDebug(KWIN_CORE) << "Driver does not recommend OpenGL compositing";
             return false;
         }
+        // A software rasterizer spends most of the frame emulating the GPU pipeline, the
+        // QPainter backend paints the same scene on the CPU at a fraction of the cost.
+        switch (platform->driver()) {
+        case Driver_Swrast:
+        case Driver_Softpipe:
+        case Driver_Llvmpipe:
+            qCDebug(KWIN_CORE) << "Not using OpenGL compositing with the software rasterizer" << GLPlatform::driverToString(platform->driver());
+            return false;
+        default:
+            break;
+        }
     }
 
     // We only support the OpenGL 2+ shader API, not GL_ARB_shader_objects
@@ -248,6 +276,20 @@ bool X11Compositor::attemptOpenGLCompositing()
     return true;
 }
 
+bool X11Compositor::attemptQPainterCompositing()
+{
+    std::unique_ptr<QPainterBackend> backend(kwinApp()->outputBackend()->createQPainterBackend());
+    if (!backend || backend->isFailed()) {
+        return false;
+    }
+
+    m_scene = std::make_unique<WorkspaceSceneQPainter>(backend.get());
+    m_backend = std::move(backend);
+
+    qCDebug(KWIN_CORE) << "QPainter compositing has been successfully initialized";
+    return true;
+}
+
 void X11Compositor::start()
 {
     if (m_suspended) {
@@ -311,7 +353,11 @@ void X11Compositor::start()
             }
             break;
         case QPainterCompositing:
-            qCDebug(KWIN_CORE) << "QPainter compositing is unsupported on X11";
+            qCDebug(KWIN_CORE) << "Attempting to load the QPainter scene";
+            stop = attemptQPainterCompositing();
+            if (stop) {
+                QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+            }
             break;
         case NoCompositing:
             qCDebug(KWIN_CORE) << "Starting without compositing...";
@@ -416,6 +462,74 @@ void X11Compositor::stop()
     Q_EMIT compositingToggled(false);
 }
 
+/**
+ * Returns @c true if @a window is only hidden because it's on one of the given @a desktops next
+ * to the current one, and is kept mapped for its preview.
+ */
+static bool isAdjacentPreview(X11Window *window, const std::array<VirtualDesktop *, 4> &desktops)
+{
+    if (!window->hiddenPreview() || window->isMinimized() || window->isHidden() || !window->isOnCurrentActivity()) {
+        return false;
+    }
+    return std::any_of(desktops.begin(), desktops.end(), [window](VirtualDesktop *desktop) {
+        return desktop && window->isOnDesktop(desktop);
+    });
+}
+
+void X11Compositor::updateOcclusion(const QList<Window *> &windows)
+{
+    frameTraceScope("Occlusion");
+
+    // Damage of windows that can't be seen, either because they are suspended, e.g. minimized
+    // or on another virtual desktop, or because they are fully covered by opaque windows above
+    // them, stays in the X server until they can be seen again, unless a window rule says
+    // otherwise or effects render them offscreen, e.g. for thumbnails. Only windows that the
+    // last frame painted neither translucent nor transformed can cover others, and effects
+    // that take over the screen can show any window.
+    const bool enabled = effects && !effects->hasActiveFullScreenEffect();
+
+    // The kept previews of windows on the desktops next to the current one stay up to date,
+    // so a desktop switch can slide to them without waiting for their contents.
+    VirtualDesktopManager *desktopManager = VirtualDesktopManager::self();
+    VirtualDesktop *currentDesktop = desktopManager->currentDesktop();
+    const bool wrap = desktopManager->isNavigationWrappingAround();
+    const std::array<VirtualDesktop *, 4> adjacentDesktops{
+        desktopManager->inDirection(currentDesktop, VirtualDesktopManager::Direction::Left, wrap),
+        desktopManager->inDirection(currentDesktop, VirtualDesktopManager::Direction::Right, wrap),
+        desktopManager->inDirection(currentDesktop, VirtualDesktopManager::Direction::Up, wrap),
+        desktopManager->inDirection(currentDesktop, VirtualDesktopManager::Direction::Down, wrap),
+    };
+
+    QRegion opaque;
+    int occludedCount = 0;
+    for (auto it = windows.crbegin(); it != windows.crend(); ++it) {
+        Window *window = *it;
+        SurfaceItemX11 *surfaceItem = static_cast<SurfaceItemX11 *>(window->surfaceItem());
+        bool occluded = false;
+        if (!window->isDeleted() && !window->isOffscreenRendering() && surfaceItem->window()->throttlePolicy() != ThrottlePolicy::None) {
+            if (window->isSuspended()) {
+                occluded = !isAdjacentPreview(surfaceItem->window(), adjacentDesktops);
+            } else {
+                occluded = enabled && (QRegion(window->visibleGeometry().toAlignedRect()) - opaque).isEmpty();
+            }
+        }
+        surfaceItem->setOccluded(occluded);
+        if (occluded) {
+            occludedCount++;
+            continue;
+        }
+
+        if (enabled && !window->isDeleted() && window->isShown() && window->isOnCurrentDesktop()
+            && window->opacity() == 1.0 && m_scene->isOccluder(window)) {
+            opaque += surfaceItem->mapToScene(surfaceItem->opaque());
+            if (const DecorationItem *decorationItem = window->windowItem()->decorationItem()) {
+                opaque += decorationItem->mapToScene(decorationItem->opaque());
+            }
+        }
+    }
+    frameTraceCounter("Occluded windows", occludedCount);
+}
+
 void X11Compositor::composite(RenderLoop *renderLoop)
 {
     if (backend()->overlayWindow() && !backend()->overlayWindow()->isVisible()) {
@@ -423,29 +537,43 @@ void X11Compositor::composite(RenderLoop *renderLoop)
         return;
     }
 
+    frameTraceScope("Composite");
+
     QList<Window *> windows = workspace()->stackingOrder();
     QList<SurfaceItemX11 *> dirtyItems;
 
-    // Reset the damage state of each window and fetch the damage region
-    // without waiting for a reply
-    for (Window *window : std::as_const(windows)) {
-        SurfaceItemX11 *surfaceItem = static_cast<SurfaceItemX11 *>(window->surfaceItem());
-        if (surfaceItem->fetchDamage()) {
-            dirtyItems.append(surfaceItem);
+    updateOcclusion(windows);
+
+    {
+        frameTraceScope("Damage fetch");
+
+        // Reset the damage state of each window and fetch the damage region
+        // without waiting for a reply
+        for (Window *window : std::as_const(windows)) {
+            SurfaceItemX11 *surfaceItem = static_cast<SurfaceItemX11 *>(window->surfaceItem());
+            if (surfaceItem->fetchDamage()) {
+                dirtyItems.append(surfaceItem);
+            }
         }
-    }
 
-    if (dirtyItems.count() > 0) {
-        if (m_syncManager) {
-            m_syncManager->triggerFence();
+        if (dirtyItems.count() > 0) {
+            if (m_syncManager) {
+                m_syncManager->triggerFence();
+            }
+            xcb_flush(kwinApp()->x11Connection());
         }
-        xcb_flush(kwinApp()->x11Connection());
-    }
 
-    // Get the replies
-    for (SurfaceItemX11 *item : std::as_const(dirtyItems)) {
-        item->waitForDamage();
+        // Get the replies
+        for (SurfaceItemX11 *item : std::as_const(dirtyItems)) {
+            item->waitForDamage();
+        }
+
+        // Pixmaps of windows that have just been mapped or resized are created when painting.
+        m_pixmapsDirty = !dirtyItems.isEmpty() || std::any_of(windows.cbegin(), windows.cend(), [](Window *window) {
+            return window->readyForPainting() && !window->surfaceItem()->pixmap();
+        });
     }
+    frameTraceCounter("Damaged windows", dirtyItems.count());
 
     if (m_framesToTestForSafety > 0 && (backend()->compositingType() & OpenGLCompositing)) {
         createOpenGLSafePoint(OpenGLSafePoint::PreFrame);
@@ -471,6 +599,23 @@ void X11Compositor::composite(RenderLoop *renderLoop)
 
     renderLoop->prepareNewFrame();
     auto frame = std::make_shared<OutputFrame>(renderLoop, std::chrono::nanoseconds(1'000'000'000'000) / renderLoop->refreshRate());
+    frameTraceFlowBegin("Frame", quintptr(frame.get()));
+
+    // All outputs share a single render loop, so the presentation mode follows the output
+    // with the active window.
+    Window *const activeWindow = workspace()->activeWindow();
+    if (Output *output = activeWindow ? activeWindow->output() : nullptr) {
+        const X11Window *x11Window = qobject_cast<X11Window *>(activeWindow);
+        // Async swaps make the whole overlay tear, so a window can only ask for tearing while
+        // it's fullscreen. A forced tearing rule applies regardless, wantsTearing(false) is
+        // only true if the rule forces it.
+        const bool forcedTearing = activeWindow->wantsTearing(false);
+        const bool wantsTearing = options->allowTearing() && (forcedTearing || (activeWindow->isFullScreen() && activeWindow->wantsTearing(x11Window && x11Window->isTearingRequested())));
+        frame->setPresentationMode(RenderLoop::selectPresentationMode(output->capabilities().testFlag(Output::Capability::Vrr), output->vrrPolicy(),
+                                                                      activeWindow->wantsAdaptiveSync(),
+                                                                      output->capabilities().testFlag(Output::Capability::Tearing),
+                                                                      wantsTearing));
+    }
 
     if (primaryLayer->needsRepaint() || superLayer->needsRepaint()) {
         renderLoop->beginPaint();
@@ -575,9 +720,6 @@ QString X11Compositor::compositingNotPossibleReason() const
     if (!Xcb::Extensions::self()->isCompositeAvailable() || !Xcb::Extensions::self()->isDamageAvailable()) {
         return i18n("Required X extensions (XComposite and XDamage) are not available.");
     }
-    if (!Xcb::Extensions::self()->hasGlx()) {
-        return i18n("GLX/OpenGL is not available.");
-    }
     return QString();
 }
 
@@ -598,16 +740,8 @@ bool X11Compositor::compositingPossible() const
         qCWarning(KWIN_CORE) << "Compositing disabled: no damage extension available";
         return false;
     }
-    if (Xcb::Extensions::self()->hasGlx()) {
-        return true;
-    }
-    if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES) {
-        return true;
-    } else if (qstrcmp(qgetenv("KWIN_COMPOSE"), "O2ES") == 0) {
-        return true;
-    }
-    qCWarning(KWIN_CORE) << "Compositing disabled: no OpenGL support";
-    return false;
+    // Without OpenGL, the QPainter backend can still composite.
+    return true;
 }
 
 void X11Compositor::createOpenGLSafePoint(OpenGLSafePoint safePoint)
@@ -38,6 +38,11 @@ public:
     ~X11Compositor() override;
 
     X11SyncManager *syncManager() const;
+    /**
+     * Returns @c true if the X server may still be rendering to window pixmaps that will be
+     * sampled in the current frame, i.e. some windows have been damaged or have no pixmap yet.
+     */
+    bool arePixmapsDirty() const;
 
     void start() override;
     void stop() override;
@@ -114,6 +119,8 @@ private:
     explicit X11Compositor(QObject *parent);
 
     bool attemptOpenGLCompositing();
+    bool attemptQPainterCompositing();
+    void updateOcclusion(const QList<Window *> &windows);
 
     void releaseCompositorSelection();
     void destroyCompositorSelection();
@@ -129,6 +136,7 @@ private:
     SuspendReasons m_suspended;
     QSet<Window *> m_inhibitors;
     int m_framesToTestForSafety = 3;
+    bool m_pixmapsDirty = false;
 };
 
 } // namespace KWin
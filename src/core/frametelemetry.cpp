@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "frametelemetry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace KWin
+{
+
+void FrameHistogram::add(std::chrono::nanoseconds duration)
+{
+    duration = std::max(duration, std::chrono::nanoseconds::zero());
+    const size_t bucket = duration / BucketWidth;
+    if (bucket < BucketCount) {
+        m_buckets[bucket]++;
+    } else {
+        m_overflow++;
+    }
+    m_count++;
+    m_sum += duration;
+    m_max = std::max(m_max, duration);
+}
+
+void FrameHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_overflow = 0;
+    m_count = 0;
+    m_sum = std::chrono::nanoseconds::zero();
+    m_max = std::chrono::nanoseconds::zero();
+}
+
+uint64_t FrameHistogram::count() const
+{
+    return m_count;
+}
+
+std::chrono::nanoseconds FrameHistogram::max() const
+{
+    return m_max;
+}
+
+std::chrono::nanoseconds FrameHistogram::mean() const
+{
+    if (!m_count) {
+        return std::chrono::nanoseconds::zero();
+    }
+    return m_sum / m_count;
+}
+
+std::chrono::nanoseconds FrameHistogram::percentile(double percentile) const
+{
+    if (!m_count) {
+        return std::chrono::nanoseconds::zero();
+    }
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(m_count * std::clamp(percentile, 0.0, 100.0) / 100.0));
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        accumulated += m_buckets[i];
+        if (accumulated >= rank) {
+            return std::min((i + 1) * BucketWidth, m_max);
+        }
+    }
+    return m_max;
+}
+
+QVariantMap FrameHistogram::toVariantMap() const
+{
+    auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+    return QVariantMap{
+        {QStringLiteral("count"), qulonglong(m_count)},
+        {QStringLiteral("mean"), toMicroseconds(mean())},
+        {QStringLiteral("max"), toMicroseconds(m_max)},
+        {QStringLiteral("p50"), toMicroseconds(percentile(50))},
+        {QStringLiteral("p95"), toMicroseconds(percentile(95))},
+        {QStringLiteral("p99"), toMicroseconds(percentile(99))},
+        {QStringLiteral("overflow"), m_overflow},
+    };
+}
+
+void FrameTelemetry::reset()
+{
+    renderTime.reset();
+    predictionError.reset();
+    latency.reset();
+    syncWaitTime.reset();
+    presentedFrames = 0;
+    droppedFrames = 0;
+    underpredictedFrames = 0;
+    missedVblanks = 0;
+}
+
+QVariantMap FrameTelemetry::toVariantMap() const
+{
+    return QVariantMap{
+        {QStringLiteral("renderTime"), renderTime.toVariantMap()},
+        {QStringLiteral("predictionError"), predictionError.toVariantMap()},
+        {QStringLiteral("latency"), latency.toVariantMap()},
+        {QStringLiteral("syncWaitTime"), syncWaitTime.toVariantMap()},
+        {QStringLiteral("presentedFrames"), qulonglong(presentedFrames)},
+        {QStringLiteral("droppedFrames"), qulonglong(droppedFrames)},
+        {QStringLiteral("underpredictedFrames"), qulonglong(underpredictedFrames)},
+        {QStringLiteral("missedVblanks"), qulonglong(missedVblanks)},
+    };
+}
+
+} // namespace KWin
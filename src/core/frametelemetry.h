@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+#include "kwin_export.h"
+
+#include <QVariantMap>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace KWin
+{
+
+/**
+ * The FrameHistogram class records a distribution of durations in fixed-size buckets, so
+ * adding a sample never allocates and the memory usage doesn't depend on the number of
+ * samples. Durations longer than the covered range are kept in an overflow bucket.
+ */
+class KWIN_EXPORT FrameHistogram
+{
+public:
+    static constexpr std::chrono::nanoseconds BucketWidth = std::chrono::microseconds(100);
+    static constexpr size_t BucketCount = 500;
+
+    void add(std::chrono::nanoseconds duration);
+    void reset();
+
+    uint64_t count() const;
+    std::chrono::nanoseconds max() const;
+    std::chrono::nanoseconds mean() const;
+
+    /**
+     * Returns the duration below which @a percentile percent of the samples fall. The result
+     * is rounded up to the end of the bucket that contains the percentile.
+     */
+    std::chrono::nanoseconds percentile(double percentile) const;
+
+    /**
+     * Returns the count, mean, max, p50, p95 and p99 in microseconds, and the number of samples
+     * that fell into the overflow bucket.
+     */
+    QVariantMap toVariantMap() const;
+
+private:
+    std::array<uint32_t, BucketCount> m_buckets{};
+    uint32_t m_overflow = 0;
+    uint64_t m_count = 0;
+    std::chrono::nanoseconds m_sum{0};
+    std::chrono::nanoseconds m_max{0};
+};
+
+/**
+ * The FrameTelemetry class collects frame pacing statistics of a RenderLoop.
+ */
+class KWIN_EXPORT FrameTelemetry
+{
+public:
+    /**
+     * How long it took to render a frame.
+     */
+    FrameHistogram renderTime;
+    /**
+     * The absolute difference between the predicted and the actual render time.
+     */
+    FrameHistogram predictionError;
+    /**
+     * The time between the first repaint request of a frame and its presentation.
+     */
+    FrameHistogram latency;
+    /**
+     * How long the compositor blocked waiting for the X server to finish rendering to window
+     * pixmaps, for frames that had to. Waits for sync fences happen on the GPU and aren't included.
+     */
+    FrameHistogram syncWaitTime;
+
+    uint64_t presentedFrames = 0;
+    uint64_t droppedFrames = 0;
+    /**
+     * The number of frames that took longer to render than predicted.
+     */
+    uint64_t underpredictedFrames = 0;
+    /**
+     * The number of vblanks that passed between the targeted and the actual presentation
+     * time of the frames.
+     */
+    uint64_t missedVblanks = 0;
+
+    void reset();
+    QVariantMap toVariantMap() const;
+};
+
+} // namespace KWin
@@ -5,6 +5,7 @@
 */
 
 #include "renderbackend.h"
+#include "frametracer.h"
 #include "renderloop_p.h"
 #include "scene/surfaceitem.h"
 #include "syncobjtimeline.h"
@@ -49,6 +50,7 @@ OutputFrame::OutputFrame(RenderLoop *loop, std::chrono::nanoseconds refreshDurat
     , m_refreshDuration(refreshDuration)
     , m_targetPageflipTime(loop->nextPresentationTimestamp())
     , m_predictedRenderTime(loop->predictedRenderTime())
+    , m_damageTimestamp(RenderLoopPrivate::get(loop)->takeDamageTimestamp())
 {
 }
 
@@ -90,6 +92,9 @@ void OutputFrame::presented(std::chrono::nanoseconds timestamp, PresentationMode
     Q_ASSERT(!m_presented);
     m_presented = true;
 
+    frameTraceScope("Presentation feedback");
+    frameTraceFlowEnd("Frame", quintptr(this));
+
     const auto renderTime = queryRenderTime();
     if (m_loop) {
         RenderLoopPrivate::get(m_loop)->notifyFrameCompleted(timestamp, renderTime, mode, this);
@@ -149,6 +154,21 @@ std::chrono::nanoseconds OutputFrame::predictedRenderTime() const
     return m_predictedRenderTime;
 }
 
+std::optional<std::chrono::nanoseconds> OutputFrame::damageTimestamp() const
+{
+    return m_damageTimestamp;
+}
+
+void OutputFrame::addSyncWaitTime(std::chrono::nanoseconds duration)
+{
+    m_syncWaitTime = m_syncWaitTime.value_or(std::chrono::nanoseconds::zero()) + duration;
+}
+
+std::optional<std::chrono::nanoseconds> OutputFrame::syncWaitTime() const
+{
+    return m_syncWaitTime;
+}
+
 std::optional<double> OutputFrame::brightness() const
 {
     return m_brightness;
@@ -95,6 +95,17 @@ public:
     std::chrono::steady_clock::time_point targetPageflipTime() const;
     std::chrono::nanoseconds refreshDuration() const;
     std::chrono::nanoseconds predictedRenderTime() const;
+    /**
+     * Returns the time when a repaint was first requested for this frame.
+     */
+    std::optional<std::chrono::nanoseconds> damageTimestamp() const;
+
+    /**
+     * Adds @a duration to the time that has been spent waiting for the X server to finish
+     * rendering to window pixmaps for this frame.
+     */
+    void addSyncWaitTime(std::chrono::nanoseconds duration);
+    std::optional<std::chrono::nanoseconds> syncWaitTime() const;
 
     std::optional<double> brightness() const;
     void setBrightness(double brightness);
@@ -109,11 +120,13 @@ private:
     const std::chrono::nanoseconds m_refreshDuration;
     const std::chrono::steady_clock::time_point m_targetPageflipTime;
     const std::chrono::nanoseconds m_predictedRenderTime;
+    const std::optional<std::chrono::nanoseconds> m_damageTimestamp;
     std::vector<std::unique_ptr<PresentationFeedback>> m_feedbacks;
     std::optional<ContentType> m_contentType;
     PresentationMode m_presentationMode = PresentationMode::VSync;
     QRegion m_damage;
     std::vector<std::unique_ptr<RenderTimeQuery>> m_renderTimeQueries;
+    std::optional<std::chrono::nanoseconds> m_syncWaitTime;
     bool m_presented = false;
     std::optional<double> m_brightness;
     std::optional<double> m_artificialHdrHeadroom;
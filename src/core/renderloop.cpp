@@ -5,6 +5,7 @@
 */
 
 #include "renderloop.h"
+#include "frametracer.h"
 #include "options.h"
 #include "renderloop_p.h"
 #include "scene/surfaceitem.h"
@@ -12,8 +13,6 @@
 #include "window.h"
 #include "workspace.h"
 
-#include <filesystem>
-
 using namespace std::chrono_literals;
 
 namespace KWin
@@ -24,8 +23,6 @@ RenderLoopPrivate *RenderLoopPrivate::get(RenderLoop *loop)
     return loop->d.get();
 }
 
-static const bool s_printDebugInfo = qEnvironmentVariableIntValue("KWIN_LOG_PERFORMANCE_DATA") != 0;
-
 RenderLoopPrivate::RenderLoopPrivate(RenderLoop *q, Output *output)
     : q(q)
     , output(output)
@@ -58,7 +55,7 @@ void RenderLoopPrivate::scheduleRepaint(std::chrono::nanoseconds lastTargetTimes
 {
     pendingReschedule = false;
     const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / refreshRate);
-    const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
+    const std::chrono::nanoseconds currentTime = now();
 
     // Estimate when it's a good time to perform the next compositing cycle.
     // the 1ms on top of the safety margin is required for timer and scheduler inaccuracies
@@ -134,6 +131,7 @@ void RenderLoopPrivate::notifyFrameDropped()
 {
     Q_ASSERT(pendingFrameCount > 0);
     pendingFrameCount--;
+    telemetry.droppedFrames++;
 
     if (!inhibitCount && pendingReschedule) {
         scheduleNextRepaint();
@@ -142,26 +140,36 @@ void RenderLoopPrivate::notifyFrameDropped()
 
 void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::optional<RenderTimeSpan> renderTime, PresentationMode mode, OutputFrame *frame)
 {
-    if (output && s_printDebugInfo && !m_debugOutput) {
-        m_debugOutput = std::fstream(qPrintable("kwin perf statistics " + output->name() + ".csv"), std::ios::out);
-        *m_debugOutput << "target pageflip timestamp,pageflip timestamp,render start,render end,safety margin,refresh duration,vrr,tearing,predicted render time\n";
-    }
-    if (m_debugOutput) {
-        auto times = renderTime.value_or(RenderTimeSpan{});
-        const bool vrr = mode == PresentationMode::AdaptiveSync || mode == PresentationMode::AdaptiveAsync;
-        const bool tearing = mode == PresentationMode::Async || mode == PresentationMode::AdaptiveAsync;
-        *m_debugOutput << frame->targetPageflipTime().time_since_epoch().count() << "," << timestamp.count() << "," << times.start.time_since_epoch().count() << "," << times.end.time_since_epoch().count()
-                       << "," << safetyMargin.count() << "," << frame->refreshDuration().count() << "," << (vrr ? 1 : 0) << "," << (tearing ? 1 : 0) << "," << frame->predictedRenderTime().count() << "\n";
-    }
-
     Q_ASSERT(pendingFrameCount > 0);
     pendingFrameCount--;
 
     notifyVblank(timestamp);
 
+    telemetry.presentedFrames++;
     if (renderTime) {
-        renderJournal.add(renderTime->end - renderTime->start, timestamp);
+        const std::chrono::nanoseconds duration = renderTime->end - renderTime->start;
+        renderJournal.add(duration, timestamp);
+        telemetry.renderTime.add(duration);
+        telemetry.predictionError.add(std::chrono::abs(duration - frame->predictedRenderTime()));
+        if (duration > frame->predictedRenderTime()) {
+            telemetry.underpredictedFrames++;
+        }
+        frameTraceCounter("Render time (us)", std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+    if (const auto damageTimestamp = frame->damageTimestamp()) {
+        telemetry.latency.add(timestamp - *damageTimestamp);
+    }
+    if (const auto syncWaitTime = frame->syncWaitTime()) {
+        telemetry.syncWaitTime.add(*syncWaitTime);
+        frameTraceCounter("X wait time (us)", std::chrono::duration_cast<std::chrono::microseconds>(*syncWaitTime).count());
     }
+    const std::chrono::nanoseconds targetTimestamp = frame->targetPageflipTime().time_since_epoch();
+    if (mode == PresentationMode::VSync && targetTimestamp != std::chrono::nanoseconds::zero() && timestamp > targetTimestamp) {
+        // Round to the nearest vblank, presentation timestamps are not exact.
+        const std::chrono::nanoseconds refreshDuration = frame->refreshDuration();
+        telemetry.missedVblanks += (timestamp - targetTimestamp + refreshDuration / 2) / refreshDuration;
+    }
+    frameTraceCounter("Predicted render time (us)", std::chrono::duration_cast<std::chrono::microseconds>(renderJournal.result()).count());
     if (compositeTimer.isActive()) {
         // reschedule to match the new timestamp and render time
         scheduleRepaint(lastPresentationTimestamp);
@@ -182,10 +190,20 @@ void RenderLoopPrivate::notifyVblank(std::chrono::nanoseconds timestamp)
                 "Got invalid presentation timestamp: %lld (current %lld)",
                 static_cast<long long>(timestamp.count()),
                 static_cast<long long>(lastPresentationTimestamp.count()));
-        lastPresentationTimestamp = std::chrono::steady_clock::now().time_since_epoch();
+        lastPresentationTimestamp = now();
     }
 }
 
+std::optional<std::chrono::nanoseconds> RenderLoopPrivate::takeDamageTimestamp()
+{
+    return std::exchange(damageTimestamp, std::nullopt);
+}
+
+std::chrono::nanoseconds RenderLoopPrivate::now() const
+{
+    return clock();
+}
+
 void RenderLoopPrivate::dispatch()
 {
     // On X11, we want to ignore repaints that are scheduled by windows right before
@@ -261,6 +279,9 @@ void RenderLoop::scheduleRepaint(Item *item, RenderLayer *layer, OutputLayer *ou
     if (d->pendingRepaint) {
         return;
     }
+    if (!d->damageTimestamp) {
+        d->damageTimestamp = d->now();
+    }
     const bool vrr = d->presentationMode == PresentationMode::AdaptiveSync || d->presentationMode == PresentationMode::AdaptiveAsync;
     const bool tearing = d->presentationMode == PresentationMode::Async || d->presentationMode == PresentationMode::AdaptiveAsync;
     if ((vrr || tearing) && workspace()->activeWindow() && d->output) {
@@ -297,6 +318,22 @@ void RenderLoop::setPresentationMode(PresentationMode mode)
     d->presentationMode = mode;
 }
 
+PresentationMode RenderLoop::presentationMode() const
+{
+    return d->presentationMode;
+}
+
+PresentationMode RenderLoop::selectPresentationMode(bool adaptiveSyncCapable, VrrPolicy vrrPolicy, bool wantsAdaptiveSync, bool tearingCapable, bool wantsTearing)
+{
+    const bool vrr = adaptiveSyncCapable && (vrrPolicy == VrrPolicy::Always || (vrrPolicy == VrrPolicy::Automatic && wantsAdaptiveSync));
+    const bool tearing = tearingCapable && wantsTearing;
+    if (vrr) {
+        return tearing ? PresentationMode::AdaptiveAsync : PresentationMode::AdaptiveSync;
+    } else {
+        return tearing ? PresentationMode::Async : PresentationMode::VSync;
+    }
+}
+
 void RenderLoop::setMaxPendingFrameCount(uint32_t maxCount)
 {
     d->maxPendingFrameCount = maxCount;
@@ -307,6 +344,16 @@ std::chrono::nanoseconds RenderLoop::predictedRenderTime() const
     return d->renderJournal.result();
 }
 
+const FrameTelemetry &RenderLoop::telemetry() const
+{
+    return d->telemetry;
+}
+
+void RenderLoop::resetTelemetry()
+{
+    d->telemetry.reset();
+}
+
 } // namespace KWin
 
 #include "moc_renderloop.cpp"
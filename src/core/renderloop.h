@@ -13,6 +13,7 @@
 namespace KWin
 {
 
+class FrameTelemetry;
 class RenderLoopPrivate;
 class SurfaceItem;
 class Item;
@@ -93,6 +94,15 @@ public:
     std::chrono::nanoseconds nextPresentationTimestamp() const;
 
     void setPresentationMode(PresentationMode mode);
+    PresentationMode presentationMode() const;
+
+    /**
+     * Returns how the next frame on an output should be presented. Adaptive sync is used if
+     * the output supports it and the @a vrrPolicy allows it, either always or only when the
+     * content @a wantsAdaptiveSync. The frame is allowed to tear only if the output supports
+     * it and the content @a wantsTearing.
+     */
+    static PresentationMode selectPresentationMode(bool adaptiveSyncCapable, VrrPolicy vrrPolicy, bool wantsAdaptiveSync, bool tearingCapable, bool wantsTearing);
 
     void setMaxPendingFrameCount(uint32_t maxCount);
 
@@ -101,6 +111,13 @@ public:
      */
     std::chrono::nanoseconds predictedRenderTime() const;
 
+    /**
+     * Returns the frame pacing statistics collected since the render loop has been created
+     * or since the last resetTelemetry() call.
+     */
+    const FrameTelemetry &telemetry() const;
+    void resetTelemetry();
+
 Q_SIGNALS:
     /**
      * This signal is emitted when the refresh rate of this RenderLoop has changed.
@@ -6,13 +6,14 @@
 
 #pragma once
 
+#include "frametelemetry.h"
 #include "renderbackend.h"
 #include "renderjournal.h"
 #include "renderloop.h"
 
 #include <QTimer>
 
-#include <fstream>
+#include <functional>
 #include <optional>
 
 namespace KWin
@@ -36,16 +37,19 @@ public:
     void notifyFrameDropped();
     void notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::optional<RenderTimeSpan> renderTime, PresentationMode mode, OutputFrame *frame);
     void notifyVblank(std::chrono::nanoseconds timestamp);
+    std::optional<std::chrono::nanoseconds> takeDamageTimestamp();
+    std::chrono::nanoseconds now() const;
 
     RenderLoop *const q;
     Output *const output;
-    std::optional<std::fstream> m_debugOutput;
     std::chrono::nanoseconds lastPresentationTimestamp = std::chrono::nanoseconds::zero();
     std::chrono::nanoseconds nextPresentationTimestamp = std::chrono::nanoseconds::zero();
     bool wasTripleBuffering = false;
     int doubleBufferingCounter = 0;
     QTimer compositeTimer;
     RenderJournal renderJournal;
+    FrameTelemetry telemetry;
+    std::optional<std::chrono::nanoseconds> damageTimestamp;
     int refreshRate = 60000;
     int pendingFrameCount = 0;
     int inhibitCount = 0;
@@ -57,6 +61,13 @@ public:
     int maxPendingFrameCount = 1;
 
     QTimer delayedVrrTimer;
+
+    /**
+     * Returns the current time of the monotonic clock. Tests replace it to control time.
+     */
+    std::function<std::chrono::nanoseconds()> clock = []() {
+        return std::chrono::nanoseconds(std::chrono::steady_clock::now().time_since_epoch());
+    };
 };
 
 } // namespace KWin
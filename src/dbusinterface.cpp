@@ -15,8 +15,10 @@
 
 // kwin
 #include "compositor.h"
+#include "core/frametelemetry.h"
 #include "core/output.h"
 #include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "debug_console.h"
 #include "kwinadaptor.h"
 #include "main.h"
@@ -319,6 +321,24 @@ void CompositorDBusInterface::reinitialize()
     m_compositor->reinitialize();
 }
 
+QVariantMap CompositorDBusInterface::frameTelemetry() const
+{
+    QVariantMap telemetry;
+    const auto loops = m_compositor->renderLoops();
+    for (auto it = loops.cbegin(); it != loops.cend(); ++it) {
+        telemetry.insert(it.key(), it.value()->telemetry().toVariantMap());
+    }
+    return telemetry;
+}
+
+void CompositorDBusInterface::resetFrameTelemetry()
+{
+    const auto loops = m_compositor->renderLoops();
+    for (RenderLoop *loop : loops) {
+        loop->resetTelemetry();
+    }
+}
+
 QStringList CompositorDBusInterface::supportedOpenGLPlatformInterfaces() const
 {
     QStringList interfaces;
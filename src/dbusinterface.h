@@ -170,6 +170,21 @@ public Q_SLOTS:
      */
     void reinitialize();
 
+    /**
+     * @brief Frame pacing statistics of every output, keyed by the output name.
+     *
+     * Each entry contains the render time, render time prediction error and damage to
+     * presentation latency distributions (count, mean, max, p50, p95 and p99 in microseconds)
+     * as well as the number of presented frames, dropped frames, underpredicted frames and
+     * missed vblanks.
+     */
+    QVariantMap frameTelemetry() const;
+
+    /**
+     * @brief Resets the frame pacing statistics of all outputs.
+     */
+    void resetFrameTelemetry();
+
 Q_SIGNALS:
     void compositingToggled(bool active);
 
@@ -8,7 +8,10 @@
 */
 #include "debug_console.h"
 #include "compositor.h"
+#include "core/frametelemetry.h"
 #include "core/inputdevice.h"
+#include "core/output.h"
+#include "core/renderloop.h"
 #include "effect/effecthandler.h"
 #include "input_event.h"
 #include "internalwindow.h"
@@ -45,8 +48,11 @@
 #include <QMetaProperty>
 #include <QMetaType>
 #include <QMouseEvent>
+#include <QPushButton>
 #include <QScopeGuard>
 #include <QSortFilterProxyModel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
 #include <QWindow>
 #include <QtConcurrentRun>
 
@@ -649,6 +655,7 @@ DebugConsole::DebugConsole()
     }
 
     m_ui->tabWidget->addTab(new DebugConsoleEffectsTab(), i18nc("@label", "Effects"));
+    m_ui->tabWidget->addTab(new DebugConsoleFrameTimingTab(), i18nc("@label", "Frame Timing"));
 
     connect(m_ui->quitButton, &QAbstractButton::clicked, this, &DebugConsole::deleteLater);
     connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
@@ -1652,6 +1659,86 @@ DebugConsoleEffectsTab::DebugConsoleEffectsTab(QWidget *parent)
     }
 }
 
+DebugConsoleFrameTimingTab::DebugConsoleFrameTimingTab(QWidget *parent)
+    : QWidget(parent)
+    , m_tree(new QTreeWidget(this))
+{
+    m_tree->setHeaderLabels({
+        i18nc("@title:column", "Output"),
+        i18nc("@title:column number of samples", "Count"),
+        i18nc("@title:column", "p50 (µs)"),
+        i18nc("@title:column", "p95 (µs)"),
+        i18nc("@title:column", "p99 (µs)"),
+        i18nc("@title:column", "Max (µs)"),
+    });
+
+    QPushButton *resetButton = new QPushButton(i18nc("@action:button reset frame timing statistics", "Reset"), this);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        const auto loops = Compositor::self()->renderLoops();
+        for (RenderLoop *loop : loops) {
+            loop->resetTelemetry();
+        }
+        updateTelemetry();
+    });
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_tree);
+    layout->addWidget(resetButton, 0, Qt::AlignRight);
+
+    m_updateTimer.setInterval(1000);
+    connect(&m_updateTimer, &QTimer::timeout, this, &DebugConsoleFrameTimingTab::updateTelemetry);
+}
+
+void DebugConsoleFrameTimingTab::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateTelemetry();
+    m_updateTimer.start();
+}
+
+void DebugConsoleFrameTimingTab::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_updateTimer.stop();
+}
+
+void DebugConsoleFrameTimingTab::updateTelemetry()
+{
+    auto addHistogram = [](QTreeWidgetItem *parent, const QString &name, const FrameHistogram &histogram) {
+        auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+            return QString::number(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        };
+        new QTreeWidgetItem(parent, {
+                                        name,
+                                        QString::number(histogram.count()),
+                                        toMicroseconds(histogram.percentile(50)),
+                                        toMicroseconds(histogram.percentile(95)),
+                                        toMicroseconds(histogram.percentile(99)),
+                                        toMicroseconds(histogram.max()),
+                                    });
+    };
+    auto addCounter = [](QTreeWidgetItem *parent, const QString &name, uint64_t value) {
+        new QTreeWidgetItem(parent, {name, QString::number(value)});
+    };
+
+    m_tree->clear();
+    const auto loops = Compositor::self()->renderLoops();
+    for (auto it = loops.cbegin(); it != loops.cend(); ++it) {
+        const FrameTelemetry &telemetry = it.value()->telemetry();
+        QTreeWidgetItem *outputItem = new QTreeWidgetItem(m_tree, {it.key()});
+        addHistogram(outputItem, i18nc("@item", "Render time"), telemetry.renderTime);
+        addHistogram(outputItem, i18nc("@item", "Render time prediction error"), telemetry.predictionError);
+        addHistogram(outputItem, i18nc("@item", "Damage to presentation latency"), telemetry.latency);
+        addHistogram(outputItem, i18nc("@item", "Wait for X rendering"), telemetry.syncWaitTime);
+        addCounter(outputItem, i18nc("@item", "Presented frames"), telemetry.presentedFrames);
+        addCounter(outputItem, i18nc("@item", "Dropped frames"), telemetry.droppedFrames);
+        addCounter(outputItem, i18nc("@item", "Underpredicted frames"), telemetry.underpredictedFrames);
+        addCounter(outputItem, i18nc("@item", "Missed vblanks"), telemetry.missedVblanks);
+        outputItem->setExpanded(true);
+    }
+    m_tree->resizeColumnToContents(0);
+}
+
 } // namespace KWin
 
 #include "moc_debug_console.cpp"
@@ -18,6 +18,7 @@
 #include <QList>
 #include <QListWidget>
 #include <QStyledItemDelegate>
+#include <QTimer>
 
 #include <functional>
 #include <memory>
@@ -25,6 +26,7 @@
 class QLabel;
 class QPushButton;
 class QTextEdit;
+class QTreeWidget;
 
 namespace Ui
 {
@@ -213,4 +215,22 @@ public:
     explicit DebugConsoleEffectsTab(QWidget *parent = nullptr);
 };
 
+class DebugConsoleFrameTimingTab : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DebugConsoleFrameTimingTab(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void updateTelemetry();
+
+    QTreeWidget *m_tree;
+    QTimer m_updateTimer;
+};
+
 } // namespace KWin
@@ -327,6 +327,27 @@ enum class PresentationModeHint {
 };
 Q_ENUM_NS(PresentationModeHint);
 
+/**
+ * How much work is avoided while a window can't be seen, e.g. because it is minimized, on
+ * another virtual desktop or covered by opaque windows.
+ */
+enum class ThrottlePolicy {
+    /**
+     * The window is updated as if it were visible.
+     */
+    None = 0,
+    /**
+     * The damage of the window is left in the X server and its texture is not refreshed.
+     */
+    Updates = 1,
+    /**
+     * Additionally, the client is not told that its frames have been drawn and a window that
+     * is not shown is marked hidden, so the client can stop drawing.
+     */
+    Suspend = 2,
+};
+Q_ENUM_NS(ThrottlePolicy);
+
 // For now, keep in sync with NETWM::WindowType from KWindowSystem
 enum class WindowType {
     /**
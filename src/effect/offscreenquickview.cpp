@@ -32,6 +32,8 @@
 #include <QTimer>
 #include <private/qeventpoint_p.h> // for QMutableEventPoint
 
+#include <cstring>
+
 namespace KWin
 {
 
@@ -47,9 +49,20 @@ public:
     std::unique_ptr<QTimer> m_repaintTimer;
     QImage m_image;
     std::unique_ptr<GLTexture> m_textureExport;
+    bool m_textureExportDirty = true;
     // if we should capture a QImage after rendering into our BO.
     // Used for either software QtQuick rendering and nonGL kwin rendering
     bool m_useBlit = false;
+    // whether the QtQuick context supports fences and pixel pack buffers, in which case the
+    // compositor waits for the scene on the GPU and image readbacks happen asynchronously
+    bool m_supportsSync = false;
+    GLsync m_renderFence = nullptr;
+
+    GLuint m_readbackBuffer = 0;
+    GLsync m_readbackFence = nullptr;
+    QSize m_readbackSize;
+    // picks up a readback that no later update() has picked up
+    std::unique_ptr<QTimer> m_readbackTimer;
     bool m_visible = true;
     bool m_hasAlphaChannel = true;
     bool m_automaticRepaint = true;
@@ -64,6 +77,11 @@ public:
     Qt::MouseButton lastMousePressButton = Qt::NoButton;
 
     void releaseResources();
+    void releaseSyncResources();
+
+    void startReadback();
+    bool finishReadback();
+    bool collectReadback();
 
     void updateTouchState(Qt::TouchPointState state, qint32 id, const QPointF &pos);
 };
@@ -125,6 +143,12 @@ OffscreenQuickView::OffscreenQuickView(ExportMode exportMode, bool alpha)
         d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
         d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext.get()));
         d->m_renderControl->initialize();
+        if (d->m_glcontext->isOpenGLES()) {
+            d->m_supportsSync = d->m_glcontext->format().version() >= qMakePair(3, 0);
+        } else {
+            d->m_supportsSync = d->m_glcontext->format().version() >= qMakePair(3, 2)
+                || (d->m_glcontext->hasExtension(QByteArrayLiteral("GL_ARB_sync")) && d->m_glcontext->hasExtension(QByteArrayLiteral("GL_ARB_map_buffer_range")));
+        }
         d->m_glcontext->doneCurrent();
 
         // On Wayland, contexts are implicitly shared and QOpenGLContext::globalShareContext() is null.
@@ -147,6 +171,17 @@ OffscreenQuickView::OffscreenQuickView(ExportMode exportMode, bool alpha)
     d->m_repaintTimer->setInterval(10);
 
     connect(d->m_repaintTimer.get(), &QTimer::timeout, this, &OffscreenQuickView::update);
+
+    // Give the GPU a frame to finish the readback, so picking it up doesn't stall.
+    d->m_readbackTimer = std::make_unique<QTimer>();
+    d->m_readbackTimer->setSingleShot(true);
+    d->m_readbackTimer->setInterval(16);
+    connect(d->m_readbackTimer.get(), &QTimer::timeout, this, [this]() {
+        if (d->collectReadback()) {
+            Q_EMIT repaintNeeded();
+        }
+    });
+
     connect(d->m_renderControl.get(), &QQuickRenderControl::renderRequested, this, &OffscreenQuickView::handleRenderRequested);
     connect(d->m_renderControl.get(), &QQuickRenderControl::sceneChanged, this, &OffscreenQuickView::handleSceneChanged);
 
@@ -161,6 +196,7 @@ OffscreenQuickView::~OffscreenQuickView()
     if (d->m_glcontext) {
         // close the view whilst we have an active GL context
         d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
+        d->releaseSyncResources();
     }
 
     d->m_view.reset();
@@ -223,6 +259,12 @@ void OffscreenQuickView::update()
             return;
         }
 
+        // The previous frame has had time to finish by now.
+        if (d->m_readbackFence) {
+            d->m_readbackTimer->stop();
+            d->finishReadback();
+        }
+
         qreal dpr = d->m_view->screen() ? d->m_view->screen()->devicePixelRatio() : 1.0;
         if (d->m_explicitDpr.has_value()) {
             dpr = d->m_explicitDpr.value();
@@ -230,7 +272,9 @@ void OffscreenQuickView::update()
 
         const QSize nativeSize = d->m_view->size() * dpr;
         if (!d->m_fbo || d->m_fbo->size() != nativeSize) {
-            d->m_textureExport.reset(nullptr);
+            if (!d->m_useBlit) {
+                d->m_textureExport.reset(nullptr);
+            }
 
             QOpenGLFramebufferObjectFormat fboFormat;
             fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
@@ -263,13 +307,33 @@ void OffscreenQuickView::update()
         QQuickOpenGLUtils::resetOpenGLState();
     }
 
+    // An asynchronous readback only has the new image once it's picked up.
+    bool imageReady = true;
     if (d->m_useBlit) {
-        if (usingGl) {
+        if (usingGl && d->m_supportsSync) {
+            d->startReadback();
+            if (d->m_image.isNull() || d->m_image.size() != d->m_readbackSize) {
+                // There's no image of the right size to show in the meantime.
+                d->finishReadback();
+            } else {
+                d->m_readbackTimer->start();
+                imageReady = false;
+            }
+        } else if (usingGl) {
             d->m_image = d->m_fbo->toImage();
             d->m_image.setDevicePixelRatio(d->m_view->effectiveDevicePixelRatio());
+            d->m_textureExportDirty = true;
         } else {
             d->m_image = d->m_view->grabWindow();
+            d->m_textureExportDirty = true;
+        }
+    } else if (usingGl && d->m_supportsSync) {
+        // The texture is sampled in the compositor context, let it wait for the scene on the GPU.
+        if (d->m_renderFence) {
+            glDeleteSync(d->m_renderFence);
         }
+        d->m_renderFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
     }
 
     if (usingGl) {
@@ -279,7 +343,9 @@ void OffscreenQuickView::update()
             previousContext->makeCurrent();
         }
     }
-    Q_EMIT repaintNeeded();
+    if (imageReady) {
+        Q_EMIT repaintNeeded();
+    }
 }
 
 void OffscreenQuickView::forwardMouseEvent(QEvent *e)
@@ -472,11 +538,26 @@ void OffscreenQuickView::hide()
 GLTexture *OffscreenQuickView::bufferAsTexture()
 {
     if (d->m_useBlit) {
-        d->m_textureExport = GLTexture::upload(d->m_image);
+        if (d->m_image.isNull()) {
+            return nullptr;
+        }
+        if (d->m_textureExportDirty) {
+            if (d->m_textureExport && d->m_textureExport->size() == d->m_image.size()) {
+                d->m_textureExport->update(d->m_image, QRegion(d->m_image.rect()));
+            } else {
+                d->m_textureExport = GLTexture::upload(d->m_image);
+            }
+            d->m_textureExportDirty = false;
+        }
     } else {
         if (!d->m_fbo) {
             return nullptr;
         }
+        if (d->m_renderFence) {
+            glWaitSync(d->m_renderFence, 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(d->m_renderFence);
+            d->m_renderFence = nullptr;
+        }
         if (!d->m_textureExport) {
             d->m_textureExport = GLTexture::createNonOwningWrapper(d->m_fbo->texture(), d->m_fbo->format().internalTextureFormat(), d->m_fbo->size());
         }
@@ -514,6 +595,94 @@ void OffscreenQuickView::Private::releaseResources()
     }
 }
 
+void OffscreenQuickView::Private::releaseSyncResources()
+{
+    if (m_renderFence) {
+        glDeleteSync(m_renderFence);
+        m_renderFence = nullptr;
+    }
+    if (m_readbackFence) {
+        glDeleteSync(m_readbackFence);
+        m_readbackFence = nullptr;
+    }
+    if (m_readbackBuffer) {
+        glDeleteBuffers(1, &m_readbackBuffer);
+        m_readbackBuffer = 0;
+        m_readbackSize = QSize();
+    }
+}
+
+void OffscreenQuickView::Private::startReadback()
+{
+    // A readback that hasn't been picked up yet is superseded by this one.
+    if (m_readbackFence) {
+        glDeleteSync(m_readbackFence);
+        m_readbackFence = nullptr;
+    }
+
+    const QSize size = m_fbo->size();
+    if (!m_readbackBuffer) {
+        glGenBuffers(1, &m_readbackBuffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+    if (m_readbackSize != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size.width() * size.height() * 4, nullptr, GL_STREAM_READ);
+        m_readbackSize = size;
+    }
+
+    m_fbo->bind();
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+}
+
+bool OffscreenQuickView::Private::finishReadback()
+{
+    const GLenum status = glClientWaitSync(m_readbackFence, GL_SYNC_FLUSH_COMMANDS_BIT, std::chrono::nanoseconds(std::chrono::seconds(1)).count());
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+        return false;
+    }
+    glDeleteSync(m_readbackFence);
+    m_readbackFence = nullptr;
+
+    const int stride = m_readbackSize.width() * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackBuffer);
+    const auto data = static_cast<const uchar *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, stride * m_readbackSize.height(), GL_MAP_READ_BIT));
+    if (data) {
+        // The rows are stored bottom to top.
+        QImage image(m_readbackSize, QImage::Format_RGBA8888_Premultiplied);
+        for (int y = 0; y < m_readbackSize.height(); ++y) {
+            std::memcpy(image.scanLine(m_readbackSize.height() - y - 1), data + y * stride, stride);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        image.setDevicePixelRatio(m_view->effectiveDevicePixelRatio());
+        m_image = image;
+        m_textureExportDirty = true;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+bool OffscreenQuickView::Private::collectReadback()
+{
+    if (!m_readbackFence) {
+        return false;
+    }
+    OpenGlContext *previousContext = OpenGlContext::currentContext();
+    if (!m_glcontext->makeCurrent(m_offscreenSurface.get())) {
+        return false;
+    }
+    const bool finished = finishReadback();
+    m_glcontext->doneCurrent();
+    if (previousContext) {
+        previousContext->makeCurrent();
+    }
+    return finished;
+}
+
 void OffscreenQuickView::Private::updateTouchState(Qt::TouchPointState state, qint32 id, const QPointF &pos)
 {
     // Remove the points that were previously in a released state, since they
@@ -50,7 +50,9 @@ public:
     enum class ExportMode {
         /** The contents will be available as a texture in the shared contexts. Image will be blank*/
         Texture,
-        /** The contents will be blit during the update into a QImage buffer. */
+        /** The contents will be blit during the update into a QImage buffer. If the
+         *  OpenGL context supports it, the readback is asynchronous and the image becomes
+         *  available shortly after the update, repaintNeeded() is emitted then. */
         Image
     };
 
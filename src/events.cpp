@@ -388,71 +388,18 @@ bool X11Window::windowEvent(xcb_generic_event_t *e)
         return false; // don't eat events, even our own unmanaged widgets are tracked
     }
 
+    const uint8_t eventType = e->response_type & ~0x80;
     if (findEventWindow(e) == window()) { // avoid doing stuff on frame or wrapper
+        if (eventType == XCB_PROPERTY_NOTIFY && coalescePropertyNotify(reinterpret_cast<xcb_property_notify_event_t *>(e))) {
+            return false;
+        }
+
         NET::Properties dirtyProperties;
         NET::Properties2 dirtyProperties2;
         info->event(e, &dirtyProperties, &dirtyProperties2); // pass through the NET stuff
-
-        if ((dirtyProperties & NET::WMName) != 0) {
-            fetchName();
-        }
-        if ((dirtyProperties & NET::WMIconName) != 0) {
-            fetchIconicName();
-        }
-        if ((dirtyProperties & NET::WMStrut) != 0
-            || (dirtyProperties2 & NET::WM2ExtendedStrut) != 0) {
-            workspace()->rearrange();
-        }
-        if ((dirtyProperties & NET::WMIcon) != 0) {
-            getIcons();
-        }
-        // Note there's a difference between userTime() and info->userTime()
-        // info->userTime() is the value of the property, userTime() also includes
-        // updates of the time done by KWin (ButtonPress on windowrapper etc.).
-        if ((dirtyProperties2 & NET::WM2UserTime) != 0) {
-            workspace()->setWasUserInteraction();
-            updateUserTime(info->userTime());
-        }
-        if ((dirtyProperties2 & NET::WM2StartupId) != 0) {
-            startupIdChanged();
-        }
-        if (dirtyProperties2 & NET::WM2Opacity) {
-            if (Compositor::compositing()) {
-                setOpacity(info->opacityF());
-            } else {
-                // forward to the frame if there's possibly another compositing manager running
-                NETWinInfo i(kwinApp()->x11Connection(), frameId(), kwinApp()->x11RootWindow(), NET::Properties(), NET::Properties2());
-                i.setOpacity(info->opacity());
-            }
-        }
-        if (dirtyProperties2.testFlag(NET::WM2WindowRole)) {
-            Q_EMIT windowRoleChanged();
-        }
-        if (dirtyProperties2.testFlag(NET::WM2WindowClass)) {
-            getResourceClass();
-        }
-        if (dirtyProperties2.testFlag(NET::WM2BlockCompositing)) {
-            setBlockingCompositing(info->isBlockingCompositing());
-        }
-        if (dirtyProperties2.testFlag(NET::WM2GroupLeader)) {
-            checkGroup();
-            updateAllowedActions(); // Group affects isMinimizable()
-        }
-        if (dirtyProperties2.testFlag(NET::WM2Urgency)) {
-            updateUrgency();
-        }
-        if (dirtyProperties2 & NET::WM2OpaqueRegion) {
-            getWmOpaqueRegion();
-        }
-        if (dirtyProperties2 & NET::WM2DesktopFileName) {
-            setDesktopFileName(QString::fromUtf8(info->desktopFileName()));
-        }
-        if (dirtyProperties2 & NET::WM2GTKFrameExtents) {
-            setClientFrameExtents(info->gtkFrameExtents());
-        }
+        netInfoChanged(dirtyProperties, dirtyProperties2);
     }
 
-    const uint8_t eventType = e->response_type & ~0x80;
     switch (eventType) {
     case XCB_UNMAP_NOTIFY:
         unmapNotifyEvent(reinterpret_cast<xcb_unmap_notify_event_t *>(e));
@@ -742,6 +689,134 @@ void X11Window::configureRequestEvent(xcb_configure_request_event_t *e)
     // may get XRANDR resize event before kwin), but check it's still at the bottom?
 }
 
+void X11Window::netInfoChanged(NET::Properties dirtyProperties, NET::Properties2 dirtyProperties2)
+{
+    if ((dirtyProperties & NET::WMName) != 0) {
+        fetchName();
+    }
+    if ((dirtyProperties & NET::WMIconName) != 0) {
+        fetchIconicName();
+    }
+    if ((dirtyProperties & NET::WMStrut) != 0
+        || (dirtyProperties2 & NET::WM2ExtendedStrut) != 0) {
+        workspace()->rearrange();
+    }
+    if ((dirtyProperties & NET::WMIcon) != 0) {
+        getIcons();
+    }
+    // Note there's a difference between userTime() and info->userTime()
+    // info->userTime() is the value of the property, userTime() also includes
+    // updates of the time done by KWin (ButtonPress on windowrapper etc.).
+    if ((dirtyProperties2 & NET::WM2UserTime) != 0) {
+        workspace()->setWasUserInteraction();
+        updateUserTime(info->userTime());
+    }
+    if ((dirtyProperties2 & NET::WM2StartupId) != 0) {
+        startupIdChanged();
+    }
+    if (dirtyProperties2 & NET::WM2Opacity) {
+        if (Compositor::compositing()) {
+            setOpacity(info->opacityF());
+        } else {
+            // forward to the frame if there's possibly another compositing manager running
+            NETWinInfo i(kwinApp()->x11Connection(), frameId(), kwinApp()->x11RootWindow(), NET::Properties(), NET::Properties2());
+            i.setOpacity(info->opacity());
+        }
+    }
+    if (dirtyProperties2.testFlag(NET::WM2WindowRole)) {
+        Q_EMIT windowRoleChanged();
+    }
+    if (dirtyProperties2.testFlag(NET::WM2WindowClass)) {
+        getResourceClass();
+    }
+    if (dirtyProperties2.testFlag(NET::WM2BlockCompositing)) {
+        setBlockingCompositing(info->isBlockingCompositing());
+    }
+    if (dirtyProperties2.testFlag(NET::WM2GroupLeader)) {
+        checkGroup();
+        updateAllowedActions(); // Group affects isMinimizable()
+    }
+    if (dirtyProperties2.testFlag(NET::WM2Urgency)) {
+        updateUrgency();
+    }
+    if (dirtyProperties2 & NET::WM2OpaqueRegion) {
+        getWmOpaqueRegion();
+    }
+    if (dirtyProperties2 & NET::WM2DesktopFileName) {
+        setDesktopFileName(QString::fromUtf8(info->desktopFileName()));
+    }
+    if (dirtyProperties2 & NET::WM2GTKFrameExtents) {
+        setClientFrameExtents(info->gtkFrameExtents());
+    }
+}
+
+QList<X11Window *> X11Window::s_pendingPropertyNotifyWindows;
+
+bool X11Window::coalescePropertyNotify(const xcb_property_notify_event_t *e)
+{
+    // These properties are rewritten many times per second by some applications, e.g. to show
+    // progress in the title. Only their final value within an event loop iteration matters.
+    if (e->atom != atoms->net_wm_name && e->atom != XCB_ATOM_WM_NAME
+        && e->atom != atoms->net_wm_icon_name && e->atom != XCB_ATOM_WM_ICON_NAME
+        && e->atom != atoms->net_wm_icon && e->atom != atoms->net_wm_user_time
+        && e->atom != atoms->net_wm_opaque_region) {
+        return false;
+    }
+
+    auto pending = std::find_if(m_pendingPropertyNotifies.begin(), m_pendingPropertyNotifies.end(), [e](const xcb_property_notify_event_t &event) {
+        return event.atom == e->atom;
+    });
+    if (pending != m_pendingPropertyNotifies.end()) {
+        *pending = *e;
+        return true;
+    }
+
+    m_pendingPropertyNotifies.append(*e);
+    if (m_pendingPropertyNotifies.count() == 1) {
+        if (s_pendingPropertyNotifyWindows.isEmpty()) {
+            QMetaObject::invokeMethod(workspace(), []() {
+                flushPendingPropertyNotifies();
+            }, Qt::QueuedConnection);
+        }
+        s_pendingPropertyNotifyWindows.append(this);
+    }
+    return true;
+}
+
+void X11Window::flushPendingPropertyNotifies()
+{
+    const QList<X11Window *> windows = std::exchange(s_pendingPropertyNotifyWindows, {});
+    for (X11Window *window : windows) {
+        window->flushPropertyNotifies();
+    }
+}
+
+void X11Window::flushPropertyNotifies()
+{
+    const QList<xcb_property_notify_event_t> events = std::exchange(m_pendingPropertyNotifies, {});
+    if (events.isEmpty() || isDeleted()) {
+        return;
+    }
+
+    // Let NETWinInfo read each property once and update the window once for all of them.
+    NET::Properties dirtyProperties;
+    NET::Properties2 dirtyProperties2;
+    for (xcb_property_notify_event_t event : events) {
+        if (event.atom == XCB_ATOM_WM_NAME) {
+            dirtyProperties |= NET::WMName;
+        } else if (event.atom == XCB_ATOM_WM_ICON_NAME) {
+            dirtyProperties |= NET::WMIconName;
+        } else {
+            NET::Properties properties;
+            NET::Properties2 properties2;
+            info->event(reinterpret_cast<xcb_generic_event_t *>(&event), &properties, &properties2);
+            dirtyProperties |= properties;
+            dirtyProperties2 |= properties2;
+        }
+    }
+    netInfoChanged(dirtyProperties, dirtyProperties2);
+}
+
 /**
  * Handles property changes of the client window
  */
@@ -787,6 +862,8 @@ void X11Window::propertyNotifyEvent(xcb_property_notify_event_t *e)
             updateShadow();
         } else if (e->atom == atoms->kde_skip_close_animation) {
             getSkipCloseAnimation();
+        } else if (e->atom == atoms->kde_net_wm_tearing_control) {
+            getTearingControl();
         }
         break;
     }
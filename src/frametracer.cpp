@@ -0,0 +1,289 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "frametracer.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <time.h>
+
+namespace KWin
+{
+KWIN_SINGLETON_FACTORY(KWin::FrameTracer)
+
+std::atomic<bool> FrameTracer::s_enabled = false;
+std::atomic<bool> FrameTracer::s_threadTimeEnabled = false;
+std::atomic<uint64_t> FrameTracer::s_generation = 0;
+
+// The number of slices the current thread has begun and not ended yet.
+static thread_local int t_sliceDepth = 0;
+
+FrameTraceRing::FrameTraceRing(int threadId)
+    : m_threadId(threadId)
+{
+}
+
+std::vector<FrameTraceEvent> FrameTraceRing::snapshot() const
+{
+    // The owning thread may keep writing while the snapshot is taken, so the oldest events
+    // may be overwritten while they are being copied. Check how far the owning thread has
+    // got afterwards and drop the events whose slots may have been reused in the meantime.
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    const uint64_t tail = std::max(m_tail.load(std::memory_order_relaxed), head > Capacity ? head - Capacity : 0);
+
+    std::vector<FrameTraceEvent> events;
+    events.reserve(head - tail);
+    for (uint64_t i = tail; i < head; ++i) {
+        const Slot &slot = m_slots[i % Capacity];
+        events.push_back(FrameTraceEvent{
+            .timestamp = std::chrono::nanoseconds(slot.timestamp.load(std::memory_order_relaxed)),
+            .name = slot.name.load(std::memory_order_relaxed),
+            .value = slot.value.load(std::memory_order_relaxed),
+            .type = slot.type.load(std::memory_order_relaxed),
+        });
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reserved = m_reserved.load(std::memory_order_relaxed);
+    const uint64_t firstIntact = reserved > Capacity ? reserved - Capacity : 0;
+    if (firstIntact > tail) {
+        events.erase(events.begin(), events.begin() + std::min(firstIntact - tail, head - tail));
+    }
+    return events;
+}
+
+void FrameTraceRing::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+int FrameTraceRing::threadId() const
+{
+    return m_threadId;
+}
+
+QString FrameTraceRing::threadName() const
+{
+    return m_threadName;
+}
+
+void FrameTraceRing::setThreadName(const QString &name)
+{
+    m_threadName = name;
+}
+
+FrameTracer::FrameTracer(QObject *parent)
+    : QObject(parent)
+{
+    s_generation++;
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/FrameTracer"), this, QDBusConnection::ExportScriptableContents);
+    if (qEnvironmentVariableIsSet("KWIN_FRAME_TRACE")) {
+        setEnabled(true);
+    }
+}
+
+FrameTracer::~FrameTracer()
+{
+    s_enabled = false;
+    s_self = nullptr;
+}
+
+void FrameTracer::setEnabled(bool enabled)
+{
+    if (s_enabled.exchange(enabled) != enabled) {
+        Q_EMIT enabledChanged();
+    }
+}
+
+void FrameTracer::setThreadTimeEnabled(bool enabled)
+{
+    s_threadTimeEnabled = enabled;
+}
+
+static int64_t threadCpuTime()
+{
+    if (!FrameTracer::isThreadTimeEnabled()) {
+        return 0;
+    }
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::nanoseconds(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)).count();
+}
+
+void FrameTracer::beginSlice(const char *name)
+{
+    t_sliceDepth++;
+    record(FrameTraceEvent::Type::Begin, name, threadCpuTime());
+}
+
+void FrameTracer::endSlice(const char *name)
+{
+    record(FrameTraceEvent::Type::End, name, threadCpuTime());
+    t_sliceDepth--;
+}
+
+bool FrameTracer::isInSlice()
+{
+    return t_sliceDepth > 0;
+}
+
+// Hands the ring of an exiting thread back to the tracer, so thread pools don't grow the
+// number of rings without bounds.
+struct FrameTraceRingHolder
+{
+    ~FrameTraceRingHolder()
+    {
+        if (ring && generation == FrameTracer::s_generation.load(std::memory_order_relaxed) && FrameTracer::self()) {
+            FrameTracer::self()->retireRing(ring);
+        }
+    }
+
+    uint64_t generation = 0;
+    FrameTraceRing *ring = nullptr;
+};
+
+FrameTraceRing *FrameTracer::threadRing()
+{
+    static thread_local FrameTraceRingHolder holder;
+    const uint64_t generation = s_generation.load(std::memory_order_relaxed);
+    if (Q_UNLIKELY(holder.generation != generation)) {
+        // The ring the thread used before has been destroyed along with the tracer that owned it.
+        holder.generation = generation;
+        holder.ring = nullptr;
+    }
+    if (Q_UNLIKELY(!holder.ring) && s_self) {
+        holder.ring = s_self->acquireRing();
+    }
+    return holder.ring;
+}
+
+FrameTraceRing *FrameTracer::acquireRing()
+{
+    QMutexLocker lock(&m_mutex);
+
+    const QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if (name.isEmpty()) {
+        name = thread == QCoreApplication::instance()->thread() ? QStringLiteral("Main thread") : QStringLiteral("Thread %1").arg(m_rings.size());
+    }
+
+    for (const auto &ring : m_rings) {
+        if (ring->m_retired) {
+            ring->m_retired = false;
+            ring->clear();
+            ring->setThreadName(name);
+            return ring.get();
+        }
+    }
+
+    auto ring = std::make_unique<FrameTraceRing>(m_rings.size() + 1);
+    ring->setThreadName(name);
+    m_rings.push_back(std::move(ring));
+    return m_rings.back().get();
+}
+
+void FrameTracer::retireRing(FrameTraceRing *ring)
+{
+    QMutexLocker lock(&m_mutex);
+    ring->m_retired = true;
+}
+
+void FrameTracer::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    for (const auto &ring : m_rings) {
+        ring->clear();
+    }
+}
+
+QByteArray FrameTracer::chromeTrace() const
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    auto toMicroseconds = [](std::chrono::nanoseconds timestamp) {
+        return std::chrono::duration<double, std::micro>(timestamp).count();
+    };
+
+    QJsonArray traceEvents;
+
+    QMutexLocker lock(&m_mutex);
+    for (const auto &ring : m_rings) {
+        traceEvents.append(QJsonObject{
+            {QStringLiteral("name"), QStringLiteral("thread_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("tid"), ring->threadId()},
+            {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), ring->threadName()}}},
+        });
+
+        const std::vector<FrameTraceEvent> events = ring->snapshot();
+        for (const FrameTraceEvent &event : events) {
+            QJsonObject object{
+                {QStringLiteral("name"), QString::fromLatin1(event.name)},
+                {QStringLiteral("ts"), toMicroseconds(event.timestamp)},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), ring->threadId()},
+            };
+            switch (event.type) {
+            case FrameTraceEvent::Type::Begin:
+            case FrameTraceEvent::Type::End:
+                object[QStringLiteral("ph")] = event.type == FrameTraceEvent::Type::Begin ? QStringLiteral("B") : QStringLiteral("E");
+                if (event.value) {
+                    object[QStringLiteral("tts")] = toMicroseconds(std::chrono::nanoseconds(event.value));
+                }
+                break;
+            case FrameTraceEvent::Type::Counter:
+                object[QStringLiteral("ph")] = QStringLiteral("C");
+                object[QStringLiteral("args")] = QJsonObject{{QStringLiteral("value"), qint64(event.value)}};
+                break;
+            case FrameTraceEvent::Type::Instant:
+                object[QStringLiteral("ph")] = QStringLiteral("i");
+                object[QStringLiteral("s")] = QStringLiteral("t");
+                break;
+            case FrameTraceEvent::Type::FlowBegin:
+                object[QStringLiteral("ph")] = QStringLiteral("s");
+                object[QStringLiteral("id")] = qint64(event.value);
+                break;
+            case FrameTraceEvent::Type::FlowEnd:
+                object[QStringLiteral("ph")] = QStringLiteral("f");
+                object[QStringLiteral("bp")] = QStringLiteral("e");
+                object[QStringLiteral("id")] = qint64(event.value);
+                break;
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    const QJsonObject trace{
+        {QStringLiteral("traceEvents"), traceEvents},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")},
+    };
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool FrameTracer::dumpChromeTrace(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open" << fileName << "for writing the frame trace:" << file.errorString();
+        return false;
+    }
+    file.write(chromeTrace());
+    return true;
+}
+
+}
+
+#include "moc_frametracer.cpp"
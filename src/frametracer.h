@@ -0,0 +1,255 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "effect/globals.h"
+
+#include <QMutex>
+#include <QObject>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace KWin
+{
+
+/**
+ * A single binary event recorded by the FrameTracer. The name must point to a string with
+ * static storage duration, it is not copied. The value of slice events is the CPU time of the
+ * thread in nanoseconds, or 0 if it isn't recorded.
+ */
+struct FrameTraceEvent
+{
+    enum class Type : uint8_t {
+        Begin,
+        End,
+        Counter,
+        Instant,
+        FlowBegin,
+        FlowEnd,
+    };
+
+    std::chrono::nanoseconds timestamp;
+    const char *name;
+    int64_t value;
+    Type type;
+};
+
+/**
+ * A fixed-size ring buffer of trace events owned by a single thread. Only the owning thread
+ * writes to the ring, so recording an event needs neither a lock nor a read-modify-write
+ * atomic operation. When the ring is full, the oldest events are overwritten.
+ *
+ * Readers on other threads use the reserved index as a sequence counter. It is advanced before
+ * an event is written, so a reader can tell which of the events it copied may have been
+ * overwritten in the meantime.
+ */
+class KWIN_EXPORT FrameTraceRing
+{
+public:
+    static constexpr size_t Capacity = 1 << 14;
+
+    explicit FrameTraceRing(int threadId);
+
+    void record(FrameTraceEvent::Type type, const char *name, int64_t value)
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_reserved.store(head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot &slot = m_slots[head % Capacity];
+        slot.timestamp.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.type.store(type, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Returns the events currently in the ring, oldest first.
+     */
+    std::vector<FrameTraceEvent> snapshot() const;
+    void clear();
+
+    int threadId() const;
+    QString threadName() const;
+    void setThreadName(const QString &name);
+
+private:
+    // The fields are atomic because readers may copy a slot while it's being overwritten,
+    // such copies are dropped afterwards.
+    struct Slot
+    {
+        std::atomic<std::chrono::nanoseconds::rep> timestamp;
+        std::atomic<const char *> name;
+        std::atomic<int64_t> value;
+        std::atomic<FrameTraceEvent::Type> type;
+    };
+
+    std::array<Slot, Capacity> m_slots;
+    std::atomic<uint64_t> m_head = 0;
+    std::atomic<uint64_t> m_reserved = 0;
+    std::atomic<uint64_t> m_tail = 0;
+    const int m_threadId;
+    QString m_threadName;
+    bool m_retired = false;
+    friend class FrameTracer;
+};
+
+/**
+ * FrameTracer records what the compositor does in each frame into per-thread ring buffers,
+ * and exports the recording in the Chrome trace event format, which can be loaded in
+ * Perfetto or chrome://tracing.
+ *
+ * Unlike FTraceLogger, events are binary and are not formatted when they are recorded, and
+ * a disabled tracer costs a single relaxed atomic load per trace point.
+ *
+ * Usage: Either:
+ *  Set the KWIN_FRAME_TRACE environment variable before starting the application
+ *  Calling on DBus /FrameTracer org.kde.kwin.FrameTracer.setEnabled true
+ * Then call org.kde.kwin.FrameTracer.dumpChromeTrace with a file name to save the recording.
+ */
+class KWIN_EXPORT FrameTracer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.FrameTracer")
+    Q_PROPERTY(bool isEnabled READ isEnabled NOTIFY enabledChanged)
+
+public:
+    ~FrameTracer() override;
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Whether slices also record the CPU time of their thread, which is exported as the thread
+     * timestamp of the slice. This costs a system call per slice, so it's off by default.
+     */
+    static bool isThreadTimeEnabled()
+    {
+        return s_threadTimeEnabled.load(std::memory_order_relaxed);
+    }
+    static void setThreadTimeEnabled(bool enabled);
+
+    static void record(FrameTraceEvent::Type type, const char *name, int64_t value = 0)
+    {
+        if (FrameTraceRing *ring = threadRing()) {
+            ring->record(type, name, value);
+        }
+    }
+    static void beginSlice(const char *name);
+    static void endSlice(const char *name);
+    /**
+     * Returns @c true if the calling thread is inside a slice. This never allocates, so it can
+     * be called from allocation hooks.
+     */
+    static bool isInSlice();
+
+    /**
+     * Returns the recorded events in the Chrome trace event JSON format.
+     */
+    QByteArray chromeTrace() const;
+
+Q_SIGNALS:
+    void enabledChanged();
+
+public Q_SLOTS:
+    Q_SCRIPTABLE void setEnabled(bool enabled);
+    Q_SCRIPTABLE bool dumpChromeTrace(const QString &fileName);
+    Q_SCRIPTABLE void clear();
+
+private:
+    static FrameTraceRing *threadRing();
+    FrameTraceRing *acquireRing();
+    void retireRing(FrameTraceRing *ring);
+
+    static std::atomic<bool> s_enabled;
+    static std::atomic<bool> s_threadTimeEnabled;
+    // Incremented whenever a tracer is created, rings of an older tracer are gone.
+    static std::atomic<uint64_t> s_generation;
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<FrameTraceRing>> m_rings;
+    friend struct FrameTraceRingHolder;
+    KWIN_SINGLETON(FrameTracer)
+};
+
+class FrameTraceScope
+{
+public:
+    explicit FrameTraceScope(const char *name)
+        : m_name(FrameTracer::isEnabled() ? name : nullptr)
+    {
+        if (Q_UNLIKELY(m_name)) {
+            FrameTracer::beginSlice(m_name);
+        }
+    }
+
+    ~FrameTraceScope()
+    {
+        if (Q_UNLIKELY(m_name)) {
+            FrameTracer::endSlice(m_name);
+        }
+    }
+
+private:
+    const char *m_name;
+};
+
+} // namespace KWin
+
+#define KWIN_FRAME_TRACE_CONCAT_IMPL(a, b) a##b
+#define KWIN_FRAME_TRACE_CONCAT(a, b) KWIN_FRAME_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * Records a slice that lasts until the end of the enclosing block. @a name must be a string literal.
+ */
+#define frameTraceScope(name) \
+    const KWin::FrameTraceScope KWIN_FRAME_TRACE_CONCAT(_frameTraceScope, __LINE__)(name)
+
+/**
+ * Records the current @a value of the counter @a name.
+ */
+#define frameTraceCounter(name, value)                                                                              \
+    do {                                                                                                            \
+        if (Q_UNLIKELY(KWin::FrameTracer::isEnabled())) {                                                           \
+            KWin::FrameTracer::record(KWin::FrameTraceEvent::Type::Counter, name, static_cast<int64_t>(value));     \
+        }                                                                                                           \
+    } while (0)
+
+/**
+ * Records an instantaneous event.
+ */
+#define frameTraceInstant(name)                                                        \
+    do {                                                                               \
+        if (Q_UNLIKELY(KWin::FrameTracer::isEnabled())) {                              \
+            KWin::FrameTracer::record(KWin::FrameTraceEvent::Type::Instant, name);     \
+        }                                                                              \
+    } while (0)
+
+/**
+ * Starts and terminates a flow, which connects related slices, possibly on different threads.
+ * Both ends of the flow must use the same @a id.
+ */
+#define frameTraceFlowBegin(name, id)                                                                              \
+    do {                                                                                                           \
+        if (Q_UNLIKELY(KWin::FrameTracer::isEnabled())) {                                                          \
+            KWin::FrameTracer::record(KWin::FrameTraceEvent::Type::FlowBegin, name, static_cast<int64_t>(id));     \
+        }                                                                                                          \
+    } while (0)
+#define frameTraceFlowEnd(name, id)                                                                              \
+    do {                                                                                                         \
+        if (Q_UNLIKELY(KWin::FrameTracer::isEnabled())) {                                                        \
+            KWin::FrameTracer::record(KWin::FrameTraceEvent::Type::FlowEnd, name, static_cast<int64_t>(id));     \
+        }                                                                                                        \
+    } while (0)
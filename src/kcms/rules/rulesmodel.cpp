@@ -722,6 +722,24 @@ void RulesModel::populateRuleList()
                          RulePolicy::ForceRule, RuleItem::Boolean,
                          i18n("Allow tearing"), i18n("Appearance & Fixes"),
                          QIcon::fromTheme("monitor-symbolic")));
+
+    auto throttling = addRule(new RuleItem(QLatin1String("throttling"),
+                                           RulePolicy::ForceRule, RuleItem::Option,
+                                           i18n("Throttle when invisible"), i18n("Appearance & Fixes"),
+                                           QIcon::fromTheme("media-playback-pause"),
+                                           xi18nc("@info:tooltip", "Controls how much work is saved while the window can't be seen because "
+                                                                   "it is minimized, on another virtual desktop or covered by other windows."
+                                                                   "<nl/><nl/>"
+                                                                   "<list>"
+                                                                   "<item><emphasis strong='true'>None:</emphasis> The window is updated as if it "
+                                                                   "were visible.</item>"
+                                                                   "<item><emphasis strong='true'>Stop updates:</emphasis> The contents of the window "
+                                                                   "are only updated once it becomes visible again.</item>"
+                                                                   "<item><emphasis strong='true'>Suspend:</emphasis> Additionally, the app is told that "
+                                                                   "the window is hidden, so it can stop drawing. Use this for apps like video players "
+                                                                   "or web browsers.</item>"
+                                                                   "</list>")));
+    throttling->setOptionsData(throttlingModelData());
 }
 
 const QHash<QString, QString> RulesModel::x11PropertyHash()
@@ -895,6 +913,15 @@ QList<OptionsModel::Data> RulesModel::focusModelData() const
     return modelData;
 }
 
+QList<OptionsModel::Data> RulesModel::throttlingModelData() const
+{
+    static const auto modelData = QList<OptionsModel::Data>{
+        {int(ThrottlePolicy::None), i18n("None")},
+        {int(ThrottlePolicy::Updates), i18n("Stop updates")},
+        {int(ThrottlePolicy::Suspend), i18n("Suspend")}};
+    return modelData;
+}
+
 QList<OptionsModel::Data> RulesModel::colorSchemesModelData() const
 {
     QList<OptionsModel::Data> modelData;
@@ -101,6 +101,7 @@ private:
     QList<OptionsModel::Data> activitiesModelData() const;
     QList<OptionsModel::Data> placementModelData() const;
     QList<OptionsModel::Data> focusModelData() const;
+    QList<OptionsModel::Data> throttlingModelData() const;
     QList<OptionsModel::Data> colorSchemesModelData() const;
     QList<OptionsModel::Data> layerModelData() const;
 
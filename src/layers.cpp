@@ -187,37 +187,46 @@ void Workspace::propagateWindows(bool propagate_new_windows)
         }
         newWindowStack << window->frameId();
     }
-    // TODO isn't it too inefficient to restack always all windows?
     // TODO don't restack not visible windows?
     Q_ASSERT(newWindowStack.at(0) == rootInfo()->supportWindow());
-    Xcb::restackWindows(newWindowStack);
+    Xcb::restackWindows(newWindowStack, m_x11WindowStack);
+    m_x11WindowStack = newWindowStack;
 
-    QList<xcb_window_t> cl;
+    // Only rewrite the root window properties if they have changed, every change wakes up
+    // all pagers and taskbars.
     if (propagate_new_windows) {
-        cl.reserve(manual_overlays.size() + m_windows.size());
+        QList<xcb_window_t> clientList;
+        clientList.reserve(manual_overlays.size() + m_windows.size());
         for (const auto win : std::as_const(manual_overlays)) {
-            cl.push_back(win);
+            clientList.push_back(win);
         }
         for (Window *window : std::as_const(m_windows)) {
             X11Window *x11Window = qobject_cast<X11Window *>(window);
             if (x11Window && !x11Window->isUnmanaged()) {
-                cl.push_back(x11Window->window());
+                clientList.push_back(x11Window->window());
             }
         }
-        rootInfo()->setClientList(cl.constData(), cl.size());
+        if (clientList != m_x11ClientList) {
+            rootInfo()->setClientList(clientList.constData(), clientList.size());
+            m_x11ClientList = clientList;
+        }
     }
 
-    cl.clear();
+    QList<xcb_window_t> clientListStacking;
+    clientListStacking.reserve(stacking_order.size() + manual_overlays.size());
     for (auto it = stacking_order.constBegin(); it != stacking_order.constEnd(); ++it) {
         X11Window *window = qobject_cast<X11Window *>(*it);
         if (window && !window->isDeleted() && !window->isUnmanaged()) {
-            cl.push_back(window->window());
+            clientListStacking.push_back(window->window());
         }
     }
     for (const auto win : std::as_const(manual_overlays)) {
-        cl.push_back(win);
+        clientListStacking.push_back(win);
+    }
+    if (clientListStacking != m_x11ClientListStacking) {
+        rootInfo()->setClientListStacking(clientListStacking.constData(), clientListStacking.size());
+        m_x11ClientListStacking = clientListStacking;
     }
-    rootInfo()->setClientListStacking(cl.constData(), cl.size());
 }
 #endif
 
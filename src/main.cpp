@@ -22,6 +22,7 @@
 #include "cursor.h"
 #include "cursorsource.h"
 #include "effect/effecthandler.h"
+#include "frametracer.h"
 #include "input.h"
 #include "inputmethod.h"
 #include "opengl/gltexture.h"
@@ -40,6 +41,7 @@
 #if KWIN_BUILD_X11
 #include "utils/xcbutils.h"
 #include "x11eventfilter.h"
+#include "x11window.h"
 #endif
 
 #if KWIN_BUILD_SCREENLOCKER
@@ -456,6 +458,7 @@ bool Application::dispatchEvent(xcb_generic_event_t *event)
                                                  QByteArrayLiteral("BadImplementation"),
                                                  QByteArrayLiteral("Unknown")});
 
+    frameTraceScope("X11 event dispatch");
     kwinApp()->updateX11Time(event);
 
     const uint8_t x11EventType = event->response_type & ~0x80;
@@ -489,6 +492,11 @@ bool Application::dispatchEvent(xcb_generic_event_t *event)
         return false;
     }
 
+    // Coalesced property changes happened before this event, so event filters must see them first.
+    if (x11EventType != XCB_PROPERTY_NOTIFY) {
+        X11Window::flushPendingPropertyNotifies();
+    }
+
     if (x11EventType == XCB_GE_GENERIC) {
         xcb_ge_generic_event_t *ge = reinterpret_cast<xcb_ge_generic_event_t *>(event);
 
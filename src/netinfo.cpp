@@ -11,6 +11,7 @@
 // own
 #include "netinfo.h"
 // kwin
+#include "atoms.h"
 #include "rootinfo_filter.h"
 #include "virtualdesktops.h"
 #include "workspace.h"
@@ -135,6 +136,25 @@ RootInfo::RootInfo(xcb_window_t w, const char *name, NET::Properties properties,
     , m_activeWindow(activeWindow())
     , m_eventFilter(std::make_unique<RootInfoFilter>(this))
 {
+    // NETRootInfo doesn't know about the extended frame synchronization protocol.
+    addSupportedAtoms({atoms->net_wm_frame_drawn, atoms->net_wm_frame_timings});
+}
+
+void RootInfo::addSupportedAtoms(const QList<xcb_atom_t> &extraAtoms)
+{
+    // Merge the atoms into the list NETRootInfo has written, it's replaced as a whole whenever
+    // NETRootInfo updates it, so appending to it could leave duplicates behind.
+    Xcb::Property property(false, rootWindow(), atoms->net_supported, XCB_ATOM_ATOM, 0, 4096);
+    const QByteArray data = property.toByteArray(32, XCB_ATOM_ATOM);
+    const auto begin = reinterpret_cast<const xcb_atom_t *>(data.constData());
+    QList<xcb_atom_t> supported(begin, begin + data.size() / sizeof(xcb_atom_t));
+    for (xcb_atom_t atom : extraAtoms) {
+        if (!supported.contains(atom)) {
+            supported.append(atom);
+        }
+    }
+    xcb_change_property(kwinApp()->x11Connection(), XCB_PROP_MODE_REPLACE, rootWindow(),
+                        atoms->net_supported, XCB_ATOM_ATOM, 32, supported.size(), supported.constData());
 }
 
 void RootInfo::changeNumberOfDesktops(int n)
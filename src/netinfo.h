@@ -18,6 +18,7 @@
 #endif
 
 #include <NETWM>
+#include <QList>
 
 #include <memory>
 #include <xcb/xcb.h>
@@ -55,6 +56,8 @@ protected:
     void changeShowingDesktop(bool showing) override;
 
 private:
+    void addSupportedAtoms(const QList<xcb_atom_t> &extraAtoms);
+
     static std::unique_ptr<RootInfo> s_self;
     friend RootInfo *rootInfo();
 
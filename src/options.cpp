@@ -649,6 +649,20 @@ void Options::setAllowTearing(bool allow)
     }
 }
 
+int Options::thumbnailMaxFrameRate() const
+{
+    return m_thumbnailMaxFrameRate;
+}
+
+void Options::setThumbnailMaxFrameRate(int rate)
+{
+    rate = std::max(rate, 0);
+    if (rate != m_thumbnailMaxFrameRate) {
+        m_thumbnailMaxFrameRate = rate;
+        Q_EMIT thumbnailMaxFrameRateChanged();
+    }
+}
+
 bool Options::interactiveWindowMoveEnabled() const
 {
     return m_interactiveWindowMoveEnabled;
@@ -867,6 +881,7 @@ void Options::syncFromKcfgc()
     setElectricBorderCornerRatio(m_settings->electricBorderCornerRatio());
     setWindowsBlockCompositing(m_settings->windowsBlockCompositing());
     setAllowTearing(m_settings->allowTearing());
+    setThumbnailMaxFrameRate(m_settings->thumbnailMaxFrameRate());
     setInteractiveWindowMoveEnabled(m_settings->interactiveWindowMoveEnabled());
     setDoubleClickBorderToMaximize(m_settings->doubleClickBorderToMaximize());
 }
@@ -202,6 +202,10 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(KWin::OpenGLPlatformInterface glPlatformInterface READ glPlatformInterface WRITE setGlPlatformInterface NOTIFY glPlatformInterfaceChanged)
     Q_PROPERTY(bool windowsBlockCompositing READ windowsBlockCompositing WRITE setWindowsBlockCompositing NOTIFY windowsBlockCompositingChanged)
     Q_PROPERTY(bool allowTearing READ allowTearing WRITE setAllowTearing NOTIFY allowTearingChanged)
+    /**
+     * The maximum rate, in Hz, at which a window thumbnail is re-rendered. 0 means unlimited.
+     */
+    Q_PROPERTY(int thumbnailMaxFrameRate READ thumbnailMaxFrameRate WRITE setThumbnailMaxFrameRate NOTIFY thumbnailMaxFrameRateChanged)
     Q_PROPERTY(bool interactiveWindowMoveEnabled READ interactiveWindowMoveEnabled WRITE setInteractiveWindowMoveEnabled NOTIFY interactiveWindowMoveEnabledChanged)
 public:
     explicit Options(QObject *parent = nullptr);
@@ -703,6 +707,7 @@ public:
     }
 
     bool allowTearing() const;
+    int thumbnailMaxFrameRate() const;
     bool interactiveWindowMoveEnabled() const;
 
     // setters
@@ -764,6 +769,7 @@ public:
     void setGlPlatformInterface(OpenGLPlatformInterface interface);
     void setWindowsBlockCompositing(bool set);
     void setAllowTearing(bool allow);
+    void setThumbnailMaxFrameRate(int rate);
     void setInteractiveWindowMoveEnabled(bool set);
 
     // default values
@@ -969,6 +975,7 @@ Q_SIGNALS:
     void animationSpeedChanged();
     void configChanged();
     void allowTearingChanged();
+    void thumbnailMaxFrameRateChanged();
     void interactiveWindowMoveEnabledChanged();
 
 private:
@@ -1043,6 +1050,7 @@ private:
     bool condensed_title;
 
     bool m_allowTearing = true;
+    int m_thumbnailMaxFrameRate = 30;
     bool m_interactiveWindowMoveEnabled = true;
     bool m_doubleClickBorderToMaximize = true;
 
@@ -7,7 +7,10 @@
 
 #include "expolayout.h"
 
+#include <QCoreApplication>
 #include <QQmlProperty>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <cmath>
 #include <deque>
 #include <tuple>
@@ -144,6 +147,7 @@ void ExpoCell::setPartialActivationFactor(qreal factor)
 void ExpoCell::updateLayout()
 {
     if (m_layout) {
+        m_layout->cancelPendingLayout();
         m_layout->polish();
     }
 }
@@ -295,11 +299,42 @@ void ExpoCell::updateContentItemGeometry()
     m_contentItem->setSize(rect.size());
 }
 
+size_t qHash(const ExpoLayout::LayoutKey &key, size_t seed)
+{
+    const ExpoLayout::LayoutParameters &parameters = key.parameters;
+    seed = qHashMulti(seed, key.areaSize.width(), key.areaSize.height(), uint(parameters.placementMode),
+                      parameters.searchTolerance, parameters.idealWidthRatio,
+                      parameters.relativeMarginLeft, parameters.relativeMarginRight,
+                      parameters.relativeMarginTop, parameters.relativeMarginBottom,
+                      parameters.relativeMinLength, parameters.maxGapRatio, parameters.maxScale);
+    for (const QRectF &windowSize : key.windowSizes) {
+        seed = qHashMulti(seed, windowSize.x(), windowSize.y(), windowSize.width(), windowSize.height());
+    }
+    return seed;
+}
+
+static QThreadPool *layoutPool()
+{
+    // A single thread is enough, only the most recent layout request is of interest.
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool(QCoreApplication::instance());
+        pool->setObjectName(QStringLiteral("ExpoLayout"));
+        pool->setMaxThreadCount(1);
+        return pool;
+    }();
+    return pool;
+}
+
 ExpoLayout::ExpoLayout(QQuickItem *parent)
     : QQuickItem(parent)
 {
 }
 
+ExpoLayout::~ExpoLayout()
+{
+    cancelPendingLayout();
+}
+
 ExpoLayout::PlacementMode ExpoLayout::placementMode() const
 {
     return m_placementMode;
@@ -329,7 +364,7 @@ void ExpoLayout::setReady()
 
 void ExpoLayout::forceLayout()
 {
-    updatePolish();
+    relayout(true);
 }
 
 void ExpoLayout::updateCellsMapping()
@@ -343,12 +378,14 @@ void ExpoLayout::addCell(ExpoCell *cell)
 {
     Q_ASSERT(!m_cells.contains(cell));
     m_cells.append(cell);
+    cancelPendingLayout();
     polish();
 }
 
 void ExpoLayout::removeCell(ExpoCell *cell)
 {
     m_cells.removeOne(cell);
+    cancelPendingLayout();
     polish();
 }
 
@@ -371,6 +408,39 @@ static void moveToFit(QRectF &rect, const QRectF &area)
 
 void ExpoLayout::updatePolish()
 {
+    relayout(!m_ready || m_cells.size() < AsynchronousLayoutThreshold);
+}
+
+ExpoLayout::LayoutParameters ExpoLayout::parameters() const
+{
+    return LayoutParameters{
+        .placementMode = m_placementMode,
+        .searchTolerance = m_searchTolerance,
+        .idealWidthRatio = m_idealWidthRatio,
+        .relativeMarginLeft = m_relativeMarginLeft,
+        .relativeMarginRight = m_relativeMarginRight,
+        .relativeMarginTop = m_relativeMarginTop,
+        .relativeMarginBottom = m_relativeMarginBottom,
+        .relativeMinLength = m_relativeMinLength,
+        .maxGapRatio = m_maxGapRatio,
+        .maxScale = m_maxScale,
+    };
+}
+
+void ExpoLayout::cancelPendingLayout()
+{
+    // A layout that has been computed for outdated cells or cell geometries must not be applied.
+    m_generation++;
+    if (m_pendingLayout) {
+        m_pendingLayout->cancel();
+        m_pendingLayout = nullptr;
+    }
+}
+
+void ExpoLayout::relayout(bool synchronous)
+{
+    cancelPendingLayout();
+
     if (m_cells.isEmpty()) {
         setReady();
         return;
@@ -398,7 +468,45 @@ void ExpoLayout::updatePolish()
         const QMarginsF scaledMargins(margins.left() / scale, margins.top() / scale, margins.right() / scale, margins.bottom() / scale);
         windowSizes.emplace_back(cell->naturalRect().marginsAdded(scaledMargins));
     }
-    auto windowLayouts = ExpoLayout::layout(area, windowSizes);
+
+    // Typing in the search field of the overview filters the windows back and forth between
+    // the same few sets, so recently computed layouts are kept.
+    LayoutKey key{
+        .areaSize = area.size(),
+        .parameters = parameters(),
+        .windowSizes = windowSizes,
+    };
+    if (const QList<QRectF> *windowLayouts = m_layoutCache.object(key)) {
+        applyLayout(*windowLayouts);
+        return;
+    }
+
+    if (synchronous) {
+        const QList<QRectF> windowLayouts = layout(area, windowSizes, key.parameters);
+        m_layoutCache.insert(key, new QList<QRectF>(windowLayouts));
+        applyLayout(windowLayouts);
+        return;
+    }
+
+    auto watcher = new QFutureWatcher<QList<QRectF>>(this);
+    connect(watcher, &QFutureWatcher<QList<QRectF>>::finished, this, [this, watcher, key, generation = m_generation]() {
+        watcher->deleteLater();
+        if (generation != m_generation || watcher->isCanceled()) {
+            return;
+        }
+        m_pendingLayout = nullptr;
+        const QList<QRectF> windowLayouts = watcher->result();
+        m_layoutCache.insert(key, new QList<QRectF>(windowLayouts));
+        applyLayout(windowLayouts);
+    });
+    watcher->setFuture(QtConcurrent::run(layoutPool(), [area, windowSizes = std::move(windowSizes), parameters = key.parameters]() {
+        return layout(area, windowSizes, parameters);
+    }));
+    m_pendingLayout = watcher;
+}
+
+void ExpoLayout::applyLayout(const QList<QRectF> &windowLayouts)
+{
     for (int i = 0; i < windowLayouts.size(); ++i) {
         ExpoCell *cell = m_cells[i];
         QRectF target = windowLayouts[i];
@@ -671,14 +779,14 @@ static QList<T> reflect(const QList<T> &v)
     return result;
 }
 
-QList<QRectF> ExpoLayout::layout(const QRectF &area, const QList<QRectF> &windowSizes)
+QList<QRectF> ExpoLayout::layout(const QRectF &area, const QList<QRectF> &windowSizes, const LayoutParameters &parameters)
 {
     const qreal shortSide = std::min(area.width(), area.height());
-    const QMarginsF margins(shortSide * m_relativeMarginLeft,
-                            shortSide * m_relativeMarginTop,
-                            shortSide * m_relativeMarginRight,
-                            shortSide * m_relativeMarginBottom);
-    const qreal minLength = m_relativeMinLength * shortSide;
+    const QMarginsF margins(shortSide * parameters.relativeMarginLeft,
+                            shortSide * parameters.relativeMarginTop,
+                            shortSide * parameters.relativeMarginRight,
+                            shortSide * parameters.relativeMarginBottom);
+    const qreal minLength = parameters.relativeMinLength * shortSide;
     const QRectF minSize = QRectF(0, 0, minLength, minLength);
 
     QList<QPointF> centers;
@@ -689,15 +797,15 @@ QList<QRectF> ExpoLayout::layout(const QRectF &area, const QList<QRectF> &window
     // windows bigger than 4x the area are considered ill-behaved and their sizes are clipped
     const auto adjustedSizes = adjustSizes(minSize, QRectF(0, 0, 4 * area.width(), 4 * area.height()), margins, windowSizes);
 
-    if (placementMode() == PlacementMode::Rows) {
-        LayeredPacking bestPacking = findGoodPacking(area, adjustedSizes, centers, m_idealWidthRatio, m_searchTolerance);
-        return refineAndApplyPacking(area, margins, bestPacking, adjustedSizes, centers);
+    if (parameters.placementMode == PlacementMode::Rows) {
+        LayeredPacking bestPacking = findGoodPacking(area, adjustedSizes, centers, parameters.idealWidthRatio, parameters.searchTolerance);
+        return refineAndApplyPacking(area, margins, bestPacking, adjustedSizes, centers, parameters);
     } else {
         QList<QRectF> adjustedSizesReflected(reflect(adjustedSizes));
         QList<QPointF> centersReflected(reflect(centers));
 
-        LayeredPacking bestPacking = findGoodPacking(area.transposed(), adjustedSizesReflected, centersReflected, m_idealWidthRatio, m_searchTolerance);
-        return reflect(refineAndApplyPacking(area.transposed(), reflect(margins), bestPacking, adjustedSizesReflected, centersReflected));
+        LayeredPacking bestPacking = findGoodPacking(area.transposed(), adjustedSizesReflected, centersReflected, parameters.idealWidthRatio, parameters.searchTolerance);
+        return reflect(refineAndApplyPacking(area.transposed(), reflect(margins), bestPacking, adjustedSizesReflected, centersReflected, parameters));
     }
 }
 
@@ -805,18 +913,18 @@ ExpoLayout::findGoodPacking(const QRectF &area, const QList<QRectF> &windowSizes
     }
 }
 
-QList<QRectF> ExpoLayout::refineAndApplyPacking(const QRectF &area, const QMarginsF &margins, const LayeredPacking &packing, const QList<QRectF> &windowSizes, const QList<QPointF> &centers)
+QList<QRectF> ExpoLayout::refineAndApplyPacking(const QRectF &area, const QMarginsF &margins, const LayeredPacking &packing, const QList<QRectF> &windowSizes, const QList<QPointF> &centers, const LayoutParameters &parameters)
 {
     // Scale packing to fit area
     qreal scale = std::min(area.width() / packing.width, area.height() / packing.height);
-    scale = std::min(scale, m_maxScale);
+    scale = std::min(scale, parameters.maxScale);
 
     const QMarginsF scaledMargins = QMarginsF(margins.left() * scale, margins.top() * scale,
                                               margins.right() * scale, margins.bottom() * scale);
 
     // The maximum gap in additional to margins to leave between windows
-    qreal maxGapY = m_maxGapRatio * (scaledMargins.top() + scaledMargins.bottom());
-    qreal maxGapX = m_maxGapRatio * (scaledMargins.left() + scaledMargins.right());
+    qreal maxGapY = parameters.maxGapRatio * (scaledMargins.top() + scaledMargins.bottom());
+    qreal maxGapX = parameters.maxGapRatio * (scaledMargins.left() + scaledMargins.right());
 
     // center align y
     qreal extraY = area.height() - packing.height * scale;
@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <QCache>
+#include <QFutureWatcher>
 #include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QQuickItem>
 #include <QRect>
 
@@ -93,13 +96,54 @@ public:
     };
     Q_ENUM(PlacementMode)
 
+    /**
+     * The properties of the layout that the arrangement of the windows depends on.
+     */
+    struct LayoutParameters
+    {
+        PlacementMode placementMode = Rows;
+        qreal searchTolerance = 0.2;
+        qreal idealWidthRatio = 0.8;
+        qreal relativeMarginLeft = 0.07;
+        qreal relativeMarginRight = 0.07;
+        qreal relativeMarginTop = 0.07;
+        qreal relativeMarginBottom = 0.07;
+        qreal relativeMinLength = 0.15;
+        qreal maxGapRatio = 1.5;
+        qreal maxScale = 1.0;
+
+        bool operator==(const LayoutParameters &other) const = default;
+    };
+
+    /**
+     * Identifies a layout in the cache: the layout only depends on the size of the layout area,
+     * the layout parameters and the window sizes.
+     */
+    struct LayoutKey
+    {
+        QSizeF areaSize;
+        LayoutParameters parameters;
+        QList<QRectF> windowSizes;
+
+        bool operator==(const LayoutKey &other) const = default;
+    };
+
+    /**
+     * Layouts with at least this many windows are computed in a worker thread once the
+     * initial layout is done.
+     */
+    static constexpr int AsynchronousLayoutThreshold = 24;
+    static constexpr int MaxCachedLayouts = 32;
+
     explicit ExpoLayout(QQuickItem *parent = nullptr);
+    ~ExpoLayout() override;
 
     PlacementMode placementMode() const;
     void setPlacementMode(PlacementMode mode);
 
     void addCell(ExpoCell *cell);
     void removeCell(ExpoCell *cell);
+    void cancelPendingLayout();
 
     bool isReady() const;
     void setReady();
@@ -107,23 +151,25 @@ public:
     Q_INVOKABLE void forceLayout();
     Q_INVOKABLE void updateCellsMapping();
 
-protected:
-    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
-    void updatePolish() override;
-
     /**
-     * @brief Layout the windows with @param windowSizes into @param area.
+     * @brief Layout the windows with @param windowSizes into @param area, using
+     * the given @param parameters.
      *
-     * This is the main entry point for the layout algorithm.
+     * This is the main entry point for the layout algorithm. It doesn't access
+     * any state of the ExpoLayout, so it can be called from any thread.
      */
-    QList<QRectF> layout(const QRectF &area, const QList<QRectF> &windowSizes);
+    static QList<QRectF> layout(const QRectF &area, const QList<QRectF> &windowSizes, const LayoutParameters &parameters);
+
+protected:
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void updatePolish() override;
 
     /**
      * @brief First clip @param windowSizes to be between @param minSize and
      * @param maxSize. Then add @param margins to each window size, and @return
      * the adjusted window sizes.
      */
-    QList<QRectF> adjustSizes(const QRectF &minSize, const QRectF &maxSize, const QMarginsF &margins, const QList<QRectF> &windowSizes);
+    static QList<QRectF> adjustSizes(const QRectF &minSize, const QRectF &maxSize, const QMarginsF &margins, const QList<QRectF> &windowSizes);
 
     /**
      * @brief Use binary search to find a good packing of the @param windowSizes
@@ -144,7 +190,7 @@ protected:
      * Run time is O(n log n log log (totalWidth / maxWidth))
      * Since we clip the window size, this is just O(n log n log log n)
      */
-    LayeredPacking
+    static LayeredPacking
     findGoodPacking(const QRectF &area, const QList<QRectF> &windowSizes, const QList<QPointF> &centers, qreal idealWidthRatio, qreal tol);
 
     /**
@@ -154,8 +200,9 @@ protected:
      * remove previously added @param margins, add padding and align,
      * and @return the final layout.
      * In each layer, sort the windows by x coordinates of the @param centers.
+     * The scale and the gaps are limited according to @param parameters.
      */
-    QList<QRectF> refineAndApplyPacking(const QRectF &area, const QMarginsF &margins, const LayeredPacking &packing, const QList<QRectF> &windowSizes, const QList<QPointF> &centers);
+    static QList<QRectF> refineAndApplyPacking(const QRectF &area, const QMarginsF &margins, const LayeredPacking &packing, const QList<QRectF> &windowSizes, const QList<QPointF> &centers, const LayoutParameters &parameters);
 
 Q_SIGNALS:
     void placementModeChanged();
@@ -171,9 +218,16 @@ Q_SIGNALS:
     void maxScaleChanged();
 
 private:
+    void relayout(bool synchronous);
+    void applyLayout(const QList<QRectF> &windowLayouts);
+    LayoutParameters parameters() const;
+
     QList<ExpoCell *> m_cells;
     PlacementMode m_placementMode = Rows;
     bool m_ready = false;
+    QCache<LayoutKey, QList<QRectF>> m_layoutCache{MaxCachedLayouts};
+    QPointer<QFutureWatcher<QList<QRectF>>> m_pendingLayout;
+    quint64 m_generation = 0;
 
     qreal m_searchTolerance = 0.2;
     qreal m_idealWidthRatio = 0.8;
@@ -186,6 +240,8 @@ private:
     qreal m_maxScale = 1.0;
 };
 
+size_t qHash(const ExpoLayout::LayoutKey &key, size_t seed = 0);
+
 class ExpoCell : public QQuickItem
 {
     Q_OBJECT
@@ -77,6 +77,7 @@ Rules::Rules()
     , desktopfilerule(UnusedSetRule)
     , adaptivesyncrule(UnusedForceRule)
     , tearingrule(UnusedForceRule)
+    , throttlingrule(UnusedForceRule)
 {
 }
 
@@ -163,6 +164,7 @@ void Rules::readFromSettings(const RuleSettings *settings)
     READ_FORCE_RULE(layer, );
     READ_FORCE_RULE(adaptivesync, );
     READ_FORCE_RULE(tearing, );
+    READ_FORCE_RULE(throttling, );
 }
 
 #undef READ_MATCH_STRING
@@ -250,6 +252,8 @@ void Rules::write(RuleSettings *settings) const
     WRITE_SET_RULE(desktopfile, Desktopfile, );
     WRITE_FORCE_RULE(layer, Layer, );
     WRITE_FORCE_RULE(adaptivesync, Adaptivesync, );
+    WRITE_FORCE_RULE(tearing, Tearing, );
+    WRITE_FORCE_RULE(throttling, Throttling, );
 }
 
 #undef WRITE_MATCH_STRING
@@ -296,7 +300,8 @@ bool Rules::isEmpty() const
         && desktopfilerule == UnusedSetRule
         && layerrule == UnusedForceRule
         && adaptivesyncrule == UnusedForceRule
-        && tearingrule == UnusedForceRule;
+        && tearingrule == UnusedForceRule
+        && throttlingrule == UnusedForceRule;
 }
 
 Rules::ForceRule Rules::convertForceRule(int v)
@@ -695,6 +700,7 @@ APPLY_FORCE_RULE(disableglobalshortcuts, DisableGlobalShortcuts, bool)
 APPLY_RULE(desktopfile, DesktopFile, QString)
 APPLY_FORCE_RULE(adaptivesync, AdaptiveSync, bool)
 APPLY_FORCE_RULE(tearing, Tearing, bool)
+APPLY_FORCE_RULE(throttling, Throttling, int)
 
 #undef APPLY_RULE
 #undef APPLY_FORCE_RULE
@@ -755,6 +761,7 @@ bool Rules::discardUsed(bool withdrawn)
     DISCARD_USED_FORCE_RULE(layer);
     DISCARD_USED_FORCE_RULE(adaptivesync);
     DISCARD_USED_FORCE_RULE(tearing);
+    DISCARD_USED_FORCE_RULE(throttling);
 
     return changed;
 }
@@ -904,6 +911,7 @@ CHECK_RULE(DesktopFile, QString)
 CHECK_FORCE_RULE(Layer, Layer)
 CHECK_FORCE_RULE(AdaptiveSync, bool)
 CHECK_FORCE_RULE(Tearing, bool)
+CHECK_FORCE_RULE(Throttling, int)
 
 #undef CHECK_RULE
 #undef CHECK_FORCE_RULE
@@ -79,6 +79,7 @@ public:
     Layer checkLayer(Layer layer) const;
     bool checkAdaptiveSync(bool adaptivesync) const;
     bool checkTearing(bool requestsTearing) const;
+    int checkThrottling(int throttling) const;
 
 private:
     MaximizeMode checkMaximizeVert(MaximizeMode mode, bool init) const;
@@ -191,6 +192,7 @@ public:
     bool applyLayer(enum Layer &layer) const;
     bool applyAdaptiveSync(bool &adaptivesync) const;
     bool applyTearing(bool &tearing) const;
+    bool applyThrottling(int &throttling) const;
 
 private:
 #endif
@@ -300,6 +302,8 @@ private:
     ForceRule adaptivesyncrule;
     bool tearing;
     ForceRule tearingrule;
+    int throttling;
+    ForceRule throttlingrule;
     friend QDebug &operator<<(QDebug &stream, const Rules *);
 };
 
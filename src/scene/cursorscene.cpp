@@ -34,19 +34,9 @@ CursorScene::~CursorScene()
     m_rootItem.reset();
 }
 
-static void resetRepaintsHelper(Item *item, SceneDelegate *delegate)
-{
-    item->resetRepaints(delegate);
-
-    const auto childItems = item->childItems();
-    for (Item *childItem : childItems) {
-        resetRepaintsHelper(childItem, delegate);
-    }
-}
-
 QRegion CursorScene::prePaint(SceneDelegate *delegate)
 {
-    resetRepaintsHelper(m_rootItem.get(), delegate);
+    m_rootItem->collectRepaints(delegate, nullptr);
     m_paintedOutput = delegate->output();
     return m_rootItem->boundingRect().translated(-delegate->viewport().topLeft()).toAlignedRect();
 }
@@ -83,6 +83,11 @@ void DecorationRenderer::setDevicePixelRatio(qreal dpr)
     }
 }
 
+QPoint DecorationRenderer::textureOrigin() const
+{
+    return QPoint(0, 0);
+}
+
 void DecorationRenderer::renderToPainter(QPainter *painter, const QRectF &rect)
 {
     client()->decoration()->paint(painter, rect);
@@ -104,6 +109,8 @@ DecorationItem::DecorationItem(KDecoration3::Decoration *decoration, Window *win
 
     connect(renderer(), &DecorationRenderer::damaged,
             this, qOverload<const QRegion &>(&Item::scheduleRepaint));
+    connect(renderer(), &DecorationRenderer::textureOriginChanged,
+            this, &DecorationItem::discardQuads);
 
     setSize(decoration->size());
     updateScale();
@@ -221,10 +228,10 @@ WindowQuadList DecorationItem::buildQuads() const
     const int bottomHeight = std::round(bottom.height() * devicePixelRatio);
     const int leftWidth = std::round(left.width() * devicePixelRatio);
 
-    const QPoint topPosition(0, 0);
-    const QPoint bottomPosition(0, topPosition.y() + topHeight + (2 * texturePad));
-    const QPoint leftPosition(0, bottomPosition.y() + bottomHeight + (2 * texturePad));
-    const QPoint rightPosition(0, leftPosition.y() + leftWidth + (2 * texturePad));
+    const QPoint topPosition = m_renderer->textureOrigin();
+    const QPoint bottomPosition(topPosition.x(), topPosition.y() + topHeight + (2 * texturePad));
+    const QPoint leftPosition(topPosition.x(), bottomPosition.y() + bottomHeight + (2 * texturePad));
+    const QPoint rightPosition(topPosition.x(), leftPosition.y() + leftWidth + (2 * texturePad));
 
     WindowQuadList list;
     if (left.isValid()) {
@@ -41,11 +41,21 @@ public:
     qreal devicePixelRatio() const;
     void setDevicePixelRatio(qreal dpr);
 
+    /**
+     * Returns the position of the decoration parts in the texture. The parts are laid out
+     * from this position downwards.
+     */
+    virtual QPoint textureOrigin() const;
+
     // Reserve some space for padding. We pad decoration parts to avoid texture bleeding.
     static const int TexturePad = 1;
 
 Q_SIGNALS:
     void damaged(const QRegion &region);
+    /**
+     * This signal is emitted when the decoration parts have been moved in the texture.
+     */
+    void textureOriginChanged();
 
 protected:
     explicit DecorationRenderer(Decoration::DecoratedWindowImpl *client);
@@ -115,6 +115,9 @@ void Item::addChild(Item *item)
 
     m_childItems.append(item);
     markSortedChildItemsDirty();
+    if (item->m_repaintsDirty) {
+        markRepaintsDirty();
+    }
 
     updateBoundingRect();
     scheduleRepaint(item->transform().mapRect(item->boundingRect()).translated(item->position()));
@@ -146,9 +149,9 @@ void Item::setScene(Scene *scene)
     if (m_scene) {
         for (auto it = m_repaints.constBegin(); it != m_repaints.constEnd(); ++it) {
             SceneDelegate *delegate = it.key();
-            const QRegion &dirty = it.value();
+            const DamageRegion &dirty = it.value();
             if (!dirty.isEmpty()) {
-                m_scene->addRepaint(delegate, dirty);
+                m_scene->addRepaint(delegate, dirty.toRegion());
             }
         }
         m_repaints.clear();
@@ -415,11 +418,7 @@ void Item::scheduleRepaintInternal(const QRegion &region)
     }
     const QList<SceneDelegate *> delegates = m_scene->delegates();
     for (SceneDelegate *delegate : delegates) {
-        const QRegion dirtyRegion = paintedArea(delegate, region) & delegate->viewport();
-        if (!dirtyRegion.isEmpty()) {
-            m_repaints[delegate] += dirtyRegion;
-            delegate->layer()->scheduleRepaint(this);
-        }
+        scheduleRepaintInternal(delegate, region);
     }
 }
 
@@ -428,9 +427,20 @@ void Item::scheduleRepaintInternal(SceneDelegate *delegate, const QRegion &regio
     if (Q_UNLIKELY(!m_scene)) {
         return;
     }
-    const QRegion dirtyRegion = paintedArea(delegate, region) & delegate->viewport();
-    if (!dirtyRegion.isEmpty()) {
-        m_repaints[delegate] += dirtyRegion;
+    // Map and clip the rects one by one, so no intermediate QRegion has to be built.
+    const QRect viewport = delegate->viewport();
+    DamageRegion *repaints = nullptr;
+    for (const QRect &rect : region) {
+        const QRect dirtyRect = paintedArea(delegate, QRectF(rect)) & viewport;
+        if (!dirtyRect.isEmpty()) {
+            if (!repaints) {
+                repaints = &m_repaints[delegate];
+            }
+            *repaints += dirtyRect;
+        }
+    }
+    if (repaints) {
+        markRepaintsDirty();
         delegate->layer()->scheduleRepaint(this);
     }
 }
@@ -478,6 +488,7 @@ WindowQuadList Item::buildQuads() const
 void Item::discardQuads()
 {
     m_quads.reset();
+    m_quadsSerial++;
 }
 
 WindowQuadList Item::quads() const
@@ -488,17 +499,52 @@ WindowQuadList Item::quads() const
     return m_quads.value();
 }
 
-QRegion Item::takeRepaints(SceneDelegate *delegate)
+quint64 Item::quadsSerial() const
 {
-    auto &repaints = m_repaints[delegate];
-    QRegion reg;
-    std::swap(reg, repaints);
-    return reg;
+    return m_quadsSerial;
+}
+
+DamageRegion Item::takeRepaints(SceneDelegate *delegate)
+{
+    return m_repaints.take(delegate);
 }
 
 void Item::resetRepaints(SceneDelegate *delegate)
 {
-    m_repaints.insert(delegate, QRegion());
+    m_repaints.remove(delegate);
+}
+
+void Item::markRepaintsDirty()
+{
+    // If an item is dirty, so are all of its ancestors.
+    for (Item *item = this; item && !item->m_repaintsDirty; item = item->parentItem()) {
+        item->m_repaintsDirty = true;
+    }
+}
+
+int Item::collectRepaints(SceneDelegate *delegate, DamageRegion *repaints)
+{
+    if (!m_repaintsDirty) {
+        return 0;
+    }
+
+    int visitedCount = 1;
+    if (auto it = m_repaints.find(delegate); it != m_repaints.end()) {
+        if (repaints) {
+            *repaints += it.value();
+        }
+        m_repaints.erase(it);
+    }
+
+    // The repaints for other delegates are still pending.
+    bool dirty = !m_repaints.isEmpty();
+    for (Item *childItem : std::as_const(m_childItems)) {
+        visitedCount += childItem->collectRepaints(delegate, repaints);
+        dirty |= childItem->m_repaintsDirty;
+    }
+    m_repaintsDirty = dirty;
+
+    return visitedCount;
 }
 
 void Item::removeRepaints(SceneDelegate *delegate)
@@ -9,6 +9,7 @@
 #include "core/colorspace.h"
 #include "effect/globals.h"
 #include "scene/itemgeometry.h"
+#include "utils/damageregion.h"
 
 #include <QList>
 #include <QObject>
@@ -129,10 +130,21 @@ public:
     void scheduleSceneRepaint(const QRegion &region);
     void scheduleRepaint(SceneDelegate *delegate, const QRegion &region);
     void scheduleFrame();
-    QRegion takeRepaints(SceneDelegate *delegate);
+    DamageRegion takeRepaints(SceneDelegate *delegate);
     void resetRepaints(SceneDelegate *delegate);
+    /**
+     * Moves the repaints of this item and all of its descendants for the given @a delegate
+     * into @a repaints, or discards them if @a repaints is null. Subtrees without pending
+     * repaints are skipped. Returns the number of visited items.
+     */
+    int collectRepaints(SceneDelegate *delegate, DamageRegion *repaints);
 
     WindowQuadList quads() const;
+    /**
+     * Returns a number that changes every time the quads of this item are discarded. It
+     * can be used to tell whether geometry derived from the quads needs to be rebuilt.
+     */
+    quint64 quadsSerial() const;
     virtual void preprocess();
     const ColorDescription &colorDescription() const;
     RenderingIntent renderingIntent() const;
@@ -176,6 +188,7 @@ private:
     void scheduleRepaintInternal(SceneDelegate *delegate, const QRegion &region);
     void scheduleSceneRepaintInternal(const QRegion &region);
     void markSortedChildItemsDirty();
+    void markRepaintsDirty();
 
     bool computeEffectiveVisibility() const;
     void updateEffectiveVisibility();
@@ -194,8 +207,10 @@ private:
     int m_z = 0;
     bool m_explicitVisible = true;
     bool m_effectiveVisible = true;
-    QMap<SceneDelegate *, QRegion> m_repaints;
+    QMap<SceneDelegate *, DamageRegion> m_repaints;
+    bool m_repaintsDirty = false;
     mutable std::optional<WindowQuadList> m_quads;
+    quint64 m_quadsSerial = 0;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
     ColorDescription m_colorDescription = ColorDescription::sRGB;
     RenderingIntent m_renderingIntent = RenderingIntent::Perceptual;
@@ -11,6 +11,7 @@
 #include "core/renderviewport.h"
 #include "core/syncobjtimeline.h"
 #include "effect/effect.h"
+#include "frametracer.h"
 #include "opengl/eglnativefence.h"
 #include "platformsupport/scenes/opengl/openglsurfacetexture.h"
 #include "scene/decorationitem.h"
@@ -33,6 +34,13 @@ ItemRendererOpenGL::ItemRendererOpenGL(EglDisplay *eglDisplay)
     }
 }
 
+ItemRendererOpenGL::~ItemRendererOpenGL()
+{
+    for (const auto &[item, cache] : m_geometryCache) {
+        QObject::disconnect(cache.destroyedConnection);
+    }
+}
+
 std::unique_ptr<ImageItem> ItemRendererOpenGL::createImageItem(Item *parent)
 {
     return std::make_unique<ImageItemOpenGL>(parent);
@@ -153,65 +161,67 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context)
 
     item->preprocess();
 
-    RenderGeometry geometry = clipQuads(item, context);
-
+    std::optional<RenderNode> renderNode;
     if (auto shadowItem = qobject_cast<ShadowItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
-            context->renderNodes.append(RenderNode{
-                .texture = textureProvider->shadowTexture(),
-                .geometry = geometry,
-                .transformMatrix = context->transformStack.top(),
-                .opacity = context->opacityStack.top(),
-                .hasAlpha = true,
-                .colorDescription = item->colorDescription(),
-                .renderingIntent = item->renderingIntent(),
-                .bufferReleasePoint = nullptr,
-            });
-        }
+        OpenGLShadowTextureProvider *textureProvider = static_cast<OpenGLShadowTextureProvider *>(shadowItem->textureProvider());
+        renderNode = RenderNode{
+            .texture = textureProvider->shadowTexture(),
+            .transformMatrix = context->transformStack.top(),
+            .opacity = context->opacityStack.top(),
+            .hasAlpha = true,
+            .colorDescription = item->colorDescription(),
+            .renderingIntent = item->renderingIntent(),
+            .bufferReleasePoint = nullptr,
+        };
     } else if (auto decorationItem = qobject_cast<DecorationItem *>(item)) {
-        if (!geometry.isEmpty()) {
-            auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
-            context->renderNodes.append(RenderNode{
-                .texture = renderer->texture(),
-                .geometry = geometry,
-                .transformMatrix = context->transformStack.top(),
-                .opacity = context->opacityStack.top(),
-                .hasAlpha = true,
-                .colorDescription = item->colorDescription(),
-                .renderingIntent = item->renderingIntent(),
-                .bufferReleasePoint = nullptr,
-            });
-        }
+        auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
+        renderNode = RenderNode{
+            .texture = renderer->texture(),
+            .transformMatrix = context->transformStack.top(),
+            .opacity = context->opacityStack.top(),
+            .hasAlpha = true,
+            .colorDescription = item->colorDescription(),
+            .renderingIntent = item->renderingIntent(),
+            .bufferReleasePoint = nullptr,
+        };
     } else if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
         SurfacePixmap *pixmap = surfaceItem->pixmap();
         if (pixmap) {
-            if (!geometry.isEmpty()) {
-                OpenGLSurfaceTexture *surfaceTexture = static_cast<OpenGLSurfaceTexture *>(pixmap->texture());
-                context->renderNodes.append(RenderNode{
-                    .texture = surfaceTexture->texture(),
-                    .geometry = geometry,
-                    .transformMatrix = context->transformStack.top(),
-                    .opacity = context->opacityStack.top(),
-                    .hasAlpha = pixmap->hasAlphaChannel(),
-                    .colorDescription = item->colorDescription(),
-                    .renderingIntent = item->renderingIntent(),
-                    .bufferReleasePoint = surfaceItem->bufferReleasePoint(),
-                });
-            }
-        }
-    } else if (auto imageItem = qobject_cast<ImageItemOpenGL *>(item)) {
-        if (!geometry.isEmpty()) {
-            context->renderNodes.append(RenderNode{
-                .texture = imageItem->texture(),
-                .geometry = geometry,
+            OpenGLSurfaceTexture *surfaceTexture = static_cast<OpenGLSurfaceTexture *>(pixmap->texture());
+            renderNode = RenderNode{
+                .texture = surfaceTexture->texture(),
                 .transformMatrix = context->transformStack.top(),
                 .opacity = context->opacityStack.top(),
-                .hasAlpha = imageItem->image().hasAlphaChannel(),
+                .hasAlpha = pixmap->hasAlphaChannel(),
                 .colorDescription = item->colorDescription(),
                 .renderingIntent = item->renderingIntent(),
-                .bufferReleasePoint = nullptr,
-            });
+                .bufferReleasePoint = surfaceItem->bufferReleasePoint(),
+            };
+        }
+    } else if (auto imageItem = qobject_cast<ImageItemOpenGL *>(item)) {
+        renderNode = RenderNode{
+            .texture = imageItem->texture(),
+            .transformMatrix = context->transformStack.top(),
+            .opacity = context->opacityStack.top(),
+            .hasAlpha = imageItem->image().hasAlphaChannel(),
+            .colorDescription = item->colorDescription(),
+            .renderingIntent = item->renderingIntent(),
+            .bufferReleasePoint = nullptr,
+        };
+    }
+
+    if (renderNode) {
+        GLTexture *texture = nullptr;
+        if (std::holds_alternative<GLTexture *>(renderNode->texture)) {
+            texture = std::get<GLTexture *>(renderNode->texture);
+        } else if (const auto &contents = std::get<OpenGLSurfaceContents>(renderNode->texture); contents.isValid()) {
+            texture = contents.planes.constFirst().get();
+        }
+        if (texture) {
+            setRenderNodeGeometry(item, context, texture, &*renderNode);
+            if (renderNode->vertexCount > 0) {
+                context->renderNodes.append(std::move(*renderNode));
+            }
         }
     }
 
@@ -228,6 +238,47 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context)
     context->opacityStack.pop();
 }
 
+void ItemRendererOpenGL::setRenderNodeGeometry(Item *item, const RenderContext *context, GLTexture *texture, RenderNode *renderNode)
+{
+    // The vertices depend on the clip only if it's applied in software.
+    const bool softwareClipping = context->clip != infiniteRegion() && !context->hardwareClipping;
+    const GeometryKey key{
+        .quadsSerial = item->quadsSerial(),
+        .scale = context->renderTargetScale,
+        .clip = softwareClipping ? context->clip : infiniteRegion(),
+        .worldTranslation = softwareClipping ? context->transformStack.top().map(QPointF(0., 0.)) : QPointF(),
+        .textureMatrix = texture->matrix(UnnormalizedCoordinates),
+    };
+
+    auto [it, inserted] = m_geometryCache.try_emplace(item);
+    CachedGeometry &cache = it->second;
+    if (inserted) {
+        cache.destroyedConnection = QObject::connect(item, &QObject::destroyed, [this, item]() {
+            m_geometryCache.erase(item);
+        });
+    } else if (cache.key == key) {
+        if (!cache.vertexBuffer && !cache.geometry.isEmpty()) {
+            cache.vertexBuffer = std::make_unique<GLVertexBuffer>(GLVertexBuffer::Static);
+            cache.vertexBuffer->setVertices(cache.geometry);
+            cache.geometry = RenderGeometry();
+        }
+        renderNode->vertexBuffer = cache.vertexBuffer.get();
+        renderNode->vertexCount = cache.vertexCount;
+        return;
+    }
+
+    RenderGeometry geometry = clipQuads(item, context);
+    geometry.postProcessTextureCoordinates(key.textureMatrix);
+
+    cache.key = key;
+    cache.geometry = geometry;
+    cache.vertexBuffer.reset();
+    cache.vertexCount = geometry.count();
+
+    renderNode->geometry = std::move(geometry);
+    renderNode->vertexCount = renderNode->geometry.count();
+}
+
 void ItemRendererOpenGL::renderBackground(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &region)
 {
     if (region == infiniteRegion() || (region.rectCount() == 1 && (*region.begin()) == viewport.renderRect())) {
@@ -265,16 +316,23 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
     renderContext.transformStack.push(QMatrix4x4());
     renderContext.opacityStack.push(data.opacity());
 
-    createRenderNode(item, &renderContext);
-
-    int totalVertexCount = 0;
-    for (const RenderNode &node : std::as_const(renderContext.renderNodes)) {
-        totalVertexCount += node.geometry.count();
+    {
+        frameTraceScope("Render node build");
+        createRenderNode(item, &renderContext);
     }
-    if (totalVertexCount == 0) {
+
+    if (renderContext.renderNodes.isEmpty()) {
         return;
     }
 
+    // Only the nodes whose geometry isn't cached have to be copied into the streaming buffer.
+    int streamedVertexCount = 0;
+    for (const RenderNode &node : std::as_const(renderContext.renderNodes)) {
+        if (!node.vertexBuffer) {
+            streamedVertexCount += node.vertexCount;
+        }
+    }
+
     ShaderTraits baseShaderTraits = ShaderTrait::MapTexture;
     if (data.brightness() != 1.0) {
         baseShaderTraits |= ShaderTrait::Modulate;
@@ -283,41 +341,31 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         baseShaderTraits |= ShaderTrait::AdjustSaturation;
     }
 
-    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
-    vbo->reset();
-    vbo->setAttribLayout(std::span(GLVertexBuffer::GLVertex2DLayout), sizeof(GLVertex2D));
+    frameTraceScope("GL submit");
+    if (streamedVertexCount > 0) {
+        GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+        vbo->reset();
+        vbo->setAttribLayout(std::span(GLVertexBuffer::GLVertex2DLayout), sizeof(GLVertex2D));
 
-    const auto map = vbo->map<GLVertex2D>(totalVertexCount);
-    if (!map) {
-        return;
-    }
-
-    for (int i = 0, v = 0; i < renderContext.renderNodes.count(); i++) {
-        RenderNode &renderNode = renderContext.renderNodes[i];
-        if (renderNode.geometry.isEmpty()
-            || (std::holds_alternative<GLTexture *>(renderNode.texture) && !std::get<GLTexture *>(renderNode.texture))
-            || (std::holds_alternative<OpenGLSurfaceContents>(renderNode.texture) && !std::get<OpenGLSurfaceContents>(renderNode.texture).isValid())) {
-            continue;
+        const auto map = vbo->map<GLVertex2D>(streamedVertexCount);
+        if (!map) {
+            return;
         }
 
-        renderNode.firstVertex = v;
-        renderNode.vertexCount = renderNode.geometry.count();
-
-        GLTexture *texture = nullptr;
-        if (std::holds_alternative<GLTexture *>(renderNode.texture)) {
-            texture = std::get<GLTexture *>(renderNode.texture);
-        } else {
-            texture = std::get<OpenGLSurfaceContents>(renderNode.texture).planes.constFirst().get();
+        for (int i = 0, v = 0; i < renderContext.renderNodes.count(); i++) {
+            RenderNode &renderNode = renderContext.renderNodes[i];
+            if (renderNode.vertexBuffer) {
+                continue;
+            }
+            renderNode.vertexBuffer = vbo;
+            renderNode.firstVertex = v;
+            renderNode.geometry.copy(map->subspan(v));
+            v += renderNode.vertexCount;
         }
-        renderNode.geometry.postProcessTextureCoordinates(texture->matrix(UnnormalizedCoordinates));
 
-        renderNode.geometry.copy(map->subspan(v));
-        v += renderNode.geometry.count();
+        vbo->unmap();
     }
 
-    vbo->unmap();
-    vbo->bindArrays();
-
     if (renderContext.hardwareClipping) {
         glEnable(GL_SCISSOR_TEST);
     }
@@ -333,11 +381,9 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
 
     ShaderTraits lastTraits;
     GLShader *shader = nullptr;
+    GLVertexBuffer *boundBuffer = nullptr;
     for (int i = 0; i < renderContext.renderNodes.count(); i++) {
         const RenderNode &renderNode = renderContext.renderNodes[i];
-        if (renderNode.vertexCount == 0) {
-            continue;
-        }
 
         setBlendEnabled(renderNode.hasAlpha || renderNode.opacity < 1.0);
 
@@ -388,8 +434,15 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
             }
         }
 
-        vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
-                  renderNode.vertexCount, renderContext.hardwareClipping);
+        if (boundBuffer != renderNode.vertexBuffer) {
+            if (boundBuffer) {
+                boundBuffer->unbindArrays();
+            }
+            boundBuffer = renderNode.vertexBuffer;
+            boundBuffer->bindArrays();
+        }
+        boundBuffer->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
+                          renderNode.vertexCount, renderContext.hardwareClipping);
 
         if (std::holds_alternative<GLTexture *>(renderNode.texture)) {
             auto texture = std::get<GLTexture *>(renderNode.texture);
@@ -412,12 +465,14 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         ShaderManager::instance()->popShader();
     }
 
+    if (boundBuffer) {
+        boundBuffer->unbindArrays();
+    }
+
     if (m_debug.fractionalEnabled) {
         visualizeFractional(viewport, scissorRegion, renderContext);
     }
 
-    vbo->unbindArrays();
-
     setBlendEnabled(false);
 
     if (renderContext.hardwareClipping) {
@@ -444,13 +499,8 @@ void ItemRendererOpenGL::visualizeFractional(const RenderViewport &viewport, con
     auto screenSize = viewport.renderRect().size() * viewport.scale();
     m_debug.fractionalShader->setUniform("screenSize", QVector2D(float(screenSize.width()), float(screenSize.height())));
 
-    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
-
     for (int i = 0; i < renderContext.renderNodes.count(); i++) {
         const RenderNode &renderNode = renderContext.renderNodes[i];
-        if (renderNode.vertexCount == 0) {
-            continue;
-        }
 
         setBlendEnabled(true);
 
@@ -466,8 +516,10 @@ void ItemRendererOpenGL::visualizeFractional(const RenderViewport &viewport, con
         m_debug.fractionalShader->setUniform("geometrySize", size);
         m_debug.fractionalShader->setUniform(GLShader::Mat4Uniform::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
 
-        vbo->draw(region, GL_TRIANGLES, renderNode.firstVertex,
-                  renderNode.vertexCount, renderContext.hardwareClipping);
+        renderNode.vertexBuffer->bindArrays();
+        renderNode.vertexBuffer->draw(region, GL_TRIANGLES, renderNode.firstVertex,
+                                      renderNode.vertexCount, renderContext.hardwareClipping);
+        renderNode.vertexBuffer->unbindArrays();
     }
 }
 
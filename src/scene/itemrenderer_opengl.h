@@ -10,6 +10,7 @@
 #include "platformsupport/scenes/opengl/openglsurfacetexture.h"
 #include "scene/itemrenderer.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 namespace KWin
@@ -25,6 +26,7 @@ public:
         std::variant<GLTexture *, OpenGLSurfaceContents> texture;
         RenderGeometry geometry;
         QMatrix4x4 transformMatrix;
+        GLVertexBuffer *vertexBuffer = nullptr;
         int firstVertex = 0;
         int vertexCount = 0;
         qreal opacity = 1;
@@ -47,6 +49,7 @@ public:
     };
 
     ItemRendererOpenGL(EglDisplay *eglDisplay);
+    ~ItemRendererOpenGL() override;
 
     void beginFrame(const RenderTarget &renderTarget, const RenderViewport &viewport) override;
     void endFrame() override;
@@ -60,12 +63,39 @@ private:
     QVector4D modulate(float opacity, float brightness) const;
     void setBlendEnabled(bool enabled);
     void createRenderNode(Item *item, RenderContext *context);
+    void setRenderNodeGeometry(Item *item, const RenderContext *context, GLTexture *texture, RenderNode *renderNode);
     void visualizeFractional(const RenderViewport &viewport, const QRegion &region, const RenderContext &renderContext);
 
     bool m_blendingEnabled = false;
     EglDisplay *const m_eglDisplay;
     std::unordered_set<std::shared_ptr<SyncReleasePoint>> m_releasePoints;
 
+    struct GeometryKey
+    {
+        quint64 quadsSerial = 0;
+        qreal scale = 1;
+        QRegion clip;
+        QPointF worldTranslation;
+        QMatrix4x4 textureMatrix;
+
+        bool operator==(const GeometryKey &other) const = default;
+    };
+
+    /**
+     * The vertices of an item, as they were uploaded the last time it was rendered. The
+     * vertices are moved to a buffer of their own once they have been drawn twice in a row
+     * without changes, after that they are not copied into the streaming buffer anymore.
+     */
+    struct CachedGeometry
+    {
+        GeometryKey key;
+        RenderGeometry geometry;
+        std::unique_ptr<GLVertexBuffer> vertexBuffer;
+        int vertexCount = 0;
+        QMetaObject::Connection destroyedConnection;
+    };
+    std::unordered_map<const Item *, CachedGeometry> m_geometryCache;
+
     struct
     {
         bool fractionalEnabled = false;
@@ -63,7 +63,24 @@ void SurfaceItemX11::preprocess()
 void SurfaceItemX11::processDamage()
 {
     m_isDamaged = true;
-    scheduleFrame();
+    if (!m_isOccluded) {
+        scheduleFrame();
+    }
+}
+
+bool SurfaceItemX11::isOccluded() const
+{
+    return m_isOccluded;
+}
+
+void SurfaceItemX11::setOccluded(bool occluded)
+{
+    m_isOccluded = occluded;
+}
+
+quint64 SurfaceItemX11::skippedDamageFetches() const
+{
+    return m_skippedDamageFetches;
 }
 
 bool SurfaceItemX11::fetchDamage()
@@ -71,6 +88,10 @@ bool SurfaceItemX11::fetchDamage()
     if (!m_isDamaged) {
         return false;
     }
+    if (m_isOccluded) {
+        m_skippedDamageFetches++;
+        return false;
+    }
 
     if (m_damageHandle == XCB_NONE) {
         return true;
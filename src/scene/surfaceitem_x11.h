@@ -37,6 +37,19 @@ public:
     void forgetDamage();
     void destroyDamage();
 
+    /**
+     * While the surface is occluded, either because it is covered by other windows or because
+     * its window is suspended, its damage is left in the X server and doesn't schedule repaints.
+     * It is fetched once the surface is not occluded anymore.
+     */
+    bool isOccluded() const;
+    void setOccluded(bool occluded);
+    /**
+     * Returns the number of frames in which the damage of the surface was left in the X server
+     * because the surface was occluded.
+     */
+    quint64 skippedDamageFetches() const;
+
     QList<QRectF> shape() const override;
     QRegion opaque() const override;
 
@@ -53,6 +66,8 @@ private:
     xcb_xfixes_fetch_region_cookie_t m_damageCookie;
     bool m_isDamaged = false;
     bool m_havePendingDamageRegion = false;
+    bool m_isOccluded = false;
+    quint64 m_skippedDamageFetches = 0;
 };
 
 class KWIN_EXPORT SurfacePixmapX11 final : public SurfacePixmap
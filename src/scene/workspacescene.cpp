@@ -60,6 +60,7 @@
 #include "core/renderloop.h"
 #include "core/renderviewport.h"
 #include "effect/effecthandler.h"
+#include "frametracer.h"
 #include "internalwindow.h"
 #include "scene/decorationitem.h"
 #include "scene/dndiconitem.h"
@@ -69,6 +70,7 @@
 #include "scene/surfaceitem.h"
 #include "scene/windowitem.h"
 #include "shadow.h"
+#include "utils/damageregion.h"
 #include "wayland/seat.h"
 #include "wayland/surface.h"
 #include "wayland_server.h"
@@ -251,7 +253,24 @@ double WorkspaceScene::desiredHdrHeadroom() const
 
 void WorkspaceScene::frame(SceneDelegate *delegate, OutputFrame *frame)
 {
-    if (waylandServer()) {
+#if KWIN_BUILD_X11
+    // Tell X11 clients using the extended frame synchronization protocol that their frames
+    // have been drawn, the timings will be sent when the frame is presented. Clients that
+    // should stop drawing while they can't be seen are kept waiting. The stacking order has
+    // been cleared in postPaint() already, and the X11 compositor paints the whole workspace
+    // with a delegate that isn't bound to any output.
+    const QList<Item *> windowItems = m_containerItem->sortedChildItems();
+    for (Item *child : windowItems) {
+        WindowItem *item = static_cast<WindowItem *>(child);
+        if (auto x11Window = qobject_cast<X11Window *>(item->window())) {
+            if (item->isVisible() && (!delegate->output() || x11Window->isOnOutput(delegate->output())) && !x11Window->isFrameDrawnWithheld()) {
+                x11Window->sendFrameDrawn(frame);
+            }
+        }
+    }
+#endif
+
+    if (waylandServer() && delegate->output()) {
         Output *output = delegate->output();
         const std::chrono::milliseconds frameTime =
             std::chrono::duration_cast<std::chrono::milliseconds>(output->renderLoop()->lastPresentationTimestamp());
@@ -290,6 +309,7 @@ void WorkspaceScene::frame(SceneDelegate *delegate, OutputFrame *frame)
 
 QRegion WorkspaceScene::prePaint(SceneDelegate *delegate)
 {
+    frameTraceScope("Pre-paint");
     createStackingOrder();
 
     painted_delegate = delegate;
@@ -317,7 +337,10 @@ QRegion WorkspaceScene::prePaint(SceneDelegate *delegate)
     effects->makeOpenGLContextCurrent();
     Q_EMIT preFrameRender();
 
-    effects->prePaintScreen(prePaintData, m_expectedPresentTimestamp);
+    {
+        frameTraceScope("Effects pre-paint");
+        effects->prePaintScreen(prePaintData, m_expectedPresentTimestamp);
+    }
     m_paintContext.damage = prePaintData.paint;
     m_paintContext.mask = prePaintData.mask;
     m_paintContext.phase2Data.clear();
@@ -331,30 +354,11 @@ QRegion WorkspaceScene::prePaint(SceneDelegate *delegate)
     return m_paintContext.damage.translated(-delegate->viewport().topLeft());
 }
 
-static void resetRepaintsHelper(Item *item, SceneDelegate *delegate)
-{
-    item->resetRepaints(delegate);
-
-    const auto childItems = item->childItems();
-    for (Item *childItem : childItems) {
-        resetRepaintsHelper(childItem, delegate);
-    }
-}
-
-static void accumulateRepaints(Item *item, SceneDelegate *delegate, QRegion *repaints)
-{
-    *repaints += item->takeRepaints(delegate);
-
-    const auto childItems = item->childItems();
-    for (Item *childItem : childItems) {
-        accumulateRepaints(childItem, delegate, repaints);
-    }
-}
-
 void WorkspaceScene::preparePaintGenericScreen()
 {
+    int visitedItemCount = 0;
     for (WindowItem *windowItem : std::as_const(stacking_order)) {
-        resetRepaintsHelper(windowItem, painted_delegate);
+        visitedItemCount += windowItem->collectRepaints(painted_delegate, nullptr);
 
         WindowPrePaintData data;
         data.mask = m_paintContext.mask;
@@ -369,17 +373,24 @@ void WorkspaceScene::preparePaintGenericScreen()
         });
     }
 
-    resetRepaintsHelper(m_overlayItem.get(), painted_delegate);
+    visitedItemCount += m_overlayItem->collectRepaints(painted_delegate, nullptr);
+    frameTraceCounter("Repaint items visited", visitedItemCount);
+
     m_paintContext.damage = infiniteRegion();
+    m_occluders.clear();
 }
 
 void WorkspaceScene::preparePaintSimpleScreen()
 {
+    int visitedItemCount = 0;
     for (WindowItem *windowItem : std::as_const(stacking_order)) {
         Window *window = windowItem->window();
         WindowPrePaintData data;
         data.mask = m_paintContext.mask;
-        accumulateRepaints(windowItem, painted_delegate, &data.paint);
+
+        DamageRegion repaints;
+        visitedItemCount += windowItem->collectRepaints(painted_delegate, &repaints);
+        data.paint = repaints.toRegion();
 
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass.
         if (window->opacity() == 1.0) {
@@ -405,15 +416,28 @@ void WorkspaceScene::preparePaintSimpleScreen()
 
     // Perform an occlusion cull pass, remove surface damage occluded by opaque windows.
     QRegion opaque;
+    DamageRegion damage(m_paintContext.damage);
+    m_occluders.clear();
     for (int i = m_paintContext.phase2Data.size() - 1; i >= 0; --i) {
         const auto &paintData = m_paintContext.phase2Data.at(i);
-        m_paintContext.damage += paintData.region - opaque;
+        if (!paintData.region.isEmpty()) {
+            damage += paintData.region - opaque;
+        }
         if (!(paintData.mask & (PAINT_WINDOW_TRANSLUCENT | PAINT_WINDOW_TRANSFORMED))) {
             opaque += paintData.opaque;
+            m_occluders.insert(paintData.item->window());
         }
     }
 
-    accumulateRepaints(m_overlayItem.get(), painted_delegate, &m_paintContext.damage);
+    visitedItemCount += m_overlayItem->collectRepaints(painted_delegate, &damage);
+    frameTraceCounter("Repaint items visited", visitedItemCount);
+
+    m_paintContext.damage = damage.toRegion();
+}
+
+bool WorkspaceScene::isOccluder(const Window *window) const
+{
+    return m_occluders.contains(window);
 }
 
 void WorkspaceScene::postPaint()
@@ -434,7 +458,10 @@ void WorkspaceScene::paint(const RenderTarget &renderTarget, const QRegion &regi
 
     m_renderer->beginFrame(renderTarget, viewport);
 
-    effects->paintScreen(renderTarget, viewport, m_paintContext.mask, region, painted_screen);
+    {
+        frameTraceScope("Effect chain");
+        effects->paintScreen(renderTarget, viewport, m_paintContext.mask, region, painted_screen);
+    }
     m_paintScreenCount = 0;
 
     if (m_overlayItem) {
@@ -12,6 +12,8 @@
 #include "core/colorspace.h"
 #include "scene/scene.h"
 
+#include <QSet>
+
 namespace KWin
 {
 
@@ -77,6 +79,12 @@ public:
         return {nullptr, ColorDescription::sRGB};
     }
 
+    /**
+     * Returns @c true if @a window was painted neither translucent nor transformed in the
+     * last frame, i.e. its opaque region hides the windows below it.
+     */
+    bool isOccluder(const Window *window) const;
+
 Q_SIGNALS:
     void preFrameRender();
     void frameRendered();
@@ -132,6 +140,7 @@ private:
     // how many times finalPaintScreen() has been called
     int m_paintScreenCount = 0;
     PaintContext m_paintContext;
+    QSet<const Window *> m_occluders;
     std::unique_ptr<Item> m_containerItem;
     std::unique_ptr<Item> m_overlayItem;
     std::unique_ptr<DragAndDropIconItem> m_dndIcon;
@@ -18,18 +18,24 @@
 #include "compositor.h"
 #include "core/output.h"
 #include "decorations/decoratedwindow.h"
+#include "frametracer.h"
 #include "scene/itemrenderer_opengl.h"
 #include "shadow.h"
 #include "window.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 
+#include <QCoreApplication>
+#include <QFutureWatcher>
 #include <QMatrix4x4>
 #include <QPainter>
 #include <QStringList>
+#include <QThreadPool>
 #include <QVector2D>
 #include <QVector4D>
+#include <QtConcurrentRun>
 #include <QtMath>
 
 namespace KWin
@@ -42,6 +48,8 @@ namespace KWin
 WorkspaceSceneOpenGL::WorkspaceSceneOpenGL(OpenGLBackend *backend)
     : WorkspaceScene(std::make_unique<ItemRendererOpenGL>(backend->eglDisplayObject()))
     , m_backend(backend)
+    , m_decorationAtlas(std::make_shared<DecorationAtlas>())
+    , m_shadowTextureCache(std::make_shared<ShadowTextureCache>())
 {
 }
 
@@ -72,12 +80,12 @@ OpenGlContext *WorkspaceSceneOpenGL::openglContext() const
 
 std::unique_ptr<DecorationRenderer> WorkspaceSceneOpenGL::createDecorationRenderer(Decoration::DecoratedWindowImpl *impl)
 {
-    return std::make_unique<SceneOpenGLDecorationRenderer>(impl);
+    return std::make_unique<SceneOpenGLDecorationRenderer>(impl, m_decorationAtlas);
 }
 
 std::unique_ptr<ShadowTextureProvider> WorkspaceSceneOpenGL::createShadowTextureProvider(Shadow *shadow)
 {
-    return std::make_unique<OpenGLShadowTextureProvider>(shadow);
+    return std::make_unique<OpenGLShadowTextureProvider>(shadow, m_shadowTextureCache);
 }
 
 bool WorkspaceSceneOpenGL::animationsSupported() const
@@ -173,42 +181,22 @@ std::shared_ptr<GLTexture> DecorationShadowTextureCache::getTexture(ShadowTextur
     return d.texture;
 }
 
-OpenGLShadowTextureProvider::OpenGLShadowTextureProvider(Shadow *shadow)
-    : ShadowTextureProvider(shadow)
-{
-}
-
-OpenGLShadowTextureProvider::~OpenGLShadowTextureProvider()
-{
-    if (m_texture) {
-        Compositor::self()->scene()->makeOpenGLContextCurrent();
-        DecorationShadowTextureCache::instance().unregister(this);
-        m_texture.reset();
-    }
-}
-
-void OpenGLShadowTextureProvider::update()
+static std::shared_ptr<GLTexture> composeShadowTexture(const Shadow *shadow)
 {
-    if (m_shadow->hasDecorationShadow()) {
-        // simplifies a lot by going directly to
-        m_texture = DecorationShadowTextureCache::instance().getTexture(this);
-        return;
-    }
-
-    const QSize top(m_shadow->shadowElement(Shadow::ShadowElementTop).size());
-    const QSize topRight(m_shadow->shadowElement(Shadow::ShadowElementTopRight).size());
-    const QSize right(m_shadow->shadowElement(Shadow::ShadowElementRight).size());
-    const QSize bottom(m_shadow->shadowElement(Shadow::ShadowElementBottom).size());
-    const QSize bottomLeft(m_shadow->shadowElement(Shadow::ShadowElementBottomLeft).size());
-    const QSize left(m_shadow->shadowElement(Shadow::ShadowElementLeft).size());
-    const QSize topLeft(m_shadow->shadowElement(Shadow::ShadowElementTopLeft).size());
-    const QSize bottomRight(m_shadow->shadowElement(Shadow::ShadowElementBottomRight).size());
+    const QSize top(shadow->shadowElement(Shadow::ShadowElementTop).size());
+    const QSize topRight(shadow->shadowElement(Shadow::ShadowElementTopRight).size());
+    const QSize right(shadow->shadowElement(Shadow::ShadowElementRight).size());
+    const QSize bottom(shadow->shadowElement(Shadow::ShadowElementBottom).size());
+    const QSize bottomLeft(shadow->shadowElement(Shadow::ShadowElementBottomLeft).size());
+    const QSize left(shadow->shadowElement(Shadow::ShadowElementLeft).size());
+    const QSize topLeft(shadow->shadowElement(Shadow::ShadowElementTopLeft).size());
+    const QSize bottomRight(shadow->shadowElement(Shadow::ShadowElementBottomRight).size());
 
     const int width = std::max({topLeft.width(), left.width(), bottomLeft.width()}) + std::max(top.width(), bottom.width()) + std::max({topRight.width(), right.width(), bottomRight.width()});
     const int height = std::max({topLeft.height(), top.height(), topRight.height()}) + std::max(left.height(), right.height()) + std::max({bottomLeft.height(), bottom.height(), bottomRight.height()});
 
     if (width == 0 || height == 0) {
-        return;
+        return nullptr;
     }
 
     QImage image(width, height, QImage::Format_ARGB32);
@@ -220,16 +208,16 @@ void OpenGLShadowTextureProvider::update()
     QPainter p;
     p.begin(&image);
 
-    p.drawImage(QRectF(0, 0, topLeft.width(), topLeft.height()), m_shadow->shadowElement(Shadow::ShadowElementTopLeft));
-    p.drawImage(QRectF(innerRectLeft, 0, top.width(), top.height()), m_shadow->shadowElement(Shadow::ShadowElementTop));
-    p.drawImage(QRectF(width - topRight.width(), 0, topRight.width(), topRight.height()), m_shadow->shadowElement(Shadow::ShadowElementTopRight));
+    p.drawImage(QRectF(0, 0, topLeft.width(), topLeft.height()), shadow->shadowElement(Shadow::ShadowElementTopLeft));
+    p.drawImage(QRectF(innerRectLeft, 0, top.width(), top.height()), shadow->shadowElement(Shadow::ShadowElementTop));
+    p.drawImage(QRectF(width - topRight.width(), 0, topRight.width(), topRight.height()), shadow->shadowElement(Shadow::ShadowElementTopRight));
 
-    p.drawImage(QRectF(0, innerRectTop, left.width(), left.height()), m_shadow->shadowElement(Shadow::ShadowElementLeft));
-    p.drawImage(QRectF(width - right.width(), innerRectTop, right.width(), right.height()), m_shadow->shadowElement(Shadow::ShadowElementRight));
+    p.drawImage(QRectF(0, innerRectTop, left.width(), left.height()), shadow->shadowElement(Shadow::ShadowElementLeft));
+    p.drawImage(QRectF(width - right.width(), innerRectTop, right.width(), right.height()), shadow->shadowElement(Shadow::ShadowElementRight));
 
-    p.drawImage(QRectF(0, height - bottomLeft.height(), bottomLeft.width(), bottomLeft.height()), m_shadow->shadowElement(Shadow::ShadowElementBottomLeft));
-    p.drawImage(QRectF(innerRectLeft, height - bottom.height(), bottom.width(), bottom.height()), m_shadow->shadowElement(Shadow::ShadowElementBottom));
-    p.drawImage(QRectF(width - bottomRight.width(), height - bottomRight.height(), bottomRight.width(), bottomRight.height()), m_shadow->shadowElement(Shadow::ShadowElementBottomRight));
+    p.drawImage(QRectF(0, height - bottomLeft.height(), bottomLeft.width(), bottomLeft.height()), shadow->shadowElement(Shadow::ShadowElementBottomLeft));
+    p.drawImage(QRectF(innerRectLeft, height - bottom.height(), bottom.width(), bottom.height()), shadow->shadowElement(Shadow::ShadowElementBottom));
+    p.drawImage(QRectF(width - bottomRight.width(), height - bottomRight.height(), bottomRight.width(), bottomRight.height()), shadow->shadowElement(Shadow::ShadowElementBottomRight));
 
     p.end();
 
@@ -257,23 +245,295 @@ void OpenGLShadowTextureProvider::update()
         }
     }
 
-    m_texture = GLTexture::upload(image);
-    if (!m_texture) {
-        return;
+    auto texture = GLTexture::upload(image);
+    if (!texture) {
+        return nullptr;
     }
-    m_texture->setFilter(GL_LINEAR);
-    m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    texture->setFilter(GL_LINEAR);
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
 
-    if (m_texture->internalFormat() == GL_R8) {
+    if (texture->internalFormat() == GL_R8) {
         // Swizzle red to alpha and all other channels to zero
-        m_texture->bind();
-        m_texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+        texture->bind();
+        texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+    }
+    return texture;
+}
+
+static size_t hashShadowElement(const QImage &image, size_t seed)
+{
+    seed = qHashMulti(seed, image.width(), image.height(), int(image.format()));
+    const qsizetype bytesPerLine = (qsizetype(image.width()) * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        seed = qHashBits(image.constScanLine(y), bytesPerLine, seed);
+    }
+    return seed;
+}
+
+std::shared_ptr<GLTexture> ShadowTextureCache::texture(const Shadow *shadow)
+{
+    QList<QImage> elements;
+    elements.reserve(Shadow::ShadowElementsCount);
+    size_t hash = 0;
+    for (int i = 0; i < Shadow::ShadowElementsCount; ++i) {
+        const QImage &element = shadow->shadowElement(Shadow::ShadowElements(i));
+        hash = hashShadowElement(element, hash);
+        elements.append(element);
+    }
+
+    for (auto it = m_entries.find(hash); it != m_entries.end() && it.key() == hash; ++it) {
+        if (it->elements == elements) {
+            it->lastUsed = ++m_usage;
+            return it->texture;
+        }
+    }
+
+    auto texture = composeShadowTexture(shadow);
+    if (!texture) {
+        return nullptr;
+    }
+    m_entries.insert(hash, Entry{
+                               .elements = elements,
+                               .texture = texture,
+                               .lastUsed = ++m_usage,
+                           });
+    evict();
+    return texture;
+}
+
+void ShadowTextureCache::evict()
+{
+    // Textures that are still in use stay in the cache, only the unused ones are limited.
+    while (true) {
+        auto oldest = m_entries.end();
+        int unused = 0;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->texture.use_count() > 1) {
+                continue;
+            }
+            unused++;
+            if (oldest == m_entries.end() || it->lastUsed < oldest->lastUsed) {
+                oldest = it;
+            }
+        }
+        if (unused <= MaxUnusedTextures) {
+            return;
+        }
+        m_entries.erase(oldest);
+    }
+}
+
+OpenGLShadowTextureProvider::OpenGLShadowTextureProvider(Shadow *shadow, const std::shared_ptr<ShadowTextureCache> &cache)
+    : ShadowTextureProvider(shadow)
+    , m_cache(cache)
+{
+}
+
+OpenGLShadowTextureProvider::~OpenGLShadowTextureProvider()
+{
+    if (m_texture) {
+        Compositor::self()->scene()->makeOpenGLContextCurrent();
+        DecorationShadowTextureCache::instance().unregister(this);
+        m_texture.reset();
+    }
+}
+
+void OpenGLShadowTextureProvider::update()
+{
+    if (m_shadow->hasDecorationShadow()) {
+        // simplifies a lot by going directly to
+        m_texture = DecorationShadowTextureCache::instance().getTexture(this);
+        return;
+    }
+
+    m_texture = m_cache->texture(m_shadow);
+}
+
+static int align(int value, int align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Keep the pages small, a single decorated window shouldn't cost much more video memory than
+// with a texture of its own. Wider decorations get a page as wide as they are.
+static const QSize s_atlasPageSize(2048, 512);
+static const int s_atlasSpanAlignment = 16;
+static const int s_atlasShelfAlignment = 4;
+
+static QSize atlasAllocationSize(const QSize &size)
+{
+    return QSize(align(size.width(), s_atlasSpanAlignment), align(size.height(), s_atlasShelfAlignment));
+}
+
+DecorationAtlas::DecorationAtlas()
+{
+}
+
+DecorationAtlas::~DecorationAtlas()
+{
+}
+
+std::optional<DecorationAtlas::Slot> DecorationAtlas::allocate(const QSize &size)
+{
+    const QSize allocationSize = atlasAllocationSize(size);
+    for (const auto &page : m_pages) {
+        if (const auto rect = page->allocate(allocationSize)) {
+            return Slot{
+                .texture = page->texture.get(),
+                .rect = QRect(rect->topLeft(), size),
+            };
+        }
+    }
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    const QSize pageSize = s_atlasPageSize.expandedTo(allocationSize);
+    if (pageSize.width() > maxTextureSize || pageSize.height() > maxTextureSize) {
+        return std::nullopt;
+    }
+
+    auto page = std::make_unique<Page>();
+    page->texture = GLTexture::allocate(GL_RGBA8, pageSize);
+    if (!page->texture) {
+        return std::nullopt;
     }
+    page->texture->setContentTransform(OutputTransform::FlipY);
+    page->texture->setFilter(GL_LINEAR);
+    page->texture->setWrapMode(GL_CLAMP_TO_EDGE);
+
+    const auto rect = page->allocate(allocationSize);
+    Q_ASSERT(rect);
+    const Slot slot{
+        .texture = page->texture.get(),
+        .rect = QRect(rect->topLeft(), size),
+    };
+    m_pages.push_back(std::move(page));
+    return slot;
+}
+
+void DecorationAtlas::release(const Slot &slot)
+{
+    const auto it = std::find_if(m_pages.begin(), m_pages.end(), [&slot](const auto &page) {
+        return page->texture.get() == slot.texture;
+    });
+    if (it == m_pages.end()) {
+        return;
+    }
+    (*it)->release(QRect(slot.rect.topLeft(), atlasAllocationSize(slot.rect.size())));
+    if (!(*it)->allocationCount) {
+        m_pages.erase(it);
+    }
+}
+
+bool DecorationAtlas::Shelf::isEmpty(int pageWidth) const
+{
+    return freeSpans.size() == 1 && freeSpans.constFirst().x == 0 && freeSpans.constFirst().width == pageWidth;
+}
+
+std::optional<QRect> DecorationAtlas::Page::allocate(const QSize &size)
+{
+    const int pageWidth = texture->width();
+    if (size.width() > pageWidth) {
+        return std::nullopt;
+    }
+
+    for (Shelf &shelf : shelves) {
+        if (shelf.bucket != size.height()) {
+            continue;
+        }
+        for (auto span = shelf.freeSpans.begin(); span != shelf.freeSpans.end(); ++span) {
+            if (span->width < size.width()) {
+                continue;
+            }
+            const QRect rect(span->x, shelf.y, size.width(), size.height());
+            span->x += size.width();
+            span->width -= size.width();
+            if (!span->width) {
+                shelf.freeSpans.erase(span);
+            }
+            allocationCount++;
+            return rect;
+        }
+    }
+
+    // Reuse a shelf that has been vacated by decorations of another size, or start a new one.
+    auto vacated = std::find_if(shelves.begin(), shelves.end(), [&size, pageWidth](const Shelf &shelf) {
+        return shelf.height >= size.height() && shelf.isEmpty(pageWidth);
+    });
+    if (vacated != shelves.end()) {
+        vacated->bucket = size.height();
+    } else {
+        const int y = shelves.isEmpty() ? 0 : shelves.constLast().y + shelves.constLast().height;
+        if (y + size.height() > texture->height()) {
+            return std::nullopt;
+        }
+        shelves.append(Shelf{
+            .y = y,
+            .height = size.height(),
+            .bucket = size.height(),
+            .freeSpans = {Span{.x = 0, .width = pageWidth}},
+        });
+    }
+    return allocate(size);
 }
 
-SceneOpenGLDecorationRenderer::SceneOpenGLDecorationRenderer(Decoration::DecoratedWindowImpl *client)
+void DecorationAtlas::Page::release(const QRect &rect)
+{
+    const auto shelf = std::find_if(shelves.begin(), shelves.end(), [&rect](const Shelf &shelf) {
+        return shelf.y == rect.y();
+    });
+    if (shelf == shelves.end()) {
+        return;
+    }
+
+    auto next = std::find_if(shelf->freeSpans.begin(), shelf->freeSpans.end(), [&rect](const Span &span) {
+        return span.x > rect.x();
+    });
+    next = shelf->freeSpans.insert(next, Span{.x = rect.x(), .width = rect.width()});
+    if (auto following = std::next(next); following != shelf->freeSpans.end() && next->x + next->width == following->x) {
+        next->width += following->width;
+        shelf->freeSpans.erase(following);
+    }
+    if (next != shelf->freeSpans.begin()) {
+        auto previous = std::prev(next);
+        if (previous->x + previous->width == next->x) {
+            previous->width += next->width;
+            shelf->freeSpans.erase(next);
+        }
+    }
+    allocationCount--;
+
+    // Give the space of empty shelves at the end of the page back.
+    const int pageWidth = texture->width();
+    while (!shelves.isEmpty() && shelves.constLast().isEmpty(pageWidth)) {
+        shelves.removeLast();
+    }
+}
+
+static QThreadPool *decorationRasterizerPool()
+{
+    // A single thread keeps the tiles of a decoration in the order they were recorded in.
+    static QThreadPool *pool = [] {
+        auto pool = new QThreadPool(QCoreApplication::instance());
+        pool->setObjectName(QStringLiteral("DecorationRasterizer"));
+        pool->setMaxThreadCount(1);
+        return pool;
+    }();
+    return pool;
+}
+
+static QImage::Format decorationUploadFormat()
+{
+    const auto context = OpenGlContext::currentContext();
+    if (context && context->isOpenGLES() && !context->supportsARGB32Textures()) {
+        return QImage::Format_RGBA8888_Premultiplied;
+    }
+    return QImage::Format_ARGB32_Premultiplied;
+}
+
+SceneOpenGLDecorationRenderer::SceneOpenGLDecorationRenderer(Decoration::DecoratedWindowImpl *client, const std::shared_ptr<DecorationAtlas> &atlas)
     : DecorationRenderer(client)
-    , m_texture()
+    , m_atlas(atlas)
 {
 }
 
@@ -282,6 +542,9 @@ SceneOpenGLDecorationRenderer::~SceneOpenGLDecorationRenderer()
     if (WorkspaceScene *scene = Compositor::self()->scene()) {
         scene->makeOpenGLContextCurrent();
     }
+    if (m_slot) {
+        m_atlas->release(*m_slot);
+    }
 }
 
 static void clamp_row(int left, int width, int right, const uint32_t *src, uint32_t *dest)
@@ -334,14 +597,23 @@ static void clamp(QImage &image, const QRect &viewport)
     }
 }
 
+// Damage with more rectangles than this is painted as a single bounding rectangle per part.
+static const int s_maxTilesPerPart = 4;
+
 void SceneOpenGLDecorationRenderer::render(const QRegion &region)
 {
+    // A reallocated texture has no content yet, so paint it right away instead of showing
+    // garbage until the worker thread is done. Tiles that are still being rasterized for the
+    // old texture are discarded.
+    bool synchronous = false;
     if (areImageSizesDirty()) {
         resizeTexture();
         resetImageSizesDirty();
+        m_generation++;
+        synchronous = true;
     }
 
-    if (!m_texture) {
+    if (!m_slot) {
         // for invalid sizes we get no texture, see BUG 361551
         return;
     }
@@ -354,36 +626,101 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
     const int bottomHeight = std::round(bottom.height() * devicePixelRatio);
     const int leftWidth = std::round(left.width() * devicePixelRatio);
 
-    const QPoint topPosition(0, 0);
-    const QPoint bottomPosition(0, topPosition.y() + topHeight + (2 * TexturePad));
-    const QPoint leftPosition(0, bottomPosition.y() + bottomHeight + (2 * TexturePad));
-    const QPoint rightPosition(0, leftPosition.y() + leftWidth + (2 * TexturePad));
+    const QPoint topPosition = textureOrigin();
+    const QPoint bottomPosition(topPosition.x(), topPosition.y() + topHeight + (2 * TexturePad));
+    const QPoint leftPosition(topPosition.x(), bottomPosition.y() + bottomHeight + (2 * TexturePad));
+    const QPoint rightPosition(topPosition.x(), leftPosition.y() + leftWidth + (2 * TexturePad));
+
+    QList<DecorationTile> tiles;
+    auto recordDamage = [&](const QRectF &partRect, const QPoint &position, bool rotated) {
+        const QRegion damage = region & partRect.toAlignedRect();
+        if (damage.rectCount() > s_maxTilesPerPart) {
+            recordPart(tiles, partRect.intersected(damage.boundingRect()), partRect, position, devicePixelRatio, rotated);
+        } else {
+            for (const QRect &dirtyRect : damage) {
+                recordPart(tiles, partRect.intersected(dirtyRect), partRect, position, devicePixelRatio, rotated);
+            }
+        }
+    };
+    recordDamage(top, topPosition, false);
+    recordDamage(bottom, bottomPosition, false);
+    recordDamage(left, leftPosition, true);
+    recordDamage(right, rightPosition, true);
+
+    if (tiles.isEmpty()) {
+        return;
+    }
 
-    const QRect dirtyRect = region.boundingRect();
+    if (synchronous) {
+        for (DecorationTile &tile : tiles) {
+            rasterize(tile);
+        }
+        upload(tiles);
+        return;
+    }
 
-    renderPart(top.intersected(dirtyRect), top, topPosition, devicePixelRatio);
-    renderPart(bottom.intersected(dirtyRect), bottom, bottomPosition, devicePixelRatio);
-    renderPart(left.intersected(dirtyRect), left, leftPosition, devicePixelRatio, true);
-    renderPart(right.intersected(dirtyRect), right, rightPosition, devicePixelRatio, true);
+    auto watcher = new QFutureWatcher<QList<DecorationTile>>(this);
+    connect(watcher, &QFutureWatcher<QList<DecorationTile>>::finished, this, [this, watcher, generation = m_generation]() {
+        watcher->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        if (WorkspaceScene *scene = Compositor::self()->scene()) {
+            scene->makeOpenGLContextCurrent();
+        }
+        Q_EMIT damaged(upload(watcher->result()));
+    });
+    watcher->setFuture(QtConcurrent::run(decorationRasterizerPool(), [tiles = std::move(tiles)]() mutable {
+        for (DecorationTile &tile : tiles) {
+            rasterize(tile);
+        }
+        return tiles;
+    }));
 }
 
-void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF &partRect,
+void SceneOpenGLDecorationRenderer::recordPart(QList<DecorationTile> &tiles, const QRectF &rect, const QRectF &partRect,
                                                const QPoint &textureOffset,
                                                qreal devicePixelRatio, bool rotated)
 {
-    if (!rect.isValid() || !m_texture) {
+    if (!rect.isValid()) {
         return;
     }
+
+    DecorationTile tile{
+        .rect = rect,
+        .partRect = partRect,
+        .textureOffset = textureOffset,
+        .devicePixelRatio = devicePixelRatio,
+        .rotated = rotated,
+        .uploadFormat = decorationUploadFormat(),
+    };
+
+    // Only record the paint commands here, the decoration lives on the main thread. The
+    // picture is recorded relative to the top left corner of the tile.
+    QPainter painter(&tile.picture);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(-rect.topLeft());
+    renderToPainter(&painter, rect);
+    painter.end();
+
+    tiles.append(std::move(tile));
+}
+
+void SceneOpenGLDecorationRenderer::rasterize(DecorationTile &tile)
+{
+    frameTraceScope("Rasterize decoration");
+
     // We allow partial decoration updates and it might just so happen that the
     // dirty region is completely contained inside the decoration part, i.e.
     // the dirty region doesn't touch any of the decoration's edges. In that
     // case, we should **not** pad the dirty region.
-    const QMargins padding = texturePadForPart(rect, partRect);
+    const QMargins padding = texturePadForPart(tile.rect, tile.partRect);
     int verticalPadding = padding.top() + padding.bottom();
     int horizontalPadding = padding.left() + padding.right();
 
-    QSize imageSize(toNativeSize(rect.width()), toNativeSize(rect.height()));
-    if (rotated) {
+    const qreal devicePixelRatio = tile.devicePixelRatio;
+    QSize imageSize(std::round(tile.rect.width() * devicePixelRatio), std::round(tile.rect.height() * devicePixelRatio));
+    if (tile.rotated) {
         imageSize = QSize(imageSize.height(), imageSize.width());
     }
     QSize paddedImageSize = imageSize;
@@ -400,26 +737,50 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRectF &rect, const QRectF
     painter.setRenderHint(QPainter::Antialiasing);
     painter.setClipRect(padClip);
     painter.translate(padding.left(), padding.top());
-    if (rotated) {
+    if (tile.rotated) {
         painter.translate(0, imageSize.height());
         painter.rotate(-90);
     }
     painter.scale(devicePixelRatio, devicePixelRatio);
-    painter.translate(-rect.topLeft());
-    renderToPainter(&painter, rect);
+    painter.drawPicture(0, 0, tile.picture);
     painter.end();
+    tile.picture = QPicture();
 
     // fill padding pixels by copying from the neighbour row
     clamp(image, padClip);
 
-    QPoint dirtyOffset = ((rect.topLeft() - partRect.topLeft()) * devicePixelRatio).toPoint();
+    QPoint dirtyOffset = ((tile.rect.topLeft() - tile.partRect.topLeft()) * devicePixelRatio).toPoint();
     if (padding.top() == 0) {
         dirtyOffset.ry() += TexturePad;
     }
     if (padding.left() == 0) {
         dirtyOffset.rx() += TexturePad;
     }
-    m_texture->update(image, image.rect(), textureOffset + dirtyOffset);
+
+    // Convert the image now, so the main thread only has to upload it.
+    if (image.format() != tile.uploadFormat) {
+        image.convertTo(tile.uploadFormat);
+    }
+    tile.image = image;
+    tile.imageOffset = tile.textureOffset + dirtyOffset;
+}
+
+QRegion SceneOpenGLDecorationRenderer::upload(const QList<DecorationTile> &tiles)
+{
+    QRegion damage;
+    if (!m_slot) {
+        return damage;
+    }
+    for (const DecorationTile &tile : tiles) {
+        m_slot->texture->update(tile.image, tile.image.rect(), tile.imageOffset);
+        damage += tile.rect.toAlignedRect();
+    }
+    return damage;
+}
+
+QPoint SceneOpenGLDecorationRenderer::textureOrigin() const
+{
+    return m_slot ? m_slot->rect.topLeft() : QPoint(0, 0);
 }
 
 const QMargins SceneOpenGLDecorationRenderer::texturePadForPart(
@@ -441,11 +802,6 @@ const QMargins SceneOpenGLDecorationRenderer::texturePadForPart(
     return result;
 }
 
-static int align(int value, int align)
-{
-    return (value + align - 1) & ~(align - 1);
-}
-
 void SceneOpenGLDecorationRenderer::resizeTexture()
 {
     QRectF left, top, right, bottom;
@@ -457,23 +813,19 @@ void SceneOpenGLDecorationRenderer::resizeTexture()
 
     size.rheight() += 4 * (2 * TexturePad);
     size.rwidth() += 2 * TexturePad;
-    size.rwidth() = align(size.width(), 128);
 
-    if (m_texture && m_texture->size() == size) {
+    if (m_slot && m_slot->rect.size() == size) {
         return;
     }
 
+    if (m_slot) {
+        m_atlas->release(*m_slot);
+        m_slot.reset();
+    }
     if (!size.isEmpty()) {
-        m_texture = GLTexture::allocate(GL_RGBA8, size);
-        if (!m_texture) {
-            return;
-        }
-        m_texture->setContentTransform(OutputTransform::FlipY);
-        m_texture->setFilter(GL_LINEAR);
-        m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-    } else {
-        m_texture.reset();
+        m_slot = m_atlas->allocate(size);
     }
+    Q_EMIT textureOriginChanged();
 }
 
 int SceneOpenGLDecorationRenderer::toNativeSize(double size) const
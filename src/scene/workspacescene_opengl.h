@@ -18,9 +18,15 @@
 
 #include "opengl/glutils.h"
 
+#include <QPicture>
+
+#include <optional>
+
 namespace KWin
 {
 class OpenGLBackend;
+class DecorationAtlas;
+class ShadowTextureCache;
 
 class KWIN_EXPORT WorkspaceSceneOpenGL : public WorkspaceScene
 {
@@ -47,6 +53,8 @@ public:
 
 private:
     OpenGLBackend *m_backend;
+    std::shared_ptr<DecorationAtlas> m_decorationAtlas;
+    std::shared_ptr<ShadowTextureCache> m_shadowTextureCache;
     GLuint vao = 0;
 };
 
@@ -59,7 +67,7 @@ private:
 class OpenGLShadowTextureProvider : public ShadowTextureProvider
 {
 public:
-    explicit OpenGLShadowTextureProvider(Shadow *shadow);
+    explicit OpenGLShadowTextureProvider(Shadow *shadow, const std::shared_ptr<ShadowTextureCache> &cache);
     ~OpenGLShadowTextureProvider() override;
 
     GLTexture *shadowTexture()
@@ -70,9 +78,105 @@ public:
     void update() override;
 
 private:
+    std::shared_ptr<ShadowTextureCache> m_cache;
     std::shared_ptr<GLTexture> m_texture;
 };
 
+/**
+ * The ShadowTextureCache class shares the textures of client-provided shadows. Toolkits give
+ * all their menus and tooltips the same shadow, so textures are looked up by the content of
+ * the shadow elements rather than by window. A few textures that are not used anymore are
+ * kept around, so opening a popup again doesn't compose and upload its shadow again.
+ */
+class ShadowTextureCache
+{
+public:
+    static constexpr int MaxUnusedTextures = 8;
+
+    std::shared_ptr<GLTexture> texture(const Shadow *shadow);
+
+private:
+    struct Entry
+    {
+        QList<QImage> elements;
+        std::shared_ptr<GLTexture> texture;
+        uint64_t lastUsed = 0;
+    };
+
+    void evict();
+
+    QMultiHash<size_t, Entry> m_entries;
+    uint64_t m_usage = 0;
+};
+
+/**
+ * The DecorationAtlas class packs the textures of server-side decorations into a few large
+ * textures, so decorated windows don't need a texture each. Decorations are placed on shelves
+ * of equal height, so decorations of the same size, e.g. inactive windows that use the same
+ * theme, share shelves and pack tightly.
+ */
+class DecorationAtlas
+{
+public:
+    struct Slot
+    {
+        GLTexture *texture = nullptr;
+        QRect rect;
+    };
+
+    DecorationAtlas();
+    ~DecorationAtlas();
+
+    std::optional<Slot> allocate(const QSize &size);
+    void release(const Slot &slot);
+
+private:
+    struct Span
+    {
+        int x;
+        int width;
+    };
+    struct Shelf
+    {
+        int y;
+        int height;
+        int bucket;
+        QList<Span> freeSpans;
+
+        bool isEmpty(int pageWidth) const;
+    };
+    struct Page
+    {
+        std::unique_ptr<GLTexture> texture;
+        QList<Shelf> shelves;
+        int allocationCount = 0;
+
+        std::optional<QRect> allocate(const QSize &size);
+        void release(const QRect &rect);
+    };
+
+    std::vector<std::unique_ptr<Page>> m_pages;
+};
+
+/**
+ * A piece of a decoration part that is rasterized off the main thread. The decoration is
+ * recorded into a QPicture on the main thread, the rasterization and the conversion to
+ * the upload format happen on a worker thread.
+ */
+struct DecorationTile
+{
+    QPicture picture;
+    QRectF rect;
+    QRectF partRect;
+    QPoint textureOffset;
+    qreal devicePixelRatio = 1;
+    bool rotated = false;
+    QImage::Format uploadFormat = QImage::Format_ARGB32_Premultiplied;
+
+    QImage image;
+    QPoint imageOffset;
+};
+
 class SceneOpenGLDecorationRenderer : public DecorationRenderer
 {
     Q_OBJECT
@@ -84,26 +188,28 @@ public:
         Bottom,
         Count
     };
-    explicit SceneOpenGLDecorationRenderer(Decoration::DecoratedWindowImpl *client);
+    explicit SceneOpenGLDecorationRenderer(Decoration::DecoratedWindowImpl *client, const std::shared_ptr<DecorationAtlas> &atlas);
     ~SceneOpenGLDecorationRenderer() override;
 
     void render(const QRegion &region) override;
+    QPoint textureOrigin() const override;
 
-    GLTexture *texture()
-    {
-        return m_texture.get();
-    }
     GLTexture *texture() const
     {
-        return m_texture.get();
+        return m_slot ? m_slot->texture : nullptr;
     }
 
+    static void rasterize(DecorationTile &tile);
+
 private:
-    void renderPart(const QRectF &rect, const QRectF &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated = false);
+    void recordPart(QList<DecorationTile> &tiles, const QRectF &rect, const QRectF &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated = false);
+    QRegion upload(const QList<DecorationTile> &tiles);
     static const QMargins texturePadForPart(const QRectF &rect, const QRectF &partRect);
     void resizeTexture();
     int toNativeSize(double size) const;
-    std::unique_ptr<GLTexture> m_texture;
+    std::shared_ptr<DecorationAtlas> m_atlas;
+    std::optional<DecorationAtlas::Slot> m_slot;
+    uint m_generation = 0;
 };
 
 } // namespace
@@ -8,11 +8,14 @@
 
 #include "windowthumbnailitem.h"
 #include "compositor.h"
+#include "core/output.h"
 #include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
 #include "effect/effect.h"
 #include "opengl/glframebuffer.h"
+#include "options.h"
 #include "scene/itemrenderer.h"
 #include "scene/windowitem.h"
 #include "scene/workspacescene.h"
@@ -28,6 +31,9 @@
 #include <QSGImageNode>
 #include <QSGTextureProvider>
 
+#include <bit>
+#include <cmath>
+
 namespace KWin
 {
 
@@ -41,13 +47,15 @@ WindowThumbnailSource::WindowThumbnailSource(QQuickWindow *view, Window *handle)
     : m_view(view)
     , m_handle(handle)
 {
-    connect(handle, &Window::frameGeometryChanged, this, [this]() {
-        m_dirty = true;
-        Q_EMIT changed();
-    });
-    connect(handle, &Window::damaged, this, [this]() {
-        m_dirty = true;
-        Q_EMIT changed();
+    connect(handle, &Window::frameGeometryChanged, this, &WindowThumbnailSource::markDirty);
+    connect(handle, &Window::damaged, this, &WindowThumbnailSource::markDirty);
+
+    // If an update has been throttled, make sure that there will be a frame to pick it up.
+    m_throttleTimer.setSingleShot(true);
+    connect(&m_throttleTimer, &QTimer::timeout, this, [this]() {
+        if (m_handle && m_handle->output()) {
+            m_handle->output()->renderLoop()->scheduleRepaint();
+        }
     });
 
     connect(Compositor::self()->scene(), &WorkspaceScene::preFrameRender, this, &WindowThumbnailSource::update);
@@ -108,30 +116,92 @@ WindowThumbnailSource::Frame WindowThumbnailSource::acquire()
     };
 }
 
+void WindowThumbnailSource::setRequestedSize(const QObject *consumer, const QSize &size)
+{
+    QSize &requestedSize = m_requestedSizes[consumer];
+    if (requestedSize == size) {
+        return;
+    }
+    requestedSize = size;
+
+    // Shrinking can wait until the window is damaged next time, but a consumer that
+    // has grown should not have to look at a blurry thumbnail.
+    if (m_offscreenTexture) {
+        const QSize textureSize = m_offscreenTexture->size();
+        if (size.width() > textureSize.width() || size.height() > textureSize.height()) {
+            markDirty();
+        }
+    }
+}
+
+void WindowThumbnailSource::removeConsumer(const QObject *consumer)
+{
+    m_requestedSizes.erase(consumer);
+}
+
+QSize WindowThumbnailSource::requestedSize() const
+{
+    QSize size;
+    for (const auto &[consumer, requestedSize] : m_requestedSizes) {
+        size = size.expandedTo(requestedSize);
+    }
+    return size;
+}
+
+void WindowThumbnailSource::markDirty()
+{
+    m_dirty = true;
+    Q_EMIT changed();
+}
+
 void WindowThumbnailSource::update()
 {
-    if (m_acquireFence || !m_dirty || !m_handle) {
+    if (m_acquireFence || !m_dirty || !m_handle || m_throttleTimer.isActive()) {
         return;
     }
     Q_ASSERT(m_view);
 
+    if (const int maxFrameRate = options->thumbnailMaxFrameRate(); maxFrameRate > 0 && m_lastUpdate.isValid()) {
+        const qint64 interval = 1000 / maxFrameRate;
+        const qint64 elapsed = m_lastUpdate.elapsed();
+        if (elapsed < interval) {
+            m_throttleTimer.start(interval - elapsed);
+            return;
+        }
+    }
+
     const QRectF geometry = m_handle->visibleGeometry();
     const qreal devicePixelRatio = m_view->devicePixelRatio();
-    const QSize textureSize = geometry.toAlignedRect().size() * devicePixelRatio;
+    const QSize fullSize = geometry.toAlignedRect().size() * devicePixelRatio;
+    if (fullSize.isEmpty()) {
+        return;
+    }
+
+    // Render the thumbnail only as large as the biggest consumer needs it. The level of
+    // detail is rounded up to 1/8 steps so an animated thumbnail doesn't reallocate its
+    // texture every frame.
+    qreal levelOfDetail = 1.0;
+    if (const QSize requested = requestedSize(); !requested.isEmpty()) {
+        levelOfDetail = std::max(qreal(requested.width()) / fullSize.width(), qreal(requested.height()) / fullSize.height());
+        levelOfDetail = std::clamp(std::ceil(levelOfDetail * 8) / 8, 0.125, 1.0);
+    }
+    const qreal renderScale = devicePixelRatio * levelOfDetail;
+    const QSize textureSize = (geometry.toAlignedRect().size() * renderScale).expandedTo(QSize(1, 1));
 
     if (!m_offscreenTexture || m_offscreenTexture->size() != textureSize) {
-        m_offscreenTexture = GLTexture::allocate(GL_RGBA8, textureSize);
+        const int levels = std::bit_width(uint(std::max(textureSize.width(), textureSize.height())));
+        m_offscreenTexture = GLTexture::allocate(GL_RGBA8, textureSize, levels);
         if (!m_offscreenTexture) {
             return;
         }
         m_offscreenTexture->setContentTransform(OutputTransform::FlipY);
-        m_offscreenTexture->setFilter(GL_LINEAR);
+        m_offscreenTexture->setFilter(GL_LINEAR_MIPMAP_LINEAR);
         m_offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
         m_offscreenTarget = std::make_unique<GLFramebuffer>(m_offscreenTexture.get());
     }
 
     RenderTarget offscreenRenderTarget(m_offscreenTarget.get());
-    RenderViewport offscreenViewport(geometry, devicePixelRatio, offscreenRenderTarget);
+    RenderViewport offscreenViewport(geometry, renderScale, offscreenRenderTarget);
     GLFramebuffer::pushFramebuffer(m_offscreenTarget.get());
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -143,10 +213,16 @@ void WindowThumbnailSource::update()
     Compositor::self()->scene()->renderer()->renderItem(offscreenRenderTarget, offscreenViewport, m_handle->windowItem(), mask, infiniteRegion(), WindowPaintData{});
     GLFramebuffer::popFramebuffer();
 
+    // Consumers that are smaller than the largest one sample the thumbnail from the mip chain.
+    m_offscreenTexture->bind();
+    m_offscreenTexture->generateMipmaps();
+    m_offscreenTexture->unbind();
+
     // The fence is needed to avoid the case where qtquick renderer starts using
     // the texture while all rendering commands to it haven't completed yet.
     m_dirty = false;
     m_acquireFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_lastUpdate.start();
 
     Q_EMIT changed();
 }
@@ -183,8 +259,9 @@ void ThumbnailTextureProvider::setTexture(const std::shared_ptr<GLTexture> &nati
         m_nativeTexture = nativeTexture;
         m_texture.reset(QNativeInterface::QSGOpenGLTexture::fromNative(textureId, m_window,
                                                                        nativeTexture->size(),
-                                                                       QQuickWindow::TextureHasAlphaChannel));
+                                                                       QQuickWindow::TextureHasAlphaChannel | QQuickWindow::TextureHasMipmaps));
         m_texture->setFiltering(QSGTexture::Linear);
+        m_texture->setMipmapFiltering(QSGTexture::Linear);
         m_texture->setHorizontalWrapMode(QSGTexture::ClampToEdge);
         m_texture->setVerticalWrapMode(QSGTexture::ClampToEdge);
     }
@@ -230,6 +307,9 @@ WindowThumbnailItem::WindowThumbnailItem(QQuickItem *parent)
 
 WindowThumbnailItem::~WindowThumbnailItem()
 {
+    if (m_source) {
+        m_source->removeConsumer(this);
+    }
     if (m_provider) {
         if (window()) {
             window()->scheduleRenderJob(new ThumbnailTextureProviderCleanupJob(m_provider),
@@ -257,6 +337,14 @@ void WindowThumbnailItem::itemChange(QQuickItem::ItemChange change, const QQuick
     QQuickItem::itemChange(change, value);
 }
 
+void WindowThumbnailItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        updateRequestedSize();
+    }
+}
+
 bool WindowThumbnailItem::isTextureProvider() const
 {
     return true;
@@ -275,16 +363,27 @@ QSGTextureProvider *WindowThumbnailItem::textureProvider() const
 
 void WindowThumbnailItem::resetSource()
 {
+    if (m_source) {
+        disconnect(m_source.get(), &WindowThumbnailSource::changed, this, &WindowThumbnailItem::update);
+        m_source->removeConsumer(this);
+    }
     m_source.reset();
 }
 
 void WindowThumbnailItem::updateSource()
 {
+    resetSource();
     if (useGlThumbnails() && window() && m_client) {
         m_source = WindowThumbnailSource::getOrCreate(window(), m_client);
         connect(m_source.get(), &WindowThumbnailSource::changed, this, &WindowThumbnailItem::update);
-    } else {
-        m_source.reset();
+        updateRequestedSize();
+    }
+}
+
+void WindowThumbnailItem::updateRequestedSize()
+{
+    if (m_source && window()) {
+        m_source->setRequestedSize(this, (paintedRect().size() * window()->devicePixelRatio()).toSize());
     }
 }
 
@@ -323,6 +422,7 @@ QSGNode *WindowThumbnailItem::updatePaintNode(QSGNode *oldNode, QQuickItem::Upda
     if (!node) {
         node = window()->createImageNode();
         node->setFiltering(QSGTexture::Linear);
+        node->setMipmapFiltering(QSGTexture::Linear);
     }
     node->setTexture(m_provider->texture());
     node->setTextureCoordinatesTransform(QSGImageNode::NoTransform);
@@ -367,11 +467,15 @@ void WindowThumbnailItem::setClient(Window *client)
     if (m_client) {
         disconnect(m_client, &Window::frameGeometryChanged,
                    this, &WindowThumbnailItem::updateImplicitSize);
+        disconnect(m_client, &Window::frameGeometryChanged,
+                   this, &WindowThumbnailItem::updateRequestedSize);
     }
     m_client = client;
     if (m_client) {
         connect(m_client, &Window::frameGeometryChanged,
                 this, &WindowThumbnailItem::updateImplicitSize);
+        connect(m_client, &Window::frameGeometryChanged,
+                this, &WindowThumbnailItem::updateRequestedSize);
         setWId(m_client->internalId());
     } else {
         setWId(QUuid());
@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QQuickItem>
+#include <QTimer>
 #include <QUuid>
 
 #include <epoxy/gl.h>
@@ -38,17 +40,30 @@ public:
 
     Frame acquire();
 
+    /**
+     * Sets the size in device pixels at which the @a consumer is going to present the
+     * thumbnail. The thumbnail is rendered at the largest size requested by any consumer,
+     * but never larger than the window itself.
+     */
+    void setRequestedSize(const QObject *consumer, const QSize &size);
+    void removeConsumer(const QObject *consumer);
+
 Q_SIGNALS:
     void changed();
 
 private:
     void update();
+    void markDirty();
+    QSize requestedSize() const;
 
     QPointer<QQuickWindow> m_view;
     QPointer<Window> m_handle;
 
     std::shared_ptr<GLTexture> m_offscreenTexture;
     std::unique_ptr<GLFramebuffer> m_offscreenTarget;
+    std::map<const QObject *, QSize> m_requestedSizes;
+    QElapsedTimer m_lastUpdate;
+    QTimer m_throttleTimer;
     GLsync m_acquireFence = 0;
     bool m_dirty = true;
 };
@@ -76,6 +91,7 @@ public:
 protected:
     void releaseResources() override;
     void itemChange(QQuickItem::ItemChange change, const QQuickItem::ItemChangeData &value) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
 Q_SIGNALS:
     void wIdChanged();
@@ -85,6 +101,7 @@ private:
     QImage fallbackImage() const;
     QRectF paintedRect() const;
     void updateImplicitSize();
+    void updateRequestedSize();
     void updateSource();
     void resetSource();
 
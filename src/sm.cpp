@@ -24,7 +24,9 @@
 #include "x11window.h"
 #endif
 
+#include <QFutureWatcher>
 #include <QSessionManager>
+#include <QtConcurrentRun>
 #if KWIN_BUILD_NOTIFICATIONS
 #include <KLocalizedString>
 #include <KNotification>
@@ -83,22 +85,87 @@ static WindowType txtToWindowType(const char *txt)
     return WindowType::Undefined;
 }
 
+/**
+ * The config entries of a session, in the order they are written.
+ */
+using SessionEntries = QList<std::pair<QString, QVariant>>;
+
+#if KWIN_BUILD_X11
+/**
+ * Records the state of client \a c as the session entries with number \a num.
+ *
+ * The entries are written later, possibly in another thread, so the window state must be
+ * read here.
+ */
+static void snapshotClient(SessionEntries *entries, int num, X11Window *c, const QList<Window *> &stackingOrder)
+{
+    c->setSessionActivityOverride(false); // make sure we get the real values
+    const QString n = QString::number(num);
+    auto add = [entries, &n](QLatin1String key, const QVariant &value) {
+        entries->append({QString(key + n), value});
+    };
+    add(QLatin1String("sessionId"), QString::fromUtf8(c->sessionId()));
+    add(QLatin1String("windowRole"), c->windowRole());
+    add(QLatin1String("wmCommand"), c->wmCommand());
+    add(QLatin1String("resourceName"), c->resourceName());
+    add(QLatin1String("resourceClass"), c->resourceClass());
+    add(QLatin1String("geometry"), QRectF(c->calculateGravitation(true), c->clientSize()).toRect()); // FRAME
+    add(QLatin1String("restore"), c->geometryRestore());
+    add(QLatin1String("fsrestore"), c->fullscreenGeometryRestore());
+    add(QLatin1String("maximize"), (int)c->maximizeMode());
+    add(QLatin1String("fullscreen"), (int)c->fullScreenMode());
+    add(QLatin1String("desktop"), c->desktopId());
+    // the config entry is called "iconified" for back. comp. reasons
+    // (kconf_update script for updating session files would be too complicated)
+    add(QLatin1String("iconified"), c->isMinimized());
+    add(QLatin1String("opacity"), c->opacity());
+    // the config entry is called "sticky" for back. comp. reasons
+    add(QLatin1String("sticky"), c->isOnAllDesktops());
+    add(QLatin1String("shaded"), c->isShade());
+    // the config entry is called "staysOnTop" for back. comp. reasons
+    add(QLatin1String("staysOnTop"), c->keepAbove());
+    add(QLatin1String("keepBelow"), c->keepBelow());
+    add(QLatin1String("skipTaskbar"), c->originalSkipTaskbar());
+    add(QLatin1String("skipPager"), c->skipPager());
+    add(QLatin1String("skipSwitcher"), c->skipSwitcher());
+    // not really just set by user, but name kept for back. comp. reasons
+    add(QLatin1String("userNoBorder"), c->userNoBorder());
+    add(QLatin1String("windowType"), QString::fromLatin1(windowTypeToTxt(c->windowType())));
+    add(QLatin1String("shortcut"), c->shortcut().toString());
+    add(QLatin1String("stackingOrder"), stackingOrder.indexOf(c));
+    add(QLatin1String("activities"), c->activities());
+}
+#endif
+
+static void writeEntries(KConfigGroup &cg, const SessionEntries &entries)
+{
+    for (const auto &[key, value] : entries) {
+        cg.writeEntry(key, value);
+    }
+}
+
 /**
  * Stores the current session in the config file
  *
+ * The state of the windows is recorded right away, but written to the disk in a worker
+ * thread, so a session with many windows doesn't block the compositor. Phase 0 only records
+ * state in memory and writes nothing.
+ *
  * @see loadSessionInfo
  */
 void SessionManager::storeSession(const QString &sessionName, SMSavePhase phase)
 {
     qCDebug(KWIN_CORE) << "storing session" << sessionName << "in phase" << phase;
+    waitForPendingSave();
     KConfig *config = sessionConfig(sessionName, QString());
 
-    KConfigGroup cg(config, QStringLiteral("Session"));
+    SessionEntries entries;
     int count = 0;
     int active_client = -1;
 
 #if KWIN_BUILD_X11
     const QList<Window *> windows = workspace()->windows();
+    const QList<Window *> stackingOrder = workspace()->unconstrainedStackingOrder();
     for (auto it = windows.begin(); it != windows.end(); ++it) {
         X11Window *c = qobject_cast<X11Window *>(*it);
         if (!c || c->isUnmanaged()) {
@@ -123,7 +190,7 @@ void SessionManager::storeSession(const QString &sessionName, SMSavePhase phase)
             active_client = count;
         }
         if (phase == SMSavePhase2 || phase == SMSavePhase2Full) {
-            storeClient(cg, count, c);
+            snapshotClient(&entries, count, c, stackingOrder);
         }
     }
 #endif
@@ -134,62 +201,41 @@ void SessionManager::storeSession(const QString &sessionName, SMSavePhase phase)
         m_sessionActiveClient = active_client;
         m_sessionDesktop = VirtualDesktopManager::self()->current();
     } else if (phase == SMSavePhase2) {
-        cg.writeEntry("count", count);
-        cg.writeEntry("active", m_sessionActiveClient);
-        cg.writeEntry("desktop", m_sessionDesktop);
+        entries.append({QStringLiteral("count"), count});
+        entries.append({QStringLiteral("active"), m_sessionActiveClient});
+        entries.append({QStringLiteral("desktop"), m_sessionDesktop});
     } else { // SMSavePhase2Full
-        cg.writeEntry("count", count);
-        cg.writeEntry("active", m_sessionActiveClient);
+        entries.append({QStringLiteral("count"), count});
+        entries.append({QStringLiteral("active"), m_sessionActiveClient});
     }
-    config->sync(); // it previously did some "revert to defaults" stuff for phase1 I think
+
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    // The config is not touched by anything else until the save has finished.
+    m_pendingSave = QtConcurrent::run([config, entries = std::move(entries)]() {
+        KConfigGroup cg(config, QStringLiteral("Session"));
+        writeEntries(cg, entries);
+        config->sync(); // it previously did some "revert to defaults" stuff for phase1 I think
+    });
 }
 
-#if KWIN_BUILD_X11
-void SessionManager::storeClient(KConfigGroup &cg, int num, X11Window *c)
+void SessionManager::waitForPendingSave()
 {
-    c->setSessionActivityOverride(false); // make sure we get the real values
-    QString n = QString::number(num);
-    cg.writeEntry(QLatin1String("sessionId") + n, c->sessionId().constData());
-    cg.writeEntry(QLatin1String("windowRole") + n, c->windowRole());
-    cg.writeEntry(QLatin1String("wmCommand") + n, c->wmCommand());
-    cg.writeEntry(QLatin1String("resourceName") + n, c->resourceName());
-    cg.writeEntry(QLatin1String("resourceClass") + n, c->resourceClass());
-    cg.writeEntry(QLatin1String("geometry") + n, QRectF(c->calculateGravitation(true), c->clientSize()).toRect()); // FRAME
-    cg.writeEntry(QLatin1String("restore") + n, c->geometryRestore());
-    cg.writeEntry(QLatin1String("fsrestore") + n, c->fullscreenGeometryRestore());
-    cg.writeEntry(QLatin1String("maximize") + n, (int)c->maximizeMode());
-    cg.writeEntry(QLatin1String("fullscreen") + n, (int)c->fullScreenMode());
-    cg.writeEntry(QLatin1String("desktop") + n, c->desktopId());
-    // the config entry is called "iconified" for back. comp. reasons
-    // (kconf_update script for updating session files would be too complicated)
-    cg.writeEntry(QLatin1String("iconified") + n, c->isMinimized());
-    cg.writeEntry(QLatin1String("opacity") + n, c->opacity());
-    // the config entry is called "sticky" for back. comp. reasons
-    cg.writeEntry(QLatin1String("sticky") + n, c->isOnAllDesktops());
-    cg.writeEntry(QLatin1String("shaded") + n, c->isShade());
-    // the config entry is called "staysOnTop" for back. comp. reasons
-    cg.writeEntry(QLatin1String("staysOnTop") + n, c->keepAbove());
-    cg.writeEntry(QLatin1String("keepBelow") + n, c->keepBelow());
-    cg.writeEntry(QLatin1String("skipTaskbar") + n, c->originalSkipTaskbar());
-    cg.writeEntry(QLatin1String("skipPager") + n, c->skipPager());
-    cg.writeEntry(QLatin1String("skipSwitcher") + n, c->skipSwitcher());
-    // not really just set by user, but name kept for back. comp. reasons
-    cg.writeEntry(QLatin1String("userNoBorder") + n, c->userNoBorder());
-    cg.writeEntry(QLatin1String("windowType") + n, windowTypeToTxt(c->windowType()));
-    cg.writeEntry(QLatin1String("shortcut") + n, c->shortcut().toString());
-    cg.writeEntry(QLatin1String("stackingOrder") + n, workspace()->unconstrainedStackingOrder().indexOf(c));
-    cg.writeEntry(QLatin1String("activities") + n, c->activities());
+    m_pendingSave.waitForFinished();
 }
-#endif
 
 #if KWIN_BUILD_X11
 void SessionManager::storeSubSession(const QString &name, QSet<QByteArray> sessionIds)
 {
     // TODO clear it first
     KConfigGroup cg(KSharedConfig::openConfig(), QLatin1String("SubSession: ") + name);
+    SessionEntries entries;
     int count = 0;
     int active_client = -1;
     const QList<Window *> windows = workspace()->windows();
+    const QList<Window *> stackingOrder = workspace()->unconstrainedStackingOrder();
 
     for (auto it = windows.begin(); it != windows.end(); ++it) {
         X11Window *c = qobject_cast<X11Window *>(*it);
@@ -217,8 +263,9 @@ void SessionManager::storeSubSession(const QString &name, QSet<QByteArray> sessi
         if (c->isActive()) {
             active_client = count;
         }
-        storeClient(cg, count, c);
+        snapshotClient(&entries, count, c, stackingOrder);
     }
+    writeEntries(cg, entries);
     cg.writeEntry("count", count);
     cg.writeEntry("active", active_client);
     // cg.writeEntry( "desktop", currentDesktop());
@@ -232,7 +279,8 @@ void SessionManager::storeSubSession(const QString &name, QSet<QByteArray> sessi
  */
 void SessionManager::loadSession(const QString &sessionName)
 {
-    session.clear();
+    waitForPendingSave();
+    m_sessionInfos.clear();
     KConfigGroup cg(sessionConfig(sessionName, QString()), QStringLiteral("Session"));
     Q_EMIT loadSessionRequested(sessionName);
     addSessionInfo(cg);
@@ -245,7 +293,6 @@ void SessionManager::addSessionInfo(KConfigGroup &cg)
     for (int i = 1; i <= count; i++) {
         QString n = QString::number(i);
         SessionInfo *info = new SessionInfo;
-        session.append(info);
         info->sessionId = cg.readEntry(QLatin1String("sessionId") + n, QString()).toLatin1();
         info->windowRole = cg.readEntry(QLatin1String("windowRole") + n, QString());
         info->wmCommand = cg.readEntry(QLatin1String("wmCommand") + n, QString()).toLatin1();
@@ -272,6 +319,7 @@ void SessionManager::addSessionInfo(KConfigGroup &cg)
         info->active = (active_client == i);
         info->stackingOrder = cg.readEntry(QLatin1String("stackingOrder") + n, -1);
         info->activities = cg.readEntry(QLatin1String("activities") + n, QStringList());
+        m_sessionInfos.add(info);
     }
 }
 
@@ -282,7 +330,7 @@ void SessionManager::loadSubSessionInfo(const QString &name)
 }
 
 #if KWIN_BUILD_X11
-static bool sessionInfoWindowTypeMatch(X11Window *c, SessionInfo *info)
+static bool sessionInfoWindowTypeMatch(X11Window *c, const SessionInfo *info)
 {
     if (int(info->windowType) == -2) {
         // undefined (not really part of NET::WindowType)
@@ -302,55 +350,93 @@ static bool sessionInfoWindowTypeMatch(X11Window *c, SessionInfo *info)
  */
 SessionInfo *SessionManager::takeSessionInfo(X11Window *c)
 {
-    SessionInfo *realInfo = nullptr;
-    QByteArray sessionId = c->sessionId();
-    QString windowRole = c->windowRole();
-    QString wmCommand = c->wmCommand();
-    QString resourceName = c->resourceName();
-    QString resourceClass = c->resourceClass();
-
-    // First search ``session''
+    return m_sessionInfos.take(c->sessionId(), c->windowRole(), c->resourceName(), c->resourceClass(), c->wmCommand(),
+                               [c](const SessionInfo *info) {
+                                   return sessionInfoWindowTypeMatch(c, info);
+                               });
+}
+#endif
+
+SessionInfoIndex::~SessionInfoIndex()
+{
+    clear();
+}
+
+void SessionInfoIndex::add(SessionInfo *info)
+{
+    m_bySession[SessionKey(info->sessionId, info->windowRole)].append(info);
+    const ClassKey classKey(info->resourceName, info->resourceClass);
+    m_byClass[classKey].append(info);
+    m_byCommand[CommandKey(classKey, info->wmCommand)].append(info);
+}
+
+void SessionInfoIndex::clear()
+{
+    // Every entry is in exactly one list of each index.
+    for (const QList<SessionInfo *> &infos : std::as_const(m_byClass)) {
+        qDeleteAll(infos);
+    }
+    m_bySession.clear();
+    m_byClass.clear();
+    m_byCommand.clear();
+}
+
+int SessionInfoIndex::count() const
+{
+    int count = 0;
+    for (const QList<SessionInfo *> &infos : m_byClass) {
+        count += infos.size();
+    }
+    return count;
+}
+
+template<typename Key>
+static void removeFromIndex(QHash<Key, QList<SessionInfo *>> &index, const Key &key, SessionInfo *info)
+{
+    auto it = index.find(key);
+    Q_ASSERT(it != index.end());
+    it->removeOne(info);
+    if (it->isEmpty()) {
+        index.erase(it);
+    }
+}
+
+void SessionInfoIndex::remove(SessionInfo *info)
+{
+    removeFromIndex(m_bySession, SessionKey(info->sessionId, info->windowRole), info);
+    const ClassKey classKey(info->resourceName, info->resourceClass);
+    removeFromIndex(m_byClass, classKey, info);
+    removeFromIndex(m_byCommand, CommandKey(classKey, info->wmCommand), info);
+}
+
+SessionInfo *SessionInfoIndex::take(const QByteArray &sessionId, const QString &windowRole,
+                                    const QString &resourceName, const QString &resourceClass, const QString &wmCommand,
+                                    const std::function<bool(const SessionInfo *)> &windowTypeMatch)
+{
+    QList<SessionInfo *> candidates;
     if (!sessionId.isEmpty()) {
         // look for a real session managed client (algorithm suggested by ICCCM)
-        for (SessionInfo *info : std::as_const(session)) {
-            if (realInfo) {
-                break;
-            }
-            if (info->sessionId == sessionId && sessionInfoWindowTypeMatch(c, info)) {
-                if (!windowRole.isEmpty()) {
-                    if (info->windowRole == windowRole) {
-                        realInfo = info;
-                        session.removeAll(info);
-                    }
-                } else {
-                    if (info->windowRole.isEmpty()
-                        && info->resourceName == resourceName
-                        && info->resourceClass == resourceClass) {
-                        realInfo = info;
-                        session.removeAll(info);
-                    }
-                }
-            }
-        }
-    } else {
+        candidates = m_bySession.value(SessionKey(sessionId, windowRole));
+    } else if (wmCommand.isEmpty()) {
         // look for a sessioninfo with matching features.
-        for (SessionInfo *info : std::as_const(session)) {
-            if (realInfo) {
-                break;
-            }
-            if (info->resourceName == resourceName
-                && info->resourceClass == resourceClass
-                && sessionInfoWindowTypeMatch(c, info)) {
-                if (wmCommand.isEmpty() || info->wmCommand == wmCommand) {
-                    realInfo = info;
-                    session.removeAll(info);
-                }
+        candidates = m_byClass.value(ClassKey(resourceName, resourceClass));
+    } else {
+        candidates = m_byCommand.value(CommandKey(ClassKey(resourceName, resourceClass), wmCommand));
+    }
+
+    for (SessionInfo *info : std::as_const(candidates)) {
+        if (!sessionId.isEmpty() && windowRole.isEmpty()) {
+            if (info->resourceName != resourceName || info->resourceClass != resourceClass) {
+                continue;
             }
         }
+        if (windowTypeMatch(info)) {
+            remove(info);
+            return info;
+        }
     }
-    return realInfo;
+    return nullptr;
 }
-#endif
 
 SessionManager::SessionManager(QObject *parent)
     : QObject(parent)
@@ -361,7 +447,7 @@ SessionManager::SessionManager(QObject *parent)
 
 SessionManager::~SessionManager()
 {
-    qDeleteAll(session);
+    waitForPendingSave();
 }
 
 SessionState SessionManager::state() const
@@ -417,6 +503,20 @@ void SessionManager::finishSaveSession(const QString &name)
 {
     Q_EMIT finishSessionSaveRequested(name);
     storeSession(name, SMSavePhase2);
+
+    // The session manager may quit right after the call returns, so only reply once the
+    // session has been written.
+    if (calledFromDBus() && !m_pendingSave.isFinished()) {
+        auto dbusMessage = message();
+        setDelayedReply(true);
+
+        auto watcher = new QFutureWatcher<void>(this);
+        connect(watcher, &QFutureWatcher<void>::finished, this, [watcher, dbusMessage]() {
+            QDBusConnection::sessionBus().send(dbusMessage.createReply());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(m_pendingSave);
+    }
 }
 
 bool SessionManager::closeWaylandWindows()
@@ -530,6 +630,7 @@ void SessionManager::updateWaylandCancelNotification()
 
 void SessionManager::quit()
 {
+    waitForPendingSave();
     qApp->quit();
 }
 
@@ -12,6 +12,8 @@
 
 #include <QDBusContext>
 #include <QDataStream>
+#include <QFuture>
+#include <QHash>
 #include <QPointer>
 #include <QRect>
 #include <QStringList>
@@ -19,6 +21,8 @@
 
 #include <KConfigGroup>
 
+#include <functional>
+
 #include "effect/globals.h"
 
 class KNotification;
@@ -30,6 +34,52 @@ class X11Window;
 struct SessionInfo;
 class XdgToplevelWindow;
 
+/**
+ * The SessionInfoIndex class stores the window entries of a saved session. The entries are
+ * indexed by the properties that are used to match them with windows, so finding the entry
+ * of a window doesn't require comparing it with every entry of the session.
+ */
+class KWIN_EXPORT SessionInfoIndex
+{
+public:
+    SessionInfoIndex() = default;
+    ~SessionInfoIndex();
+
+    SessionInfoIndex(const SessionInfoIndex &) = delete;
+    SessionInfoIndex &operator=(const SessionInfoIndex &) = delete;
+
+    /**
+     * Adds the given entry, the index takes ownership of it.
+     */
+    void add(SessionInfo *info);
+    void clear();
+    int count() const;
+
+    /**
+     * Removes and returns the first added entry that matches a window with the given properties,
+     * or @c nullptr if there is none. The caller takes ownership of the returned entry.
+     *
+     * If the window has a session id, the entry must have the same session id and window role,
+     * and if there is no window role, the same resource name and class. Otherwise the entry must
+     * have the same resource name and class, and the same command if the window has one.
+     * In both cases, @a windowTypeMatch must accept the entry.
+     */
+    SessionInfo *take(const QByteArray &sessionId, const QString &windowRole,
+                      const QString &resourceName, const QString &resourceClass, const QString &wmCommand,
+                      const std::function<bool(const SessionInfo *)> &windowTypeMatch);
+
+private:
+    using SessionKey = std::pair<QByteArray, QString>;
+    using ClassKey = std::pair<QString, QString>;
+    using CommandKey = std::pair<ClassKey, QString>;
+
+    void remove(SessionInfo *info);
+
+    QHash<SessionKey, QList<SessionInfo *>> m_bySession;
+    QHash<ClassKey, QList<SessionInfo *>> m_byClass;
+    QHash<CommandKey, QList<SessionInfo *>> m_byCommand;
+};
+
 class SessionManager : public QObject, public QDBusContext
 {
     Q_OBJECT
@@ -71,11 +121,9 @@ private:
     void setState(SessionState state);
 
     void storeSession(const QString &sessionName, SMSavePhase phase);
-#if KWIN_BUILD_X11
-    void storeClient(KConfigGroup &cg, int num, X11Window *c);
-#endif
     void loadSessionInfo(const QString &sessionName);
     void addSessionInfo(KConfigGroup &cg);
+    void waitForPendingSave();
 
     void updateWaylandCancelNotification();
 
@@ -84,7 +132,8 @@ private:
     int m_sessionActiveClient;
     int m_sessionDesktop;
 
-    QList<SessionInfo *> session;
+    SessionInfoIndex m_sessionInfos;
+    QFuture<void> m_pendingSave;
     QList<XdgToplevelWindow *> m_pendingWindows;
     QTimer m_closeTimer;
     QTimer m_logoutAnywayTimer;
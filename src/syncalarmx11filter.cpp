@@ -9,7 +9,6 @@
 
 #include "syncalarmx11filter.h"
 #include "utils/xcbutils.h"
-#include "workspace.h"
 #include "x11window.h"
 
 namespace KWin
@@ -23,12 +22,17 @@ SyncAlarmX11Filter::SyncAlarmX11Filter()
 bool SyncAlarmX11Filter::event(xcb_generic_event_t *event)
 {
     auto alarmEvent = reinterpret_cast<xcb_sync_alarm_notify_event_t *>(event);
-    auto client = workspace()->findClient([alarmEvent](const X11Window *client) {
-        const auto syncRequest = client->syncRequest();
-        return alarmEvent->alarm == syncRequest.alarm && alarmEvent->counter_value.hi == syncRequest.value.hi && alarmEvent->counter_value.lo == syncRequest.value.lo;
-    });
-    if (client) {
-        client->ackSync();
+    X11Window *client = X11Window::findBySyncAlarm(alarmEvent->alarm);
+    if (!client) {
+        return false;
+    }
+    const auto &syncRequest = client->syncRequest();
+    if (alarmEvent->alarm == syncRequest.alarm) {
+        if (alarmEvent->counter_value.hi == syncRequest.value.hi && alarmEvent->counter_value.lo == syncRequest.value.lo) {
+            client->ackSync();
+        }
+    } else {
+        client->handleFrameSyncCounter(alarmEvent->counter_value);
     }
     return false;
 }
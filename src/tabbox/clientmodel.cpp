@@ -239,9 +239,50 @@ void ClientModel::createClientList(bool partialReset)
         return;
     }
 
-    beginResetModel();
-    m_clientList = m_mutableClientList;
-    endResetModel();
+    updateClientList(m_mutableClientList);
+}
+
+void ClientModel::updateClientList(const QList<Window *> &clients)
+{
+    // Remove the windows that are gone, back to front so the rows in front stay valid.
+    for (int row = m_clientList.count() - 1; row >= 0;) {
+        if (clients.contains(m_clientList[row])) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && !clients.contains(m_clientList[first - 1])) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, row);
+        m_clientList.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    // Move the remaining windows into place and insert the new ones.
+    for (int row = 0; row < clients.count(); ++row) {
+        Window *client = clients[row];
+        if (row < m_clientList.count() && m_clientList[row] == client) {
+            continue;
+        }
+        const int from = m_clientList.indexOf(client, row);
+        if (from != -1) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_clientList.move(from, row);
+            endMoveRows();
+        } else {
+            beginInsertRows(QModelIndex(), row, row);
+            m_clientList.insert(row, client);
+            endInsertRows();
+        }
+    }
+
+    if (m_clientList.count() > clients.count()) {
+        beginRemoveRows(QModelIndex(), clients.count(), m_clientList.count() - 1);
+        m_clientList.resize(clients.count());
+        endRemoveRows();
+    }
 }
 
 void ClientModel::close(int i)
@@ -63,7 +63,8 @@ public:
 
     /**
      * Generates a new list of Windows based on the current config.
-     * Calling this method will reset the model. If partialReset is true
+     * The model is updated with row insertions, removals and moves, so the views
+     * can keep the delegates of the Windows that remain in the list. If partialReset is true
      * the top of the list is kept as a starting point. If not the
      * current active client is used as the starting point to generate the
      * list.
@@ -89,6 +90,7 @@ public Q_SLOTS:
 private:
     void createFocusChainClientList(Window *start);
     void createStackingOrderClientList(Window *start);
+    void updateClientList(const QList<Window *> &clients);
 
     QList<Window *> m_clientList;
     QList<Window *> m_mutableClientList;
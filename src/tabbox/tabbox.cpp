@@ -462,6 +462,11 @@ QList<Window *> TabBox::currentClientList()
     return m_tabBox->clientList();
 }
 
+QAbstractItemModel *TabBox::currentClientModel() const
+{
+    return m_tabBox->clientModel();
+}
+
 void TabBox::setCurrentClient(Window *newClient)
 {
     setCurrentIndex(m_tabBox->index(newClient));
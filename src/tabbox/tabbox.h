@@ -93,6 +93,12 @@ public:
      */
     QList<Window *> currentClientList();
 
+    /**
+     * Returns the model of the clients potentially displayed ( only works in
+     * TabBoxWindowsMode ).
+     */
+    QAbstractItemModel *currentClientModel() const;
+
     /**
      * Change the currently selected client, and notify the effects.
      */
@@ -18,6 +18,7 @@
 #include "window.h"
 // Qt
 #include <QKeyEvent>
+#include <QPersistentModelIndex>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
@@ -69,7 +70,8 @@ public:
     QObject *m_mainItem;
     QMap<QString, QObject *> m_clientTabBoxes;
     ClientModel *m_clientModel;
-    QModelIndex index;
+    // Rows are inserted and removed while the tabbox is shown.
+    QPersistentModelIndex index;
     /**
      * Indicates if the tabbox is shown.
      */
@@ -452,7 +454,7 @@ void TabBoxHandler::setCurrentIndex(const QModelIndex &index)
     Q_EMIT selectedIndexChanged();
 }
 
-const QModelIndex &TabBoxHandler::currentIndex() const
+QModelIndex TabBoxHandler::currentIndex() const
 {
     return d->index;
 }
@@ -487,6 +489,11 @@ QList<Window *> TabBoxHandler::clientList() const
     return d->clientModel()->clientList();
 }
 
+QAbstractItemModel *TabBoxHandler::clientModel() const
+{
+    return d->clientModel();
+}
+
 Window *TabBoxHandler::client(const QModelIndex &index) const
 {
     if (!index.isValid()) {
@@ -214,7 +214,7 @@ public:
     /**
      * @returns the current index
      */
-    const QModelIndex &currentIndex() const;
+    QModelIndex currentIndex() const;
 
     /**
      * Retrieves the next or previous item of the current item.
@@ -256,6 +256,10 @@ public:
      * @see ClientModel::clientList
      */
     QList<Window *> clientList() const;
+    /**
+     * @return Returns the model of the Windows.
+     */
+    QAbstractItemModel *clientModel() const;
     /**
      * @param index The index of the client to be returned
      * @return Returns the Window at given model index. If
@@ -0,0 +1,259 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "damageregion.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace KWin
+{
+
+static qint64 area(const QRect &rect)
+{
+    return qint64(rect.width()) * rect.height();
+}
+
+/**
+ * Returns @c true if the union of @a a and @a b is a rectangle, i.e. they have the same
+ * horizontal extent and touch or overlap vertically, or the other way round.
+ */
+static bool canMergeExactly(const QRect &a, const QRect &b)
+{
+    if (a.left() == b.left() && a.right() == b.right()) {
+        return a.top() <= b.bottom() + 1 && b.top() <= a.bottom() + 1;
+    }
+    if (a.top() == b.top() && a.bottom() == b.bottom()) {
+        return a.left() <= b.right() + 1 && b.left() <= a.right() + 1;
+    }
+    return false;
+}
+
+static int alignDown(int value, int alignment)
+{
+    const int remainder = value % alignment;
+    return remainder < 0 ? value - remainder - alignment : value - remainder;
+}
+
+static int alignUp(int value, int alignment)
+{
+    return -alignDown(-value, alignment);
+}
+
+DamageRegion::DamageRegion(const QRect &rect)
+{
+    *this += rect;
+}
+
+DamageRegion::DamageRegion(const QRegion &region)
+{
+    *this += region;
+}
+
+bool DamageRegion::isEmpty() const
+{
+    return m_rects.isEmpty();
+}
+
+QRect DamageRegion::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+qsizetype DamageRegion::rectCount() const
+{
+    return m_rects.size();
+}
+
+const QRect *DamageRegion::begin() const
+{
+    return m_rects.cbegin();
+}
+
+const QRect *DamageRegion::end() const
+{
+    return m_rects.cend();
+}
+
+int DamageRegion::maxRectCount() const
+{
+    return m_maxRectCount;
+}
+
+void DamageRegion::setMaxRectCount(int count)
+{
+    count = std::max(count, 1);
+    if (m_maxRectCount != count) {
+        m_maxRectCount = count;
+        simplify();
+    }
+}
+
+int DamageRegion::tileSize() const
+{
+    return m_tileSize;
+}
+
+void DamageRegion::setTileSize(int size)
+{
+    size = std::max(size, 0);
+    if (m_tileSize != size) {
+        m_tileSize = size;
+        rebuild();
+    }
+}
+
+void DamageRegion::clear()
+{
+    m_rects.clear();
+    m_boundingRect = QRect();
+}
+
+bool DamageRegion::intersects(const QRect &rect) const
+{
+    if (!m_boundingRect.intersects(rect)) {
+        return false;
+    }
+    return std::any_of(m_rects.cbegin(), m_rects.cend(), [&rect](const QRect &r) {
+        return r.intersects(rect);
+    });
+}
+
+DamageRegion DamageRegion::translated(const QPoint &offset) const
+{
+    DamageRegion region = *this;
+    for (QRect &rect : region.m_rects) {
+        rect.translate(offset);
+    }
+    region.m_boundingRect.translate(offset);
+    return region;
+}
+
+QRegion DamageRegion::toRegion() const
+{
+    if (m_rects.size() == 1) {
+        return QRegion(m_rects.first());
+    }
+    QRegion region;
+    for (const QRect &rect : m_rects) {
+        region += rect;
+    }
+    return region;
+}
+
+DamageRegion &DamageRegion::operator+=(const QRect &rect)
+{
+    const QRect snapped = m_tileSize ? snapToTiles(rect) : rect;
+    if (snapped.isEmpty()) {
+        return *this;
+    }
+    if (m_boundingRect.contains(snapped)) {
+        for (const QRect &existing : std::as_const(m_rects)) {
+            if (existing.contains(snapped)) {
+                return *this;
+            }
+        }
+    }
+
+    m_boundingRect |= snapped;
+    insert(snapped);
+    if (m_rects.size() > m_maxRectCount) {
+        simplify();
+    }
+    return *this;
+}
+
+DamageRegion &DamageRegion::operator+=(const QRegion &region)
+{
+    for (const QRect &rect : region) {
+        *this += rect;
+    }
+    return *this;
+}
+
+DamageRegion &DamageRegion::operator+=(const DamageRegion &region)
+{
+    for (const QRect &rect : region) {
+        *this += rect;
+    }
+    return *this;
+}
+
+QRect DamageRegion::snapToTiles(const QRect &rect) const
+{
+    if (rect.isEmpty()) {
+        return QRect();
+    }
+    const int left = alignDown(rect.x(), m_tileSize);
+    const int top = alignDown(rect.y(), m_tileSize);
+    const int right = alignUp(rect.x() + rect.width(), m_tileSize);
+    const int bottom = alignUp(rect.y() + rect.height(), m_tileSize);
+    return QRect(left, top, right - left, bottom - top);
+}
+
+void DamageRegion::insert(QRect rect)
+{
+    // Absorb the rectangles that the new rectangle covers or that can be merged with it without
+    // covering more area. A merged rectangle may absorb rectangles it didn't touch before.
+    bool merged;
+    do {
+        merged = false;
+        for (qsizetype i = 0; i < m_rects.size();) {
+            const QRect &existing = m_rects[i];
+            if (rect.contains(existing)) {
+                // The order of the rectangles doesn't matter.
+                m_rects[i] = m_rects.last();
+                m_rects.removeLast();
+            } else if (canMergeExactly(rect, existing)) {
+                rect |= existing;
+                m_rects[i] = m_rects.last();
+                m_rects.removeLast();
+                merged = true;
+            } else {
+                ++i;
+            }
+        }
+    } while (merged);
+
+    m_rects.append(rect);
+}
+
+void DamageRegion::simplify()
+{
+    while (m_rects.size() > m_maxRectCount) {
+        qsizetype bestFirst = 0;
+        qsizetype bestSecond = 1;
+        qint64 bestWaste = std::numeric_limits<qint64>::max();
+        for (qsizetype i = 0; i < m_rects.size(); ++i) {
+            for (qsizetype j = i + 1; j < m_rects.size(); ++j) {
+                const QRect &a = m_rects[i];
+                const QRect &b = m_rects[j];
+                const qint64 waste = area(a | b) - area(a) - area(b) + area(a & b);
+                if (waste < bestWaste) {
+                    bestFirst = i;
+                    bestSecond = j;
+                    bestWaste = waste;
+                }
+            }
+        }
+
+        const QRect merged = m_rects[bestFirst] | m_rects[bestSecond];
+        m_rects.remove(bestSecond);
+        m_rects.remove(bestFirst);
+        insert(merged);
+    }
+}
+
+void DamageRegion::rebuild()
+{
+    const QVarLengthArray<QRect, DefaultMaxRectCount + 1> rects = m_rects;
+    clear();
+    for (const QRect &rect : rects) {
+        *this += rect;
+    }
+}
+
+} // namespace KWin
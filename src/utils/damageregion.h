@@ -0,0 +1,85 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWin X11 contributors
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+
+#include <QRect>
+#include <QRegion>
+#include <QVarLengthArray>
+
+namespace KWin
+{
+
+/**
+ * The DamageRegion class accumulates damage in the scene hot paths.
+ *
+ * Unlike QRegion, it doesn't keep a banded, disjoint set of rectangles. The rectangles may
+ * overlap, rectangles that can be merged without covering more area are merged as they are
+ * added, and once there are more than maxRectCount() rectangles, the pair of rectangles
+ * whose bounding rectangle covers the least extra area is merged. The stored rectangles live
+ * inline, so accumulating damage doesn't allocate unless the maximum rectangle count is
+ * raised above the default.
+ *
+ * The region can cover more than what has been added to it, which is fine for damage, but
+ * it must not be used for opaque or clip regions.
+ *
+ * Optionally, the added rectangles can be snapped to a coarse grid of tiles, which merges
+ * nearby damage more often at the cost of repainting more pixels.
+ */
+class KWIN_EXPORT DamageRegion
+{
+public:
+    static constexpr int DefaultMaxRectCount = 16;
+
+    DamageRegion() = default;
+    DamageRegion(const QRect &rect);
+    DamageRegion(const QRegion &region);
+
+    bool isEmpty() const;
+    QRect boundingRect() const;
+    qsizetype rectCount() const;
+
+    const QRect *begin() const;
+    const QRect *end() const;
+
+    /**
+     * Returns the maximum number of rectangles in the region.
+     */
+    int maxRectCount() const;
+    void setMaxRectCount(int count);
+
+    /**
+     * Returns the size of the tiles to which the rectangles are snapped, or @c 0 if the
+     * rectangles are not snapped. The default is @c 0.
+     */
+    int tileSize() const;
+    void setTileSize(int size);
+
+    void clear();
+
+    bool intersects(const QRect &rect) const;
+    DamageRegion translated(const QPoint &offset) const;
+    QRegion toRegion() const;
+
+    DamageRegion &operator+=(const QRect &rect);
+    DamageRegion &operator+=(const QRegion &region);
+    DamageRegion &operator+=(const DamageRegion &region);
+
+private:
+    QRect snapToTiles(const QRect &rect) const;
+    void insert(QRect rect);
+    void simplify();
+    void rebuild();
+
+    QVarLengthArray<QRect, DefaultMaxRectCount + 1> m_rects;
+    QRect m_boundingRect;
+    int m_maxRectCount = DefaultMaxRectCount;
+    int m_tileSize = 0;
+};
+
+} // namespace KWin
@@ -557,9 +557,10 @@ QList<ExtensionData> Extensions::extensions() const
 //****************************************
 // Shm
 //****************************************
-Shm::Shm()
+Shm::Shm(size_t size)
     : m_shmId(-1)
     , m_buffer(nullptr)
+    , m_size(size)
     , m_segment(XCB_NONE)
     , m_valid(false)
     , m_pixmapFormat(XCB_IMAGE_FORMAT_XY_BITMAP)
@@ -589,8 +590,7 @@ bool Shm::init()
         return false;
     }
     m_pixmapFormat = version->pixmap_format;
-    const int MAXSIZE = 4096 * 2048 * 4; // TODO check there are not larger windows
-    m_shmId = shmget(IPC_PRIVATE, MAXSIZE, IPC_CREAT | 0600);
+    m_shmId = shmget(IPC_PRIVATE, m_size, IPC_CREAT | 0600);
     if (m_shmId < 0) {
         qCDebug(KWIN_CORE) << "Failed to allocate SHM segment";
         return false;
@@ -20,6 +20,7 @@
 #include "utils/c_ptr.h"
 #include "utils/version.h"
 
+#include <QHash>
 #include <QList>
 #include <QRect>
 #include <QRegion>
@@ -30,6 +31,8 @@
 
 #include <xcb/shm.h>
 
+#include <algorithm>
+
 class TestXcbSizeHints;
 
 namespace KWin
@@ -2001,6 +2004,67 @@ static inline void restackWindows(const QList<xcb_window_t> &windows)
     }
 }
 
+/**
+ * Restacks @p windows like restackWindows(), assuming that the windows in @p previousWindows
+ * are already stacked in that order. Only the windows that are new or out of order are
+ * configured, the longest run of windows that kept their relative order stays in place.
+ */
+static inline void restackWindows(const QList<xcb_window_t> &windows, const QList<xcb_window_t> &previousWindows)
+{
+    if (windows.count() < 2) {
+        return;
+    }
+    if (previousWindows.isEmpty() || previousWindows.first() != windows.first()) {
+        restackWindows(windows);
+        return;
+    }
+
+    QHash<xcb_window_t, int> previousPositions;
+    previousPositions.reserve(previousWindows.count());
+    for (int i = 0; i < previousWindows.count(); ++i) {
+        previousPositions.insert(previousWindows.at(i), i);
+    }
+
+    // Find the longest subsequence of windows whose previous positions are increasing. The
+    // first window is always part of it, since it has the lowest previous position.
+    QList<int> positions(windows.count());
+    QList<int> predecessors(windows.count(), -1);
+    QList<int> tails;
+    for (int i = 0; i < windows.count(); ++i) {
+        positions[i] = previousPositions.value(windows.at(i), -1);
+        if (positions[i] == -1) {
+            continue;
+        }
+        auto tail = std::lower_bound(tails.begin(), tails.end(), positions[i], [&positions](int index, int position) {
+            return positions[index] < position;
+        });
+        if (tail != tails.begin()) {
+            predecessors[i] = *(tail - 1);
+        }
+        if (tail == tails.end()) {
+            tails.append(i);
+        } else {
+            *tail = i;
+        }
+    }
+
+    QList<bool> inPlace(windows.count(), false);
+    for (int i = tails.isEmpty() ? -1 : tails.last(); i != -1; i = predecessors[i]) {
+        inPlace[i] = true;
+    }
+
+    for (int i = 1; i < windows.count(); ++i) {
+        if (inPlace[i]) {
+            continue;
+        }
+        const uint16_t mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
+        const uint32_t stackingValues[] = {
+            windows.at(i - 1),
+            XCB_STACK_MODE_BELOW};
+        xcb_configure_window(connection(), windows.at(i), mask, stackingValues);
+    }
+}
+
 static inline void restackWindowsWithRaise(const QList<xcb_window_t> &windows)
 {
     if (windows.isEmpty()) {
@@ -2079,10 +2143,13 @@ void selectInput(xcb_window_t window, uint32_t events)
 class Shm
 {
 public:
-    Shm();
+    static constexpr size_t DefaultSize = 4096 * 2048 * 4;
+
+    explicit Shm(size_t size = DefaultSize);
     ~Shm();
     int shmId() const;
     void *buffer() const;
+    size_t size() const;
     xcb_shm_seg_t segment() const;
     bool isValid() const;
     uint8_t pixmapFormat() const;
@@ -2091,6 +2158,7 @@ private:
     bool init();
     int m_shmId;
     void *m_buffer;
+    size_t m_size;
     xcb_shm_seg_t m_segment;
     bool m_valid;
     uint8_t m_pixmapFormat;
@@ -2101,6 +2169,11 @@ inline void *Shm::buffer() const
     return m_buffer;
 }
 
+inline size_t Shm::size() const
+{
+    return m_size;
+}
+
 inline bool Shm::isValid() const
 {
     return m_valid;
@@ -447,6 +447,9 @@ void Workspace::cleanupX11()
     }
 
     manual_overlays.clear();
+    m_x11WindowStack.clear();
+    m_x11ClientList.clear();
+    m_x11ClientListStacking.clear();
 
     VirtualDesktopManager *desktopManager = VirtualDesktopManager::self();
     desktopManager->setRootInfo(nullptr);
@@ -775,6 +778,10 @@ void Workspace::addX11Window(X11Window *window)
     Q_ASSERT(!m_windows.contains(window));
     m_windows.append(window);
     addToStack(window);
+    updateDesktopX11Windows(window);
+    connect(window, &Window::desktopsChanged, this, [this, window]() {
+        updateDesktopX11Windows(window);
+    });
     if (window->hasStrut()) {
         rearrange(); // This cannot be in manage(), because the window got added only now
     }
@@ -815,9 +822,32 @@ void Workspace::removeX11Window(X11Window *window)
     if (group != nullptr) {
         group->lostLeader();
     }
+    disconnect(window, &Window::desktopsChanged, this, nullptr);
+    removeDesktopX11Windows(window);
     removeWindow(window);
 }
 
+void Workspace::updateDesktopX11Windows(X11Window *window)
+{
+    removeDesktopX11Windows(window);
+    const auto desktops = window->desktops();
+    for (VirtualDesktop *desktop : desktops) {
+        m_desktopX11Windows[desktop].append(window);
+    }
+}
+
+void Workspace::removeDesktopX11Windows(X11Window *window)
+{
+    for (auto it = m_desktopX11Windows.begin(); it != m_desktopX11Windows.end();) {
+        it->removeOne(window);
+        if (it->isEmpty()) {
+            it = m_desktopX11Windows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 void Workspace::removeUnmanaged(X11Window *window)
 {
     Q_ASSERT(m_windows.contains(window));
@@ -975,7 +1005,7 @@ void Workspace::slotReconfigure()
 
 void Workspace::slotCurrentDesktopChanged(VirtualDesktop *oldDesktop, VirtualDesktop *newDesktop)
 {
-    updateWindowVisibilityAndActivateOnDesktopChange(newDesktop);
+    updateWindowVisibilityAndActivateOnDesktopChange(newDesktop, oldDesktop);
     Q_EMIT currentDesktopChanged(oldDesktop, m_moveResizeWindow);
 }
 
@@ -990,16 +1020,37 @@ void Workspace::slotCurrentDesktopChangingCancelled()
     Q_EMIT currentDesktopChangingCancelled();
 }
 
-void Workspace::updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop)
+#if KWIN_BUILD_X11
+static void sortByStackingOrder(QList<X11Window *> &windows)
+{
+    std::sort(windows.begin(), windows.end(), [](const X11Window *a, const X11Window *b) {
+        return a->stackingOrder() < b->stackingOrder();
+    });
+}
+#endif
+
+void Workspace::updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop, VirtualDesktop *previousDesktop)
 {
 #if KWIN_BUILD_X11
-    for (auto it = stacking_order.constBegin(); it != stacking_order.constEnd(); ++it) {
-        X11Window *c = qobject_cast<X11Window *>(*it);
-        if (!c) {
-            continue;
+    // Only the windows on exactly one of the two desktops change their visibility. If the
+    // previous desktop is unknown, e.g. because the activity has changed, check every window.
+    const bool onlyDesktopChanged = previousDesktop && previousDesktop != newDesktop;
+    QList<X11Window *> windows;
+    if (onlyDesktopChanged) {
+        windows = m_desktopX11Windows.value(previousDesktop);
+        sortByStackingOrder(windows);
+    } else {
+        for (Window *window : std::as_const(stacking_order)) {
+            if (X11Window *x11Window = qobject_cast<X11Window *>(window)) {
+                windows.append(x11Window);
+            }
         }
+    }
+
+    // Hide the windows bottom to top, show them top to bottom, to reduce exposures.
+    for (X11Window *c : std::as_const(windows)) {
         if (!(c->isOnDesktop(newDesktop) && c->isOnCurrentActivity()) && c != m_moveResizeWindow) {
-            (c)->updateVisibility();
+            c->updateVisibility();
         }
     }
     // Now propagate the change, after hiding, before showing
@@ -1015,11 +1066,12 @@ void Workspace::updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop
     }
 
 #if KWIN_BUILD_X11
-    for (int i = stacking_order.size() - 1; i >= 0; --i) {
-        X11Window *c = qobject_cast<X11Window *>(stacking_order.at(i));
-        if (!c) {
-            continue;
-        }
+    if (onlyDesktopChanged) {
+        windows = m_desktopX11Windows.value(newDesktop);
+        sortByStackingOrder(windows);
+    }
+    for (auto it = windows.crbegin(); it != windows.crend(); ++it) {
+        X11Window *c = *it;
         if (c->isOnDesktop(newDesktop) && c->isOnCurrentActivity()) {
             c->updateVisibility();
         }
@@ -1030,16 +1082,30 @@ void Workspace::updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop
     }
 }
 
-void Workspace::updateWindowVisibilityAndActivateOnDesktopChange(VirtualDesktop *newDesktop)
+void Workspace::updateWindowVisibilityAndActivateOnDesktopChange(VirtualDesktop *newDesktop, VirtualDesktop *previousDesktop)
 {
     closeActivePopup();
+#if KWIN_BUILD_X11
+    // Let other clients see the windows of the new desktop appear at once, along with the
+    // restacking and the focus change.
+    if (kwinApp()->x11Connection()) {
+        grabXServer();
+    }
+#endif
     ++block_focus;
-    StackingUpdatesBlocker blocker(this);
-    updateWindowVisibilityOnDesktopChange(newDesktop);
-    // Restore the focus on this desktop
-    --block_focus;
+    {
+        StackingUpdatesBlocker blocker(this);
+        updateWindowVisibilityOnDesktopChange(newDesktop, previousDesktop);
+        // Restore the focus on this desktop
+        --block_focus;
 
-    activateWindowOnDesktop(newDesktop);
+        activateWindowOnDesktop(newDesktop);
+    }
+#if KWIN_BUILD_X11
+    if (kwinApp()->x11Connection()) {
+        ungrabXServer();
+    }
+#endif
 }
 
 void Workspace::activateWindowOnDesktop(VirtualDesktop *desktop)
@@ -1418,6 +1484,9 @@ void Workspace::slotDesktopRemoved(VirtualDesktop *desktop)
     rearrange();
     m_placement->reinitCascading();
     m_focusChain->removeDesktop(desktop);
+#if KWIN_BUILD_X11
+    m_desktopX11Windows.remove(desktop);
+#endif
 }
 
 void Workspace::slotEndInteractiveMoveResize()
@@ -616,6 +616,8 @@ private:
 #if KWIN_BUILD_X11
     void initializeX11();
     void cleanupX11();
+    void updateDesktopX11Windows(X11Window *window);
+    void removeDesktopX11Windows(X11Window *window);
 
     void propagateWindows(bool propagate_new_windows); // Called only from updateStackingOrder
     void fixPositionAfterCrash(xcb_window_t w, const xcb_get_geometry_reply_t *geom);
@@ -634,8 +636,8 @@ private:
     //---------------------------------------------------------------------
 
     void closeActivePopup();
-    void updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop);
-    void updateWindowVisibilityAndActivateOnDesktopChange(VirtualDesktop *newDesktop);
+    void updateWindowVisibilityOnDesktopChange(VirtualDesktop *newDesktop, VirtualDesktop *previousDesktop);
+    void updateWindowVisibilityAndActivateOnDesktopChange(VirtualDesktop *newDesktop, VirtualDesktop *previousDesktop = nullptr);
     void activateWindowOnDesktop(VirtualDesktop *desktop);
     Window *findWindowToActivateOnDesktop(VirtualDesktop *desktop);
     void removeWindow(Window *window);
@@ -696,6 +698,12 @@ private:
     bool was_user_interaction;
 #if KWIN_BUILD_X11
     QList<xcb_window_t> manual_overlays; // Topmost last
+    // What propagateWindows() last sent to the X server
+    QList<xcb_window_t> m_x11WindowStack;
+    QList<xcb_window_t> m_x11ClientList;
+    QList<xcb_window_t> m_x11ClientListStacking;
+    // Managed windows by virtual desktop, windows on all desktops are not included
+    QHash<VirtualDesktop *, QList<X11Window *>> m_desktopX11Windows;
     std::unique_ptr<X11EventFilter> m_wasUserInteractionFilter;
     std::unique_ptr<Xcb::Window> m_nullFocus;
     std::unique_ptr<X11EventFilter> m_movingClientFilter;
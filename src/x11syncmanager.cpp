@@ -226,4 +226,9 @@ void X11SyncManager::insertWait()
     }
 }
 
+bool X11SyncManager::isFenceTriggered() const
+{
+    return m_currentFence != nullptr;
+}
+
 } // namespace KWin
@@ -71,6 +71,13 @@ public:
     void triggerFence();
     void insertWait();
 
+    /**
+     * Returns @c true if a fence has been triggered for the current frame. The GPU waits for
+     * the X rendering to the damaged windows by means of the fence, so there is no need to
+     * wait for all X rendering to finish before rendering the frame.
+     */
+    bool isFenceTriggered() const;
+
 private:
     X11SyncManager();
 
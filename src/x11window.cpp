@@ -17,6 +17,7 @@
 #include "atoms.h"
 #include "client_machine.h"
 #include "compositor.h"
+#include "core/renderbackend.h"
 #include "cursor.h"
 #include "decorations/decoratedwindow.h"
 #include "decorations/decorationbridge.h"
@@ -360,6 +361,7 @@ X11Window::X11Window()
  */
 X11Window::~X11Window()
 {
+    s_pendingPropertyNotifyWindows.removeOne(this);
     delete info;
 
     if (m_killPrompt) {
@@ -474,9 +476,11 @@ void X11Window::releaseWindow(bool on_shutdown)
         m_syncRequest.timeout->stop();
     }
     if (m_syncRequest.alarm != XCB_NONE) {
+        s_syncAlarmWindows.remove(m_syncRequest.alarm);
         xcb_sync_destroy_alarm(kwinApp()->x11Connection(), m_syncRequest.alarm);
         m_syncRequest.alarm = XCB_NONE;
     }
+    setFrameSyncCounter(XCB_NONE);
 
     unblockCompositing();
     unref();
@@ -527,9 +531,11 @@ void X11Window::destroyWindow()
         m_syncRequest.timeout->stop();
     }
     if (m_syncRequest.alarm != XCB_NONE) {
+        s_syncAlarmWindows.remove(m_syncRequest.alarm);
         xcb_sync_destroy_alarm(kwinApp()->x11Connection(), m_syncRequest.alarm);
         m_syncRequest.alarm = XCB_NONE;
     }
+    setFrameSyncCounter(XCB_NONE);
 
     unblockCompositing();
     unref();
@@ -712,6 +718,7 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     getMotifHints();
     getWmOpaqueRegion();
     readSkipCloseAnimation(skipCloseAnimationCookie);
+    getTearingControl();
     updateShadow();
 
     // TODO: Try to obey all state information from info->state()
@@ -1861,7 +1868,7 @@ void X11Window::updateVisibility()
         }
         return;
     }
-    info->setState(NET::States(), NET::Hidden);
+    info->setState(isHiddenByThrottling() ? NET::Hidden : NET::States(), NET::Hidden);
     if (!isOnCurrentDesktop()) {
         if (Compositor::compositing() && options->hiddenPreviews() != HiddenPreviewsNever) {
             internalKeep();
@@ -2245,6 +2252,26 @@ void X11Window::doSetHiddenByShowDesktop()
     updateVisibility();
 }
 
+void X11Window::doSetSuspended()
+{
+    if (isUnmanaged() || isDeleted()) {
+        return;
+    }
+    // Minimized and hidden windows are always marked hidden, see updateVisibility().
+    if (!isMinimized() && !isHidden()) {
+        info->setState(isHiddenByThrottling() ? NET::Hidden : NET::States(), NET::Hidden);
+    }
+    if (!isSuspended() && m_frameSync.pendingValue && windowItem()) {
+        // Let the next frame report the withheld frame as drawn.
+        windowItem()->scheduleFrame();
+    }
+}
+
+bool X11Window::isHiddenByThrottling() const
+{
+    return isSuspended() && throttlePolicy() == ThrottlePolicy::Suspend;
+}
+
 void X11Window::doSetModal()
 {
     if (isDeleted()) {
@@ -2548,8 +2575,18 @@ void X11Window::getSyncCounter()
         return;
     }
 
-    Xcb::Property syncProp(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
-    const xcb_sync_counter_t counter = syncProp.value<xcb_sync_counter_t>(XCB_NONE);
+    // The property holds either only the basic counter, or the basic and the extended counter.
+    Xcb::Property syncProp(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 2);
+    const QByteArray counters = syncProp.toByteArray(32, XCB_ATOM_CARDINAL);
+    const auto counterAt = [&counters](int index) -> xcb_sync_counter_t {
+        if (counters.size() < int((index + 1) * sizeof(uint32_t))) {
+            return XCB_NONE;
+        }
+        return reinterpret_cast<const uint32_t *>(counters.constData())[index];
+    };
+    setFrameSyncCounter(counterAt(1));
+
+    const xcb_sync_counter_t counter = counterAt(0);
     if (counter != XCB_NONE) {
         m_syncRequest.enabled = true;
         m_syncRequest.counter = counter;
@@ -2570,6 +2607,7 @@ void X11Window::getSyncCounter()
             if (error) {
                 m_syncRequest.alarm = XCB_NONE;
             } else {
+                s_syncAlarmWindows.insert(m_syncRequest.alarm, this);
                 xcb_sync_change_alarm_value_list_t value;
                 memset(&value, 0, sizeof(value));
                 value.value.hi = 0;
@@ -2582,6 +2620,163 @@ void X11Window::getSyncCounter()
     }
 }
 
+void X11Window::setFrameSyncCounter(xcb_sync_counter_t counter)
+{
+    if (m_frameSync.counter == counter) {
+        return;
+    }
+
+    auto *c = kwinApp()->x11Connection();
+    if (m_frameSync.alarm != XCB_NONE) {
+        s_syncAlarmWindows.remove(m_frameSync.alarm);
+        xcb_sync_destroy_alarm(c, m_frameSync.alarm);
+        m_frameSync.alarm = XCB_NONE;
+    }
+    m_frameSync.counter = counter;
+    m_frameSync.pendingValue.reset();
+    if (counter == XCB_NONE) {
+        return;
+    }
+
+    // Get notified about every change of the counter, the client increments it at least
+    // twice per frame.
+    const uint32_t mask = XCB_SYNC_CA_COUNTER | XCB_SYNC_CA_VALUE_TYPE | XCB_SYNC_CA_VALUE | XCB_SYNC_CA_TEST_TYPE | XCB_SYNC_CA_DELTA | XCB_SYNC_CA_EVENTS;
+    xcb_sync_create_alarm_value_list_t values;
+    memset(&values, 0, sizeof(values));
+    values.counter = counter;
+    values.valueType = XCB_SYNC_VALUETYPE_RELATIVE;
+    values.value.lo = 1;
+    values.testType = XCB_SYNC_TESTTYPE_POSITIVE_COMPARISON;
+    values.delta.lo = 1;
+    values.events = 1;
+    m_frameSync.alarm = xcb_generate_id(c);
+    auto cookie = xcb_sync_create_alarm_aux_checked(c, m_frameSync.alarm, mask, &values);
+    UniqueCPtr<xcb_generic_error_t> error(xcb_request_check(c, cookie));
+    if (error) {
+        m_frameSync.alarm = XCB_NONE;
+        m_frameSync.counter = XCB_NONE;
+    } else {
+        s_syncAlarmWindows.insert(m_frameSync.alarm, this);
+    }
+}
+
+QHash<xcb_sync_alarm_t, X11Window *> X11Window::s_syncAlarmWindows;
+
+X11Window *X11Window::findBySyncAlarm(xcb_sync_alarm_t alarm)
+{
+    return s_syncAlarmWindows.value(alarm);
+}
+
+void X11Window::handleFrameSyncCounter(const xcb_sync_int64_t &value)
+{
+    // An odd value means that the client has started drawing a new frame.
+    if (value.lo % 2) {
+        return;
+    }
+
+    m_frameSync.pendingValue = (uint64_t(uint32_t(value.hi)) << 32) | value.lo;
+    m_frameSync.completedTimestamp = std::chrono::steady_clock::now().time_since_epoch();
+
+    // If the window won't be painted, don't keep the client waiting for the next frame unless
+    // it should stop drawing while it can't be seen. The frame is reported as drawn once the
+    // window is painted again.
+    if (!Compositor::compositing() || !readyForPainting() || !windowItem()) {
+        sendFrameDrawn(nullptr);
+    } else if (isFrameDrawnWithheld()) {
+        m_withheldFrames++;
+    } else if (!windowItem()->isVisible()) {
+        sendFrameDrawn(nullptr);
+    } else {
+        windowItem()->scheduleFrame();
+    }
+}
+
+static void sendFrameSyncMessage(xcb_window_t window, xcb_atom_t type, const std::array<uint32_t, 5> &data)
+{
+    xcb_client_message_event_t ev;
+    static_assert(sizeof(ev) == 32, "Would leak stack data otherwise");
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CLIENT_MESSAGE;
+    ev.window = window;
+    ev.type = type;
+    ev.format = 32;
+    std::copy(data.begin(), data.end(), ev.data.data32);
+    xcb_send_event(kwinApp()->x11Connection(), false, window, XCB_EVENT_MASK_NO_EVENT, reinterpret_cast<const char *>(&ev));
+}
+
+class FrameTimingsFeedback : public PresentationFeedback
+{
+public:
+    FrameTimingsFeedback(X11Window *window, uint64_t value, std::chrono::nanoseconds drawnTimestamp, std::chrono::nanoseconds frameDelay)
+        : m_window(window)
+        , m_value(value)
+        , m_drawnTimestamp(drawnTimestamp)
+        , m_frameDelay(frameDelay)
+    {
+    }
+
+    void presented(std::chrono::nanoseconds refreshCycleDuration, std::chrono::nanoseconds timestamp, PresentationMode mode) override
+    {
+        if (m_window && !m_window->isDeleted()) {
+            m_window->sendFrameTimings(m_value, m_drawnTimestamp, m_frameDelay, timestamp, refreshCycleDuration);
+        }
+    }
+
+private:
+    QPointer<X11Window> m_window;
+    uint64_t m_value;
+    std::chrono::nanoseconds m_drawnTimestamp;
+    std::chrono::nanoseconds m_frameDelay;
+};
+
+void X11Window::sendFrameDrawn(OutputFrame *frame)
+{
+    if (!m_frameSync.pendingValue) {
+        return;
+    }
+    const uint64_t value = *std::exchange(m_frameSync.pendingValue, std::nullopt);
+
+    const std::chrono::nanoseconds drawnTimestamp = std::chrono::steady_clock::now().time_since_epoch();
+    const uint64_t drawnTime = std::chrono::duration_cast<std::chrono::microseconds>(drawnTimestamp).count();
+    sendFrameSyncMessage(window(), atoms->net_wm_frame_drawn, {
+                                                                  uint32_t(value),
+                                                                  uint32_t(value >> 32),
+                                                                  uint32_t(drawnTime),
+                                                                  uint32_t(drawnTime >> 32),
+                                                                  0,
+                                                              });
+
+    const std::chrono::nanoseconds frameDelay = drawnTimestamp - m_frameSync.completedTimestamp;
+    if (frame) {
+        frame->addFeedback(std::make_unique<FrameTimingsFeedback>(this, value, drawnTimestamp, frameDelay));
+    } else {
+        sendFrameTimings(value, drawnTimestamp, frameDelay, std::nullopt, std::chrono::nanoseconds::zero());
+    }
+    xcb_flush(kwinApp()->x11Connection());
+}
+
+void X11Window::sendFrameTimings(uint64_t value, std::chrono::nanoseconds drawnTimestamp, std::chrono::nanoseconds frameDelay, std::optional<std::chrono::nanoseconds> presentationTimestamp, std::chrono::nanoseconds refreshDuration)
+{
+    auto toMicroseconds = [](std::chrono::nanoseconds duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    };
+
+    // 0 tells the client that the frame has not been presented or that the presentation
+    // time is unknown, that's what GTK and mutter expect.
+    uint32_t presentationOffset = 0;
+    if (presentationTimestamp) {
+        presentationOffset = uint32_t(int32_t(std::clamp<int64_t>(toMicroseconds(*presentationTimestamp - drawnTimestamp), -0x7fffffff, 0x7fffffff)));
+    }
+    sendFrameSyncMessage(window(), atoms->net_wm_frame_timings, {
+                                                                    uint32_t(value),
+                                                                    uint32_t(value >> 32),
+                                                                    presentationOffset,
+                                                                    uint32_t(toMicroseconds(refreshDuration)),
+                                                                    uint32_t(std::clamp<int64_t>(toMicroseconds(frameDelay), 0, 0x7fffffff)),
+                                                                });
+    xcb_flush(kwinApp()->x11Connection());
+}
+
 /**
  * Send the client a _NET_SYNC_REQUEST
  */
@@ -5201,6 +5396,47 @@ void X11Window::getSkipCloseAnimation()
     readSkipCloseAnimation(property);
 }
 
+void X11Window::getTearingControl()
+{
+    Xcb::Property property(false, window(), atoms->kde_net_wm_tearing_control, XCB_ATOM_CARDINAL, 0, 1);
+    m_tearingRequested = property.value<uint32_t>(0) == 1;
+}
+
+bool X11Window::isTearingRequested() const
+{
+    return m_tearingRequested;
+}
+
+ThrottlePolicy X11Window::throttlePolicy() const
+{
+    return ThrottlePolicy(rules()->checkThrottling(int(ThrottlePolicy::Updates)));
+}
+
+bool X11Window::isFrameDrawnWithheld() const
+{
+    if (throttlePolicy() != ThrottlePolicy::Suspend) {
+        return false;
+    }
+    if (isSuspended()) {
+        return true;
+    }
+    const auto item = static_cast<SurfaceItemX11 *>(surfaceItem());
+    return item && item->isOccluded();
+}
+
+quint64 X11Window::skippedDamageFetches() const
+{
+    if (const auto item = static_cast<SurfaceItemX11 *>(surfaceItem())) {
+        return item->skippedDamageFetches();
+    }
+    return 0;
+}
+
+quint64 X11Window::withheldFrames() const
+{
+    return m_withheldFrames;
+}
+
 //********************************************
 // Client
 //********************************************
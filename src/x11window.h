@@ -22,6 +22,7 @@
 // Qt
 #include <QElapsedTimer>
 #include <QFlags>
+#include <QHash>
 #include <QPixmap>
 #include <QPointer>
 #include <QWindow>
@@ -39,6 +40,7 @@ namespace KWin
 {
 
 class KillPrompt;
+class OutputFrame;
 
 /**
  * @brief Defines Predicates on how to search for a Client.
@@ -78,6 +80,18 @@ class KWIN_EXPORT X11Window : public Window
 {
     Q_OBJECT
 
+    /**
+     * The number of frames in which the damage of the window was left in the X server
+     * because the window couldn't be seen.
+     */
+    Q_PROPERTY(quint64 skippedDamageFetches READ skippedDamageFetches)
+
+    /**
+     * The number of _NET_WM_FRAME_DRAWN messages that were withheld until the window could
+     * be seen again.
+     */
+    Q_PROPERTY(quint64 withheldFrames READ withheldFrames)
+
 public:
     explicit X11Window();
     ~X11Window() override; ///< Use destroyWindow() or releaseWindow()
@@ -141,6 +155,11 @@ public:
     QSizeF basicUnit() const;
 
     bool windowEvent(xcb_generic_event_t *e);
+    /**
+     * Processes the PropertyNotify events of frequently changing properties that have been
+     * coalesced since the last event loop iteration.
+     */
+    static void flushPendingPropertyNotifies();
     WindowType windowType() const override;
 
     bool track(xcb_window_t w);
@@ -297,10 +316,57 @@ public:
     {
         return m_syncRequest;
     }
+    /**
+     * Returns the window that owns the XSync @a alarm, either for the basic or the extended
+     * sync request counter.
+     */
+    static X11Window *findBySyncAlarm(xcb_sync_alarm_t alarm);
     void ackSync();
     void ackSyncTimeout();
     void finishSync();
 
+    /**
+     * State of the extended _NET_WM_SYNC_REQUEST_COUNTER, which the client increments to an
+     * odd value when it starts drawing a frame and to an even value when it's done.
+     */
+    struct FrameSync
+    {
+        xcb_sync_counter_t counter = XCB_NONE;
+        xcb_sync_alarm_t alarm = XCB_NONE;
+        std::optional<uint64_t> pendingValue;
+        std::chrono::nanoseconds completedTimestamp{0};
+    };
+    const FrameSync &frameSync() const
+    {
+        return m_frameSync;
+    }
+    void handleFrameSyncCounter(const xcb_sync_int64_t &value);
+    /**
+     * Sends _NET_WM_FRAME_DRAWN for the last frame completed by the client, if any, and
+     * _NET_WM_FRAME_TIMINGS once the @a frame is presented. If @a frame is null, the timings
+     * are sent right away without a presentation time.
+     */
+    void sendFrameDrawn(OutputFrame *frame);
+    void sendFrameTimings(uint64_t value, std::chrono::nanoseconds drawnTimestamp, std::chrono::nanoseconds frameDelay, std::optional<std::chrono::nanoseconds> presentationTimestamp, std::chrono::nanoseconds refreshDuration);
+
+    /**
+     * Returns @c true if the client has asked for its frames to be presented as soon as
+     * possible, even if that causes tearing, by setting _KDE_NET_WM_TEARING_CONTROL to 1.
+     */
+    bool isTearingRequested() const;
+
+    /**
+     * Returns how much work is avoided while the window can't be seen.
+     */
+    ThrottlePolicy throttlePolicy() const;
+    /**
+     * Returns @c true if _NET_WM_FRAME_DRAWN is withheld so that the client stops drawing
+     * until the window can be seen again.
+     */
+    bool isFrameDrawnWithheld() const;
+    quint64 skippedDamageFetches() const;
+    quint64 withheldFrames() const;
+
     bool allowWindowActivation(xcb_timestamp_t time = -1U, bool focus_in = false);
 
     static void cleanupX11();
@@ -319,6 +385,9 @@ private:
     void configureNotifyEvent(xcb_configure_notify_event_t *e);
     void configureRequestEvent(xcb_configure_request_event_t *e);
     void propertyNotifyEvent(xcb_property_notify_event_t *e);
+    bool coalescePropertyNotify(const xcb_property_notify_event_t *e);
+    void flushPropertyNotifies();
+    void netInfoChanged(NET::Properties dirtyProperties, NET::Properties2 dirtyProperties2);
     void clientMessageEvent(xcb_client_message_event_t *e);
     void enterNotifyEvent(xcb_enter_notify_event_t *e);
     void leaveNotifyEvent(xcb_leave_notify_event_t *e);
@@ -344,6 +413,7 @@ protected:
     void doSetDemandsAttention() override;
     void doSetHidden() override;
     void doSetHiddenByShowDesktop() override;
+    void doSetSuspended() override;
     void doSetModal() override;
     bool belongsToDesktop() const override;
     bool doStartInteractiveMoveResize() override;
@@ -383,12 +453,14 @@ private:
     Xcb::Property fetchSkipCloseAnimation() const;
     void readSkipCloseAnimation(Xcb::Property &prop);
     void getSkipCloseAnimation();
+    void getTearingControl();
 
     void configureRequest(int value_mask, qreal rx, qreal ry, qreal rw, qreal rh, int gravity, bool from_tool);
     NETExtendedStrut strut() const;
     int checkShadeGeometry(int w, int h);
     void getSyncCounter();
     void sendSyncRequest();
+    void setFrameSyncCounter(xcb_sync_counter_t counter);
     void leaveInteractiveMoveResize() override;
     void establishCommandWindowGrab(uint8_t button);
     void establishCommandAllGrab(uint8_t button);
@@ -410,6 +482,7 @@ private:
     void map();
     void unmap();
     void updateHiddenPreview();
+    bool isHiddenByThrottling() const;
 
     void updateInputShape();
     void configure(const QRect &nativeFrame, const QRect &nativeWrapper, const QRect &nativeClient);
@@ -501,6 +574,12 @@ private:
     NET::Actions allowed_actions;
     bool shade_geometry_change;
     SyncRequest m_syncRequest;
+    FrameSync m_frameSync;
+    bool m_tearingRequested = false;
+    quint64 m_withheldFrames = 0;
+    QList<xcb_property_notify_event_t> m_pendingPropertyNotifies;
+    static QList<X11Window *> s_pendingPropertyNotifyWindows;
+    static QHash<xcb_sync_alarm_t, X11Window *> s_syncAlarmWindows;
     static bool check_active_modal; ///< \see X11Window::checkActiveModal()
     int sm_stacking_order;
     xcb_visualid_t m_visual = XCB_NONE;